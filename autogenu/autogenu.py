@@ -36,7 +36,9 @@ class ControlInputBound:
         self.umax = umax
         self.dummy_weight = dummy_weight
 
-SymbolicFunctions = namedtuple('SymbolicFunctions', ['f', 'phix', 'hx', 'hu'])
+SymbolicFunctions = namedtuple('SymbolicFunctions', ['f', 'phix', 'hx', 'hu', 'huu', 'hux', 
+                                                     'f_jvp', 'phix_jvp', 'hx_jvp', 'hu_jvp', 
+                                                     'L', 'phi'])
 
 class NLPType(Enum):
     SingleShooting = auto()
@@ -223,7 +225,18 @@ class AutoGenU(object):
         for i in range(self.__nh):
             hu[nuc+i] = sympy.sqrt(u[nuc+i]**2 + h[i]**2 + fb_eps[i]) - (u[nuc+i] - h[i])
         phix = symutils.diff_scalar_func(phi, x)
-        self.__symbolic_functions = SymbolicFunctions(f, phix, hx, hu)
+        huu = symutils.diff_vector_func(hu, u)
+        hux = symutils.diff_vector_func(hu, x)
+        x_dir = sympy.symbols('x_dir[0:%d]' %(self.__nx))
+        u_dir = sympy.symbols('u_dir[0:%d]' %(self.__nu+self.__nc+self.__nh))
+        lmd_dir = sympy.symbols('lmd_dir[0:%d]' %(self.__nx))
+        f_jvp = symutils.jvp(f, [x, u], [x_dir, u_dir])
+        phix_jvp = symutils.jvp(phix, [x], [x_dir])
+        hx_jvp = symutils.jvp(hx, [x, u, lmd], [x_dir, u_dir, lmd_dir])
+        hu_jvp = symutils.jvp(hu, [x, u, lmd], [x_dir, u_dir, lmd_dir])
+        self.__symbolic_functions = SymbolicFunctions(f, phix, hx, hu, huu, hux, 
+                                                      f_jvp, phix_jvp, hx_jvp, hu_jvp, 
+                                                      L, phi)
 
     def add_control_input_bounds(
         self, uindex: int, umin, umax, dummy_weight
@@ -330,7 +343,8 @@ class AutoGenU(object):
         assert simulation_length > 0
         self.__simulation_params = SimulationParams(initial_time, initial_state, simulation_length)
 
-    def generate_ocp_definition(self, simplification: bool=False, common_subexpression_elimination: bool=False):
+    def generate_ocp_definition(self, simplification: bool=False, common_subexpression_elimination: bool=False, 
+                                parameter_block: bool=False):
         """ Generates the C++ source file in which the equations to solve the 
             optimal control problem are described. Before call this method, 
             set_functions() must be called.
@@ -340,6 +354,14 @@ class AutoGenU(object):
                     Symbolic functions are simplified. Default is False.
                 common_subexpression_elimination: The flag for common subexpression elimination. If True, 
                     common subexpressions are eliminated. Default is False.
+                parameter_block: The flag for the parameter block. If True, the OCP 
+                    has a struct Parameters of all the scalar and array variables and 
+                    the bounds, a shared ParameterBlock of it, and parameter_epoch(). 
+                    Then the parameters can be published from another thread and 
+                    synchronize() copies them only when the epoch has changed. 
+                    The variables given by expressions of the other variables are 
+                    not in Parameters and are recomputed by synchronize(). 
+                    Default is False.
         """
         assert self.__symbolic_functions is not None, \
                 "Symbolic functions are not set!. Before call this method, call set_functions()"
@@ -349,10 +371,16 @@ class AutoGenU(object):
         os.makedirs(os.path.join(self.get_ocp_pybind_dir(), self.__ocp_name), exist_ok=True)
         os.makedirs(os.path.join(self.get_ocp_pybind_dir(), 'common'), exist_ok=True)
         if simplification:
-            symutils.simplify(self.__f)
-            symutils.simplify(self.__hx)
-            symutils.simplify(self.__hu)
-            symutils.simplify(self.__phix)
+            symutils.simplify(self.__symbolic_functions.f)
+            symutils.simplify(self.__symbolic_functions.hx)
+            symutils.simplify(self.__symbolic_functions.hu)
+            symutils.simplify(self.__symbolic_functions.huu)
+            symutils.simplify(self.__symbolic_functions.hux)
+            symutils.simplify(self.__symbolic_functions.phix)
+            symutils.simplify(self.__symbolic_functions.f_jvp)
+            symutils.simplify(self.__symbolic_functions.phix_jvp)
+            symutils.simplify(self.__symbolic_functions.hx_jvp)
+            symutils.simplify(self.__symbolic_functions.hu_jvp)
         f_model_h = open(os.path.join(self.get_ocp_dir(), 'ocp.hpp'), 'w')
         f_model_h.write('// This file was automatically generated by autogenu-jupyter (https://github.com/ohtsukalab/autogenu-jupyter). \n')
         f_model_h.write('// The autogenu-jupyter copyright holders make no ownership claim of its contents. \n\n')
@@ -369,9 +397,15 @@ class AutoGenU(object):
 #include <cmath>
 #include <array>
 #include <iostream>
-
-#include "cgmres/types.hpp"
-#include "cgmres/detail/macros.hpp"
+""" 
+        ])
+        if parameter_block:
+            f_model_h.write('#include <memory>\n')
+        f_model_h.write('\n#include "cgmres/types.hpp"\n')
+        if parameter_block:
+            f_model_h.write('#include "cgmres/parameter_block.hpp"\n')
+        f_model_h.writelines([
+"""#include "cgmres/detail/macros.hpp"
 
 namespace cgmres {
 
@@ -511,7 +545,10 @@ public:
         f_model_h.write('    ocp.disp(os);\n')
         f_model_h.write('    return os;\n')
         f_model_h.write('  }\n\n')
-        f_model_h.writelines([
+        if parameter_block:
+            self.__write_parameter_block(f_model_h)
+        else:
+            f_model_h.writelines([
 """
   ///
   /// @brief Synchrozies the internal parameters of this OCP with the external references.
@@ -519,7 +556,10 @@ public:
   ///
   void synchronize() {
   }
-
+"""
+            ])
+        f_model_h.writelines([
+"""
   ///
   /// @brief Computes the state equation dx = f(t, x, u).
   /// @param[in] t Time.
@@ -595,6 +635,164 @@ public:
 """ 
   }
 
+  ///
+  /// @brief Computes the Hessian of the Hamiltonian with respect to control input and the equality constraints, 
+  /// i.e., huu = d^2H/du^2(t, x, u, lmd).
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. 
+  /// @param[in] lmd Costate. 
+  /// @param[out] huu Evaluated value of the Hessian of the Hamiltonian (nuc x nuc, column-major).
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  /// Use the overloaded method if you call this outside of the cgmres solvers. 
+  ///
+  void eval_huu(const double t, const double* x, const double* u, 
+                const double* lmd, double* huu) const {
+""" 
+        ])
+        symutils.write_symfunc(f_model_h, self.__symbolic_functions.huu, 'huu', common_subexpression_elimination)
+        f_model_h.writelines([
+""" 
+  }
+
+  ///
+  /// @brief Computes the Jacobian of hu with respect to the state, 
+  /// i.e., hux = d^2H/dudx(t, x, u, lmd).
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. 
+  /// @param[in] lmd Costate. 
+  /// @param[out] hux Evaluated value of the Jacobian of hu (nuc x nx, column-major).
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  /// Use the overloaded method if you call this outside of the cgmres solvers. 
+  ///
+  void eval_hux(const double t, const double* x, const double* u, 
+                const double* lmd, double* hux) const {
+""" 
+        ])
+        symutils.write_symfunc(f_model_h, self.__symbolic_functions.hux, 'hux', common_subexpression_elimination)
+        f_model_h.writelines([
+""" 
+  }
+
+  ///
+  /// @brief Computes the directional derivative of the state equation, 
+  /// i.e., f_jvp = df/dx(t, x, u) x_dir + df/du(t, x, u) u_dir.
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Control input.
+  /// @param[in] x_dir Direction of the state.
+  /// @param[in] u_dir Direction of the control input.
+  /// @param[out] f_jvp Evaluated value of the directional derivative.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  ///
+  void eval_f_jvp(const double t, const double* x, const double* u, 
+                  const double* x_dir, const double* u_dir, double* f_jvp) const {
+""" 
+        ])
+        symutils.write_symfunc(f_model_h, self.__symbolic_functions.f_jvp, 'f_jvp', common_subexpression_elimination)
+        f_model_h.writelines([
+""" 
+  }
+
+  ///
+  /// @brief Computes the directional derivative of the partial derivative of terminal cost with respect to state, 
+  /// i.e., phix_jvp = d^2phi/dx^2(t, x) x_dir.
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] x_dir Direction of the state.
+  /// @param[out] phix_jvp Evaluated value of the directional derivative.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  ///
+  void eval_phix_jvp(const double t, const double* x, const double* x_dir, 
+                     double* phix_jvp) const {
+""" 
+        ])
+        symutils.write_symfunc(f_model_h, self.__symbolic_functions.phix_jvp, 'phix_jvp', common_subexpression_elimination)
+        f_model_h.writelines([
+""" 
+  }
+
+  ///
+  /// @brief Computes the directional derivative of the partial derivative of the Hamiltonian with respect to state, 
+  /// i.e., hx_jvp = d(hx)/dx x_dir + d(hx)/du u_dir + d(hx)/dlmd lmd_dir.
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. 
+  /// @param[in] lmd Costate. 
+  /// @param[in] x_dir Direction of the state.
+  /// @param[in] u_dir Direction of u.
+  /// @param[in] lmd_dir Direction of the costate.
+  /// @param[out] hx_jvp Evaluated value of the directional derivative.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  ///
+  void eval_hx_jvp(const double t, const double* x, const double* u, 
+                   const double* lmd, const double* x_dir, const double* u_dir, 
+                   const double* lmd_dir, double* hx_jvp) const {
+""" 
+        ])
+        symutils.write_symfunc(f_model_h, self.__symbolic_functions.hx_jvp, 'hx_jvp', common_subexpression_elimination)
+        f_model_h.writelines([
+""" 
+  }
+
+  ///
+  /// @brief Computes the directional derivative of the partial derivative of the Hamiltonian with respect to 
+  /// control input and the equality constraints, 
+  /// i.e., hu_jvp = d(hu)/dx x_dir + d(hu)/du u_dir + d(hu)/dlmd lmd_dir.
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. 
+  /// @param[in] lmd Costate. 
+  /// @param[in] x_dir Direction of the state.
+  /// @param[in] u_dir Direction of u.
+  /// @param[in] lmd_dir Direction of the costate.
+  /// @param[out] hu_jvp Evaluated value of the directional derivative.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  ///
+  void eval_hu_jvp(const double t, const double* x, const double* u, 
+                   const double* lmd, const double* x_dir, const double* u_dir, 
+                   const double* lmd_dir, double* hu_jvp) const {
+""" 
+        ])
+        symutils.write_symfunc(f_model_h, self.__symbolic_functions.hu_jvp, 'hu_jvp', common_subexpression_elimination)
+        f_model_h.writelines([
+""" 
+  }
+
+  ///
+  /// @brief Computes the stage cost L(t, x, u).
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Control input.
+  /// @return Evaluated value of the stage cost.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  /// Use the overloaded method if you call this outside of the cgmres solvers. 
+  ///
+  double eval_L(const double t, const double* x, const double* u) const {
+""" 
+        ])
+        symutils.write_scalar_symfunc(f_model_h, self.__symbolic_functions.L, common_subexpression_elimination)
+        f_model_h.writelines([
+""" 
+  }
+
+  ///
+  /// @brief Computes the terminal cost phi(t, x).
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @return Evaluated value of the terminal cost.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  /// Use the overloaded method if you call this outside of the cgmres solvers. 
+  ///
+  double eval_phi(const double t, const double* x) const {
+""" 
+        ])
+        symutils.write_scalar_symfunc(f_model_h, self.__symbolic_functions.phi, common_subexpression_elimination)
+        f_model_h.writelines([
+""" 
+  }
+
   ///
   /// @brief Computes the state equation dx = f(t, x, u).
   /// @param[in] t Time.
@@ -695,6 +893,99 @@ public:
     eval_hu(t, x.derived().data(), uc.derived().data(), lmd.derived().data(), CGMRES_EIGEN_CONST_CAST(VectorType4, hu).data());
   }
 
+  ///
+  /// @brief Computes the Hessian of the Hamiltonian with respect to control input and the equality constraints, 
+  /// i.e., huu = d^2H/du^2(t, x, u, lmd).
+  /// @param[in] t Time.
+  /// @param[in] x State. Size must be nx.
+  /// @param[in] uc Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. Size must be nuc. 
+  /// @param[in] lmd Costate. Size must be nx. 
+  /// @param[out] huu Evaluated value of the Hessian of the Hamiltonian. Size must be nuc x nuc.
+  ///
+  template <typename VectorType1, typename VectorType2, typename VectorType3, typename MatrixType>
+  void eval_huu(const double t, const MatrixBase<VectorType1>& x, 
+                const MatrixBase<VectorType2>& uc, 
+                const MatrixBase<VectorType3>& lmd, 
+                const MatrixBase<MatrixType>& huu) const {
+    static_assert(!MatrixType::IsRowMajor);
+    if (x.size() != nx) {
+      throw std::invalid_argument("[OCP]: x.size() must be " + std::to_string(nx));
+    }
+    if (uc.size() != nuc) {
+      throw std::invalid_argument("[OCP]: uc.size() must be " + std::to_string(nuc));
+    }
+    if (lmd.size() != nx) {
+      throw std::invalid_argument("[OCP]: lmd.size() must be " + std::to_string(nx));
+    }
+    if (huu.rows() != nuc || huu.cols() != nuc) {
+      throw std::invalid_argument("[OCP]: huu must be " + std::to_string(nuc) + "x" + std::to_string(nuc));
+    }
+    eval_huu(t, x.derived().data(), uc.derived().data(), lmd.derived().data(), CGMRES_EIGEN_CONST_CAST(MatrixType, huu).data());
+  }
+
+  ///
+  /// @brief Computes the Jacobian of hu with respect to the state, 
+  /// i.e., hux = d^2H/dudx(t, x, u, lmd).
+  /// @param[in] t Time.
+  /// @param[in] x State. Size must be nx.
+  /// @param[in] uc Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. Size must be nuc. 
+  /// @param[in] lmd Costate. Size must be nx. 
+  /// @param[out] hux Evaluated value of the Jacobian of hu. Size must be nuc x nx.
+  ///
+  template <typename VectorType1, typename VectorType2, typename VectorType3, typename MatrixType>
+  void eval_hux(const double t, const MatrixBase<VectorType1>& x, 
+                const MatrixBase<VectorType2>& uc, 
+                const MatrixBase<VectorType3>& lmd, 
+                const MatrixBase<MatrixType>& hux) const {
+    static_assert(!MatrixType::IsRowMajor);
+    if (x.size() != nx) {
+      throw std::invalid_argument("[OCP]: x.size() must be " + std::to_string(nx));
+    }
+    if (uc.size() != nuc) {
+      throw std::invalid_argument("[OCP]: uc.size() must be " + std::to_string(nuc));
+    }
+    if (lmd.size() != nx) {
+      throw std::invalid_argument("[OCP]: lmd.size() must be " + std::to_string(nx));
+    }
+    if (hux.rows() != nuc || hux.cols() != nx) {
+      throw std::invalid_argument("[OCP]: hux must be " + std::to_string(nuc) + "x" + std::to_string(nx));
+    }
+    eval_hux(t, x.derived().data(), uc.derived().data(), lmd.derived().data(), CGMRES_EIGEN_CONST_CAST(MatrixType, hux).data());
+  }
+
+  ///
+  /// @brief Computes the stage cost L(t, x, u).
+  /// @param[in] t Time.
+  /// @param[in] x State. Size must be nx.
+  /// @param[in] u Control input. Size must be nu.
+  /// @return Evaluated value of the stage cost.
+  ///
+  template <typename VectorType1, typename VectorType2>
+  double eval_L(const double t, const MatrixBase<VectorType1>& x, 
+                const MatrixBase<VectorType2>& u) const {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[OCP]: x.size() must be " + std::to_string(nx));
+    }
+    if (u.size() != nu) {
+      throw std::invalid_argument("[OCP]: u.size() must be " + std::to_string(nu));
+    }
+    return eval_L(t, x.derived().data(), u.derived().data());
+  }
+
+  ///
+  /// @brief Computes the terminal cost phi(t, x).
+  /// @param[in] t Time.
+  /// @param[in] x State. Size must be nx.
+  /// @return Evaluated value of the terminal cost.
+  ///
+  template <typename VectorType>
+  double eval_phi(const double t, const MatrixBase<VectorType>& x) const {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[OCP]: x.size() must be " + std::to_string(nx));
+    }
+    return eval_phi(t, x.derived().data());
+  }
+
 };
 
 } // namespace cgmres
@@ -705,6 +996,100 @@ public:
         f_model_h.close()
         print('\'ocp.hpp\', the definition of the OCP, is generated at', self.get_ocp_dir())
 
+    def __is_derived(self, values):
+        return any(len(sympy.sympify(value).free_symbols) > 0 for value in values)
+
+    def __derived_scalar_vars(self):
+        return [scalar_var for scalar_var in self.__scalar_vars if self.__is_derived([scalar_var.value])]
+
+    def __derived_array_vars(self):
+        return [array_var for array_var in self.__array_vars if self.__is_derived(array_var.values)]
+
+    def __parameter_names(self):
+        names = [scalar_var.name for scalar_var in self.__scalar_vars 
+                 if not self.__is_derived([scalar_var.value])] 
+        names += [array_var.name for array_var in self.__array_vars 
+                  if not self.__is_derived(array_var.values)]
+        if len(self.__ubounds) > 0:
+            names += ['umin', 'umax', 'dummy_weight']
+        if self.__nh > 0:
+            names += ['fb_eps']
+        return names
+
+    def __write_parameter_block(self, f_model_h):
+        f_model_h.writelines([
+"""
+  ///
+  /// @struct Parameters
+  /// @brief Parameters of this OCP that can be published from another thread through 
+  /// parameter_block. The default values are those of this OCP. The variables given 
+  /// by expressions of the other parameters are not included and are recomputed by 
+  /// synchronize().
+  ///
+  struct Parameters {
+"""
+        ])
+        f_model_h.writelines([
+            '    double '+scalar_var.name+' = '
+            +str(scalar_var.value)+';\n' for scalar_var in self.__scalar_vars
+            if not self.__is_derived([scalar_var.value])
+        ])
+        for array_var in self.__array_vars:
+            if self.__is_derived(array_var.values):
+                continue
+            f_model_h.write(
+                '    std::array<double, '+str(array_var.size)+'> '+array_var.name+' = {'
+                +', '.join([str(array_var.values[i]) for i in range(array_var.size)])+'};\n'
+            )
+        if len(self.__ubounds) > 0:
+            f_model_h.write('    std::array<double, nub> umin = {'+', '.join([str(e.umin) for e in self.__ubounds])+'};\n')
+            f_model_h.write('    std::array<double, nub> umax = {'+', '.join([str(e.umax) for e in self.__ubounds])+'};\n')
+            f_model_h.write('    std::array<double, nub> dummy_weight = {'+', '.join([str(e.dummy_weight) for e in self.__ubounds])+'};\n')
+        if self.__nh > 0:
+            f_model_h.write('    std::array<double, nh> fb_eps = {'+', '.join([str(e) for e in self.__FB_epsilon])+'};\n')
+        f_model_h.writelines([
+"""  };
+
+  ///
+  /// @brief Shared ptr to the parameter block of this OCP. 
+  /// The parameters can be published from another thread.
+  ///
+  std::shared_ptr<ParameterBlock<Parameters>> parameter_block = nullptr;
+
+  ///
+  /// @brief Epoch of the parameter block. The solvers skip synchronize() 
+  /// while the epoch is unchanged.
+  ///
+  unsigned long parameter_epoch() const {
+    return (parameter_block != nullptr) ? parameter_block->epoch() : 0;
+  }
+
+  ///
+  /// @brief Synchrozies the internal parameters of this OCP with the parameter block.
+  /// This method is called at the beginning of each MPC update if the epoch has changed.
+  ///
+  void synchronize() {
+    if (parameter_block != nullptr) {
+      const Parameters parameters = parameter_block->read();
+"""
+        ])
+        f_model_h.writelines([
+            '      '+name+' = parameters.'+name+';\n' for name in self.__parameter_names()
+        ])
+        f_model_h.writelines([
+            '      '+scalar_var.name+' = '+str(scalar_var.value)+';\n' 
+            for scalar_var in self.__derived_scalar_vars()
+        ])
+        f_model_h.writelines([
+            '      '+array_var.name+' = {'+', '.join([str(value) for value in array_var.values])+'};\n' 
+            for array_var in self.__derived_array_vars()
+        ])
+        f_model_h.writelines([
+"""    }
+  }
+"""
+        ])
+
     def generate_main(self):
         """ Generates main.cpp that defines NMPC solver, set parameters for the 
             solver, and run numerical simulation. Befire call this method,
@@ -1087,6 +1472,41 @@ namespace py = pybind11;
         f_pybind11.writelines([
 """
 
+} // namespace python
+} // namespace cgmres
+""" 
+        ])
+        f_pybind11.close()
+        f_pybind11 = open(os.path.join(self.get_ocp_pybind_dir(), self.__ocp_name, 'riccati_newton_solver.cpp'), 'w')
+        f_pybind11.writelines([
+"""
+// This file was automatically generated by autogenu-jupyter (https://github.com/ohtsukalab/autogenu-jupyter). 
+// The autogenu-jupyter copyright holders make no ownership claim of its contents. 
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
+
+#include "cgmres/riccati_newton_solver.hpp"
+#include "cgmres/python/riccati_newton_solver.hpp"
+#include "ocp.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace cgmres {
+namespace python {
+
+namespace py = pybind11;
+
+""" 
+        ])
+        f_pybind11.write('constexpr int N = '+str(self.__solver_params.N)+';\n')
+        f_pybind11.write('DEFINE_PYBIND11_MODULE_RICCATI_NEWTON_SOLVER(OCP_'+str(self.__ocp_name)+', N)\n')
+        f_pybind11.writelines([
+"""
+
 } // namespace python
 } // namespace cgmres
 """ 
@@ -1190,6 +1610,7 @@ from .ocp import *
 from .zero_horizon_ocp_solver import *
 from .single_shooting_cgmres_solver import *
 from .multiple_shooting_cgmres_solver import *
+from .riccati_newton_solver import *
 """ 
         ])
         f_pybind11.close()
@@ -1296,6 +1717,7 @@ pybind11_add_cgmres_module(ocp)
 pybind11_add_cgmres_module(zero_horizon_ocp_solver)
 pybind11_add_cgmres_module(single_shooting_cgmres_solver)
 pybind11_add_cgmres_module(multiple_shooting_cgmres_solver)
+pybind11_add_cgmres_module(riccati_newton_solver)
 
 set(CGMRES_PYTHON_VERSION ${PYTHON_VERSION_MAJOR}.${PYTHON_VERSION_MINOR})
 """
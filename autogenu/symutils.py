@@ -16,6 +16,43 @@ def diff_scalar_func(scalar_func, var):
     return [sympy.diff(scalar_func, var[i]) for i in range(len(var))]
 
 
+def diff_vector_func(vector_func, var):
+    """ Calculate Jacobian of a vector-valued function with respect to a 
+        vector. 
+
+        Args:
+            vector_func: A symbolic vector-valued function.
+            var: A symbolic vector.
+
+        Returns: 
+            Jacobian of vector_func with respect to var flattened in the 
+            column-major order, i.e., the (i, j) element is at 
+            i + len(vector_func) * j.
+    """
+    return [sympy.diff(vector_func[i], var[j]) 
+            for j in range(len(var)) for i in range(len(vector_func))]
+
+
+def jvp(vector_func, var_list, dir_list):
+    """ Calculate Jacobian-vector product (directional derivative) of a 
+        vector-valued function. 
+
+        Args:
+            vector_func: A symbolic vector-valued function.
+            var_list: A list of symbolic vectors, i.e., the variables.
+            dir_list: A list of symbolic vectors, i.e., the directions of the 
+                variables. The sizes must be the same as those of var_list.
+
+        Returns: 
+            Sum of the Jacobians of vector_func with respect to each variable 
+            multiplied by the corresponding direction.
+    """
+    assert len(var_list) == len(dir_list)
+    return [sum(sympy.diff(vector_func[i], var[j]) * dir[j] 
+                for var, dir in zip(var_list, dir_list) for j in range(len(var)))
+            for i in range(len(vector_func))]
+
+
 def simplify(func):
     """ Simplifies a scalar-valued or vector-valued function.
 
@@ -57,4 +94,26 @@ def write_symfunc(writable_file, function, output_value_name: str, common_subexp
         writable_file.writelines(
             ['    '+output_value_name+'[%d] = '%i
             +sympy.ccode(function[i])+';\n' for i in range(len(function))]
-        )
\ No newline at end of file
+        )
+def write_scalar_symfunc(writable_file, function, common_subexpression_elimination: bool):
+    """ Write input symbolic scalar-valued function onto writable_file as the 
+        return statement. common_subexpression_elimination is optional.
+
+        Args: 
+            writable_file: A writable file, i.e., a file streaming that is 
+                already opened as writing mode.
+            function: A symbolic scalar-valued function wrote onto the writable_file.
+            common_subexpression_elimination: If true, common subexpression elimination is used. If 
+                False, it is not used.
+    """
+    if common_subexpression_elimination:
+        func_cse = sympy.cse(function)
+        for i in range(len(func_cse[0])):
+            cse_exp, cse_rhs = func_cse[0][i]
+            writable_file.write(
+                '    const double '+sympy.ccode(cse_exp)
+                +' = '+sympy.ccode(cse_rhs)+';\n'
+            )
+        writable_file.write('    return '+sympy.ccode(func_cse[1][0])+';\n')
+    else:
+        writable_file.write('    return '+sympy.ccode(function)+';\n')
@@ -11,8 +11,9 @@ int main() {
   cgmres::OCP_cartpoleExternalReference ocp;
 
   // set the external reference ptr
-  auto external_reference = std::make_shared<cgmres::OCP_cartpoleExternalReference::ExternalReference>();
-  external_reference->cart_position = 0.0;
+  using ExternalReference = cgmres::OCP_cartpoleExternalReference::ExternalReference;
+  auto external_reference = std::make_shared<cgmres::ParameterBlock<ExternalReference>>();
+  external_reference->publish(ExternalReference{0.0});
   ocp.external_reference = external_reference;
 
   // Define the horizon.
@@ -58,6 +59,7 @@ int main() {
   double t = t0;
   cgmres::VectorX x = x0;
   cgmres::VectorX dx = cgmres::VectorX::Zero(x0.size());
+  bool reference_switched = false;
   for (int i=0; i<sim_steps; ++i) {
     const auto& u = mpc.uopt()[0]; // const reference to the initial optimal control input 
     dx.setZero();
@@ -68,9 +70,10 @@ int main() {
     t = t + sampling_time;
     std::cout << "t: " << t << ", x: " << x.transpose() << std::endl;
 
-    // switch the reference
-    if (t > 5.0) {
-      external_reference->cart_position = 1.0;
+    // switch the reference once; the parameter block is read only by the solver
+    if (t > 5.0 && !reference_switched) {
+      external_reference->publish(ExternalReference{1.0});
+      reference_switched = true;
     }
   }
 
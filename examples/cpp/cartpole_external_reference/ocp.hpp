@@ -12,6 +12,7 @@
 #include <memory>
 
 #include "cgmres/types.hpp"
+#include "cgmres/parameter_block.hpp"
 #include "cgmres/detail/macros.hpp"
 
 namespace cgmres {
@@ -112,9 +113,18 @@ public:
   };
 
   ///
-  /// @brief Shared ptr to the external reference of the cart pole.
+  /// @brief Shared ptr to the external reference of the cart pole. 
+  /// The reference can be published from another thread.
   ///
-  std::shared_ptr<ExternalReference> external_reference = nullptr;
+  std::shared_ptr<ParameterBlock<ExternalReference>> external_reference = nullptr;
+
+  ///
+  /// @brief Epoch of the external reference. The solvers skip synchronize() 
+  /// while the epoch is unchanged.
+  ///
+  unsigned long parameter_epoch() const {
+    return (external_reference != nullptr) ? external_reference->epoch() : 0;
+  }
 
   ///
   /// @brief Synchrozies the internal parameters of this OCP with the external references.
@@ -122,7 +132,7 @@ public:
   ///
   void synchronize() {
     if (external_reference != nullptr) {
-      x_ref[0] = external_reference->cart_position;
+      x_ref[0] = external_reference->read().cart_position;
     }
   }
 
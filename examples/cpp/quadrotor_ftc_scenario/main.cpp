@@ -0,0 +1,77 @@
+#include "ocp.hpp"
+
+#include "cgmres/scenario_ocp.hpp"
+#include "cgmres/zero_horizon_ocp_solver.hpp"
+#include "cgmres/multiple_shooting_cgmres_solver.hpp"
+#include "cgmres/integrator.hpp"
+
+#include <string>
+
+int main() {
+  // Define the scenarios of the uncertain fault: the first rotor is lost (c1 = 0)
+  // or healthy (c1 = 1).
+  constexpr int S = 2;
+  std::array<cgmres::OCP_QuadrotorFTC, S> scenarios;
+  scenarios[1].c1 = 1.0;
+  scenarios[1].u_ref.fill(scenarios[1].g*scenarios[1].m/(scenarios[1].c1+3));
+  using ScenarioOCP = cgmres::ScenarioOCP<cgmres::OCP_QuadrotorFTC, S>;
+  ScenarioOCP ocp(scenarios);
+
+  // Define the horizon.
+  const double Tf = 0.4;
+  const double alpha = 1.0;
+  cgmres::Horizon horizon(Tf, alpha);
+
+  // Define the solver settings.
+  cgmres::SolverSettings settings;
+  settings.sampling_time = 0.001; // sampling period
+  settings.zeta = 1000.0;
+  settings.finite_difference_epsilon = 1e-08;
+  // For initialization.
+  settings.max_iter = 100;
+  settings.opterr_tol = 1e-06;
+
+  // Define the initial time and initial state.
+  const double t0 = 0;
+  cgmres::Vector<13> x0;
+  x0 << -1, -1, -1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0;
+
+  // Initialize the solution of the C/GMRES method with that of the first scenario.
+  constexpr int kmax_init = 4;
+  cgmres::ZeroHorizonOCPSolver<cgmres::OCP_QuadrotorFTC, kmax_init> initializer(scenarios[0], settings);
+  cgmres::Vector<4> uc0;
+  uc0 << 0.1, 0.11, 0.09, 0.12;
+  initializer.set_uc(uc0);
+  initializer.solve(t0, x0);
+
+  // Define the C/GMRES solver of the scenario-tree OCP.
+  constexpr int N = 100;
+  constexpr int kmax = 10;
+  cgmres::MultipleShootingCGMRESSolver<ScenarioOCP, N, kmax> mpc(ocp, horizon, settings);
+  mpc.set_uc(ScenarioOCP::stack_uc(initializer.ucopt()));
+  mpc.init_x_lmd(t0, ScenarioOCP::stack_x(x0));
+  mpc.init_dummy_mu();
+
+  // Perform a numerical simulation of the quadrotor with the lost rotor.
+  const double tsim = 2.0;
+  const double sampling_time = settings.sampling_time;
+  const int sim_steps = std::floor(tsim / sampling_time);
+
+  double t = t0;
+  cgmres::VectorX x = x0;
+  for (int i=0; i<sim_steps; ++i) {
+    const auto& u = mpc.uopt()[0]; // the first-stage control input shared by the scenarios
+    const cgmres::VectorX x1 = cgmres::RK4(scenarios[0], t, sampling_time, x, u);
+    mpc.update(t, ScenarioOCP::stack_x(x));
+    x = x1;
+    t = t + sampling_time;
+    if (i%100 == 0) {
+      std::cout << "t: " << t << ", x: " << x.transpose() << ", opterr: " << mpc.optError() << std::endl;
+    }
+  }
+
+  std::cout << "\n======================= MPC used in this simulation: =======================" << std::endl;
+  std::cout << mpc << std::endl;
+
+  return 0;
+}
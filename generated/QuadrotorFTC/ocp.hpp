@@ -9,8 +9,10 @@
 #include <cmath>
 #include <array>
 #include <iostream>
+#include <memory>
 
 #include "cgmres/types.hpp"
+#include "cgmres/parameter_block.hpp"
 #include "cgmres/detail/macros.hpp"
 
 namespace cgmres {
@@ -112,10 +114,70 @@ public:
 
 
   ///
-  /// @brief Synchrozies the internal parameters of this OCP with the external references.
-  /// This method is called at the beginning of each MPC update.
+  /// @struct Parameters
+  /// @brief Parameters of this OCP that can be published from another thread through 
+  /// parameter_block. The default values are those of this OCP. The variables given 
+  /// by expressions of the other parameters are not included and are recomputed by 
+  /// synchronize().
+  ///
+  struct Parameters {
+    double m = 0.063;
+    double g = 9.81;
+    double J1 = 5.83e-05;
+    double J2 = 7.17e-05;
+    double J3 = 0.0001;
+    double d3 = 0.001;
+    double l = 0.0624;
+    double k = 0.0731;
+    double c1 = 0.0;
+    std::array<double, 13> s = {5, 5, 50, 1, 1, 1, 0, 1, 1, 1, 0.1, 0.1, 0.1};
+    std::array<double, 13> s_terminal = {5, 5, 50, 1, 1, 1, 0, 1, 1, 1, 0.1, 0.1, 0.1};
+    std::array<double, 13> x_ref = {0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0};
+    std::array<double, 4> r = {1, 1, 1, 1};
+    std::array<double, nub> umin = {0.0065, 0.0065, 0.0065, 0.0065};
+    std::array<double, nub> umax = {0.3266, 0.3266, 0.3266, 0.3266};
+    std::array<double, nub> dummy_weight = {100.0, 100.0, 100.0, 100.0};
+  };
+
+  ///
+  /// @brief Shared ptr to the parameter block of this OCP. 
+  /// The parameters can be published from another thread.
+  ///
+  std::shared_ptr<ParameterBlock<Parameters>> parameter_block = nullptr;
+
+  ///
+  /// @brief Epoch of the parameter block. The solvers skip synchronize() 
+  /// while the epoch is unchanged.
+  ///
+  unsigned long parameter_epoch() const {
+    return (parameter_block != nullptr) ? parameter_block->epoch() : 0;
+  }
+
+  ///
+  /// @brief Synchrozies the internal parameters of this OCP with the parameter block.
+  /// This method is called at the beginning of each MPC update if the epoch has changed.
   ///
   void synchronize() {
+    if (parameter_block != nullptr) {
+      const Parameters parameters = parameter_block->read();
+      m = parameters.m;
+      g = parameters.g;
+      J1 = parameters.J1;
+      J2 = parameters.J2;
+      J3 = parameters.J3;
+      d3 = parameters.d3;
+      l = parameters.l;
+      k = parameters.k;
+      c1 = parameters.c1;
+      s = parameters.s;
+      s_terminal = parameters.s_terminal;
+      x_ref = parameters.x_ref;
+      r = parameters.r;
+      umin = parameters.umin;
+      umax = parameters.umax;
+      dummy_weight = parameters.dummy_weight;
+      u_ref = {g*m/(c1 + 3), g*m/(c1 + 3), g*m/(c1 + 3), g*m/(c1 + 3)};
+    }
   }
 
   ///
@@ -264,6 +326,379 @@ public:
  
   }
 
+  ///
+  /// @brief Computes the Hessian of the Hamiltonian with respect to control input and the equality constraints, 
+  /// i.e., huu = d^2H/du^2(t, x, u, lmd).
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. 
+  /// @param[in] lmd Costate. 
+  /// @param[out] huu Evaluated value of the Hessian of the Hamiltonian (nuc x nuc, column-major).
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  /// Use the overloaded method if you call this outside of the cgmres solvers. 
+  ///
+  void eval_huu(const double t, const double* x, const double* u, 
+                const double* lmd, double* huu) const {
+    huu[0] = r[0];
+    huu[1] = 0;
+    huu[2] = 0;
+    huu[3] = 0;
+    huu[4] = 0;
+    huu[5] = r[1];
+    huu[6] = 0;
+    huu[7] = 0;
+    huu[8] = 0;
+    huu[9] = 0;
+    huu[10] = r[2];
+    huu[11] = 0;
+    huu[12] = 0;
+    huu[13] = 0;
+    huu[14] = 0;
+    huu[15] = r[3];
+ 
+  }
+
+  ///
+  /// @brief Computes the Jacobian of hu with respect to the state, 
+  /// i.e., hux = d^2H/dudx(t, x, u, lmd).
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. 
+  /// @param[in] lmd Costate. 
+  /// @param[out] hux Evaluated value of the Jacobian of hu (nuc x nx, column-major).
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  /// Use the overloaded method if you call this outside of the cgmres solvers. 
+  ///
+  void eval_hux(const double t, const double* x, const double* u, 
+                const double* lmd, double* hux) const {
+    const double x0 = 1.0/m;
+    const double x1 = 2*x0;
+    const double x2 = lmd[3]*x1;
+    const double x3 = x2*x[8];
+    const double x4 = lmd[4]*x1;
+    const double x5 = x4*x[7];
+    const double x6 = lmd[5]*x1;
+    const double x7 = x6*x[6];
+    const double x8 = x3 - x5 + x7;
+    const double x9 = x4*x[6];
+    const double x10 = x6*x[7];
+    const double x11 = 2*lmd[3]*x0*x[9] - x10 - x9;
+    const double x12 = x2*x[6];
+    const double x13 = x4*x[9];
+    const double x14 = x6*x[8];
+    const double x15 = x12 + x13 - x14;
+    const double x16 = x2*x[7];
+    const double x17 = x4*x[8];
+    const double x18 = x6*x[9];
+    const double x19 = x16 + x17 + x18;
+    hux[0] = 0;
+    hux[1] = 0;
+    hux[2] = 0;
+    hux[3] = 0;
+    hux[4] = 0;
+    hux[5] = 0;
+    hux[6] = 0;
+    hux[7] = 0;
+    hux[8] = 0;
+    hux[9] = 0;
+    hux[10] = 0;
+    hux[11] = 0;
+    hux[12] = 0;
+    hux[13] = 0;
+    hux[14] = 0;
+    hux[15] = 0;
+    hux[16] = 0;
+    hux[17] = 0;
+    hux[18] = 0;
+    hux[19] = 0;
+    hux[20] = 0;
+    hux[21] = 0;
+    hux[22] = 0;
+    hux[23] = 0;
+    hux[24] = c1*x3 - c1*x5 + c1*x7;
+    hux[25] = x8;
+    hux[26] = x8;
+    hux[27] = x8;
+    hux[28] = 2*c1*lmd[3]*x0*x[9] - c1*x10 - c1*x9;
+    hux[29] = x11;
+    hux[30] = x11;
+    hux[31] = x11;
+    hux[32] = c1*x12 + c1*x13 - c1*x14;
+    hux[33] = x15;
+    hux[34] = x15;
+    hux[35] = x15;
+    hux[36] = c1*x16 + c1*x17 + c1*x18;
+    hux[37] = x19;
+    hux[38] = x19;
+    hux[39] = x19;
+    hux[40] = 0;
+    hux[41] = 0;
+    hux[42] = 0;
+    hux[43] = 0;
+    hux[44] = 0;
+    hux[45] = 0;
+    hux[46] = 0;
+    hux[47] = 0;
+    hux[48] = 0;
+    hux[49] = 0;
+    hux[50] = 0;
+    hux[51] = 0;
+ 
+  }
+
+  ///
+  /// @brief Computes the directional derivative of the state equation, 
+  /// i.e., f_jvp = df/dx(t, x, u) x_dir + df/du(t, x, u) u_dir.
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Control input.
+  /// @param[in] x_dir Direction of the state.
+  /// @param[in] u_dir Direction of the control input.
+  /// @param[out] f_jvp Evaluated value of the directional derivative.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  ///
+  void eval_f_jvp(const double t, const double* x, const double* u, 
+                  const double* x_dir, const double* u_dir, double* f_jvp) const {
+    const double x0 = 1.0/m;
+    const double x1 = 2*x[6];
+    const double x2 = 2*x[9];
+    const double x3 = x0*(x1*x[8] + x2*x[7]);
+    const double x4 = x0*(c1*u[0] + u[1] + u[2] + u[3]);
+    const double x5 = x1*x4;
+    const double x6 = 2*x4;
+    const double x7 = x6*x[7];
+    const double x8 = x6*x[8];
+    const double x9 = x2*x4;
+    const double x10 = c1*u_dir[0];
+    const double x11 = x0*(-x1*x[7] + 2*x[8]*x[9]);
+    const double x12 = x0*(pow(x[6], 2) - pow(x[7], 2) - pow(x[8], 2) + pow(x[9], 2));
+    const double x13 = (1.0/2.0)*x[10];
+    const double x14 = (1.0/2.0)*x_dir[8];
+    const double x15 = (1.0/2.0)*x_dir[9];
+    const double x16 = (1.0/2.0)*x_dir[10];
+    const double x17 = (1.0/2.0)*x[8];
+    const double x18 = (1.0/2.0)*x[9];
+    const double x19 = (1.0/2.0)*x[11];
+    const double x20 = (1.0/2.0)*x[12];
+    const double x21 = (1.0/2.0)*x[6];
+    const double x22 = (1.0/2.0)*x[7];
+    const double x23 = 1.0/J1;
+    const double x24 = l*x23;
+    const double x25 = -J3*x[12];
+    const double x26 = J2*x[11];
+    const double x27 = 1.0/J2;
+    const double x28 = l*x27;
+    const double x29 = J1*x[10];
+    const double x30 = 1.0/J3;
+    const double x31 = k*x30;
+    f_jvp[0] = x_dir[3];
+    f_jvp[1] = x_dir[4];
+    f_jvp[2] = x_dir[5];
+    f_jvp[3] = u_dir[1]*x3 + u_dir[2]*x3 + u_dir[3]*x3 + x10*x3 + x5*x_dir[8] + x7*x_dir[9] + x8*x_dir[6] + x9*x_dir[7];
+    f_jvp[4] = u_dir[1]*x11 + u_dir[2]*x11 + u_dir[3]*x11 + x10*x11 - x5*x_dir[7] - x7*x_dir[6] + x8*x_dir[9] + x9*x_dir[8];
+    f_jvp[5] = u_dir[1]*x12 + u_dir[2]*x12 + u_dir[3]*x12 + x10*x12 + x5*x_dir[6] - x7*x_dir[7] - x8*x_dir[8] + x9*x_dir[9];
+    f_jvp[6] = -x13*x_dir[7] - x14*x[11] - x15*x[12] - x16*x[7] - x17*x_dir[11] - x18*x_dir[12];
+    f_jvp[7] = x13*x_dir[6] + x14*x[12] - x15*x[11] + x16*x[6] + x17*x_dir[12] - x18*x_dir[11];
+    f_jvp[8] = x13*x_dir[9] + x16*x[9] + x19*x_dir[6] - x20*x_dir[7] + x21*x_dir[11] - x22*x_dir[12];
+    f_jvp[9] = -x13*x_dir[8] - x16*x[8] + x19*x_dir[7] + x20*x_dir[6] + x21*x_dir[12] + x22*x_dir[11];
+    f_jvp[10] = u_dir[1]*x24 - u_dir[3]*x24 + x23*x_dir[11]*(J2*x[12] + x25) + x23*x_dir[12]*(-J3*x[11] + x26);
+    f_jvp[11] = u_dir[2]*x28 - x10*x28 + x27*x_dir[10]*(-J1*x[12] - x25) + x27*x_dir[12]*(J3*x[10] - x29);
+    f_jvp[12] = -d3*x30*x_dir[12] - u_dir[1]*x31 + u_dir[2]*x31 - u_dir[3]*x31 + x10*x31 + x30*x_dir[10]*(J1*x[11] - x26) + x30*x_dir[11]*(-J2*x[10] + x29);
+ 
+  }
+
+  ///
+  /// @brief Computes the directional derivative of the partial derivative of terminal cost with respect to state, 
+  /// i.e., phix_jvp = d^2phi/dx^2(t, x) x_dir.
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] x_dir Direction of the state.
+  /// @param[out] phix_jvp Evaluated value of the directional derivative.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  ///
+  void eval_phix_jvp(const double t, const double* x, const double* x_dir, 
+                     double* phix_jvp) const {
+    phix_jvp[0] = s_terminal[0]*x_dir[0];
+    phix_jvp[1] = s_terminal[1]*x_dir[1];
+    phix_jvp[2] = s_terminal[2]*x_dir[2];
+    phix_jvp[3] = s_terminal[3]*x_dir[3];
+    phix_jvp[4] = s_terminal[4]*x_dir[4];
+    phix_jvp[5] = s_terminal[5]*x_dir[5];
+    phix_jvp[6] = s_terminal[6]*x_dir[6];
+    phix_jvp[7] = s_terminal[7]*x_dir[7];
+    phix_jvp[8] = s_terminal[8]*x_dir[8];
+    phix_jvp[9] = s_terminal[9]*x_dir[9];
+    phix_jvp[10] = s_terminal[10]*x_dir[10];
+    phix_jvp[11] = s_terminal[11]*x_dir[11];
+    phix_jvp[12] = s_terminal[12]*x_dir[12];
+ 
+  }
+
+  ///
+  /// @brief Computes the directional derivative of the partial derivative of the Hamiltonian with respect to state, 
+  /// i.e., hx_jvp = d(hx)/dx x_dir + d(hx)/du u_dir + d(hx)/dlmd lmd_dir.
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. 
+  /// @param[in] lmd Costate. 
+  /// @param[in] x_dir Direction of the state.
+  /// @param[in] u_dir Direction of u.
+  /// @param[in] lmd_dir Direction of the costate.
+  /// @param[out] hx_jvp Evaluated value of the directional derivative.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  ///
+  void eval_hx_jvp(const double t, const double* x, const double* u, 
+                   const double* lmd, const double* x_dir, const double* u_dir, 
+                   const double* lmd_dir, double* hx_jvp) const {
+    const double x0 = (1.0/2.0)*x_dir[10];
+    const double x1 = (1.0/2.0)*x_dir[11];
+    const double x2 = (1.0/2.0)*x_dir[12];
+    const double x3 = (1.0/2.0)*x[10];
+    const double x4 = (1.0/2.0)*x[11];
+    const double x5 = (1.0/2.0)*x[12];
+    const double x6 = c1*u[0] + u[1] + u[2] + u[3];
+    const double x7 = 1.0/m;
+    const double x8 = 2*x7;
+    const double x9 = lmd[3]*x8;
+    const double x10 = x6*x9;
+    const double x11 = lmd[4]*x8;
+    const double x12 = x11*x6;
+    const double x13 = x6*x8;
+    const double x14 = lmd_dir[3]*x13;
+    const double x15 = lmd_dir[4]*x13;
+    const double x16 = lmd_dir[5]*x13;
+    const double x17 = lmd[5]*x8;
+    const double x18 = x17*x6;
+    const double x19 = x9*x[8];
+    const double x20 = x11*x[7];
+    const double x21 = x17*x[6];
+    const double x22 = x19 - x20 + x21;
+    const double x23 = x11*x[6];
+    const double x24 = x17*x[7];
+    const double x25 = 2*lmd[3]*x7*x[9] - x23 - x24;
+    const double x26 = x9*x[6];
+    const double x27 = x11*x[9];
+    const double x28 = x17*x[8];
+    const double x29 = x26 + x27 - x28;
+    const double x30 = x9*x[7];
+    const double x31 = x11*x[8];
+    const double x32 = x17*x[9];
+    const double x33 = x30 + x31 + x32;
+    const double x34 = (1.0/2.0)*x_dir[7];
+    const double x35 = (1.0/2.0)*x_dir[6];
+    const double x36 = (1.0/2.0)*x_dir[9];
+    const double x37 = (1.0/2.0)*x_dir[8];
+    const double x38 = (1.0/2.0)*x[7];
+    const double x39 = (1.0/2.0)*x[6];
+    const double x40 = (1.0/2.0)*x[9];
+    const double x41 = (1.0/2.0)*x[8];
+    const double x42 = 1.0/J2;
+    const double x43 = -J3;
+    const double x44 = lmd[11]*x42*(-J1 - x43);
+    const double x45 = 1.0/J3;
+    const double x46 = lmd[12]*x45*(J1 - J2);
+    const double x47 = -J3*x[12];
+    const double x48 = lmd_dir[11]*x42;
+    const double x49 = J2*x[11];
+    const double x50 = lmd_dir[12]*x45;
+    const double x51 = 1.0/J1;
+    const double x52 = lmd[10]*x51*(J2 + x43);
+    const double x53 = lmd_dir[10]*x51;
+    const double x54 = J1*x[10];
+    hx_jvp[0] = s[0]*x_dir[0];
+    hx_jvp[1] = s[1]*x_dir[1];
+    hx_jvp[2] = s[2]*x_dir[2];
+    hx_jvp[3] = lmd_dir[0] + s[3]*x_dir[3];
+    hx_jvp[4] = lmd_dir[1] + s[4]*x_dir[4];
+    hx_jvp[5] = lmd_dir[2] + s[5]*x_dir[5];
+    hx_jvp[6] = lmd[7]*x0 + lmd[8]*x1 + lmd[9]*x2 + lmd_dir[7]*x3 + lmd_dir[8]*x4 + lmd_dir[9]*x5 + u_dir[0]*(c1*x19 - c1*x20 + c1*x21) + u_dir[1]*x22 + u_dir[2]*x22 + u_dir[3]*x22 + x10*x_dir[8] - x12*x_dir[7] + x14*x[8] - x15*x[7] + x16*x[6] + x_dir[6]*(s[6] + x18);
+    hx_jvp[7] = -lmd[6]*x0 - lmd[8]*x2 + lmd[9]*x1 - lmd_dir[6]*x3 - lmd_dir[8]*x5 + lmd_dir[9]*x4 + u_dir[0]*(2*c1*lmd[3]*x7*x[9] - c1*x23 - c1*x24) + u_dir[1]*x25 + u_dir[2]*x25 + u_dir[3]*x25 + x10*x_dir[9] - x12*x_dir[6] + x14*x[9] - x15*x[6] - x16*x[7] + x_dir[7]*(s[7] - x18);
+    hx_jvp[8] = -lmd[6]*x1 + lmd[7]*x2 - lmd[9]*x0 - lmd_dir[6]*x4 + lmd_dir[7]*x5 - lmd_dir[9]*x3 + u_dir[0]*(c1*x26 + c1*x27 - c1*x28) + u_dir[1]*x29 + u_dir[2]*x29 + u_dir[3]*x29 + x10*x_dir[6] + x12*x_dir[9] + x14*x[6] + x15*x[9] - x16*x[8] + x_dir[8]*(s[8] - x18);
+    hx_jvp[9] = -lmd[6]*x2 - lmd[7]*x1 + lmd[8]*x0 - lmd_dir[6]*x5 - lmd_dir[7]*x4 + lmd_dir[8]*x3 + u_dir[0]*(c1*x30 + c1*x31 + c1*x32) + u_dir[1]*x33 + u_dir[2]*x33 + u_dir[3]*x33 + x10*x_dir[7] + x12*x_dir[8] + x14*x[7] + x15*x[8] + x16*x[9] + x_dir[9]*(s[9] + x18);
+    hx_jvp[10] = -lmd[6]*x34 + lmd[7]*x35 + lmd[8]*x36 - lmd[9]*x37 - lmd_dir[6]*x38 + lmd_dir[7]*x39 + lmd_dir[8]*x40 - lmd_dir[9]*x41 + s[10]*x_dir[10] + x44*x_dir[12] + x46*x_dir[11] + x48*(-J1*x[12] - x47) + x50*(J1*x[11] - x49);
+    hx_jvp[11] = -lmd[6]*x37 - lmd[7]*x36 + lmd[8]*x35 + lmd[9]*x34 - lmd_dir[6]*x41 - lmd_dir[7]*x40 + lmd_dir[8]*x39 + lmd_dir[9]*x38 + s[11]*x_dir[11] + x46*x_dir[10] + x50*(-J2*x[10] + x54) + x52*x_dir[12] + x53*(J2*x[12] + x47);
+    hx_jvp[12] = -d3*x50 - lmd[6]*x36 + lmd[7]*x37 - lmd[8]*x34 + lmd[9]*x35 - lmd_dir[6]*x40 + lmd_dir[7]*x41 - lmd_dir[8]*x38 + lmd_dir[9]*x39 + s[12]*x_dir[12] + x44*x_dir[10] + x48*(J3*x[10] - x54) + x52*x_dir[11] + x53*(-J3*x[11] + x49);
+ 
+  }
+
+  ///
+  /// @brief Computes the directional derivative of the partial derivative of the Hamiltonian with respect to 
+  /// control input and the equality constraints, 
+  /// i.e., hu_jvp = d(hu)/dx x_dir + d(hu)/du u_dir + d(hu)/dlmd lmd_dir.
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. 
+  /// @param[in] lmd Costate. 
+  /// @param[in] x_dir Direction of the state.
+  /// @param[in] u_dir Direction of u.
+  /// @param[in] lmd_dir Direction of the costate.
+  /// @param[out] hu_jvp Evaluated value of the directional derivative.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  ///
+  void eval_hu_jvp(const double t, const double* x, const double* u, 
+                   const double* lmd, const double* x_dir, const double* u_dir, 
+                   const double* lmd_dir, double* hu_jvp) const {
+    const double x0 = k*lmd_dir[12]/J3;
+    const double x1 = l*lmd_dir[11]/J2;
+    const double x2 = 1.0/m;
+    const double x3 = 2*x[6];
+    const double x4 = 2*x[9];
+    const double x5 = lmd_dir[3]*x2*(x3*x[8] + x4*x[7]);
+    const double x6 = lmd_dir[4]*x2*(-x3*x[7] + 2*x[8]*x[9]);
+    const double x7 = lmd_dir[5]*x2*(pow(x[6], 2) - pow(x[7], 2) - pow(x[8], 2) + pow(x[9], 2));
+    const double x8 = 2*x2;
+    const double x9 = x8*x[8];
+    const double x10 = lmd[3]*x9;
+    const double x11 = x8*x[7];
+    const double x12 = lmd[4]*x11;
+    const double x13 = x2*x3;
+    const double x14 = lmd[5]*x13;
+    const double x15 = lmd[4]*x13;
+    const double x16 = lmd[5]*x11;
+    const double x17 = lmd[3]*x13;
+    const double x18 = x2*x4;
+    const double x19 = lmd[4]*x18;
+    const double x20 = lmd[5]*x9;
+    const double x21 = lmd[3]*x11;
+    const double x22 = lmd[4]*x9;
+    const double x23 = lmd[5]*x18;
+    const double x24 = l*lmd_dir[10]/J1;
+    const double x25 = x5 + x6 + x7 + x_dir[6]*(x10 - x12 + x14) + x_dir[7]*(2*lmd[3]*x2*x[9] - x15 - x16) + x_dir[8]*(x17 + x19 - x20) + x_dir[9]*(x21 + x22 + x23);
+    const double x26 = -x0 + x25;
+    hu_jvp[0] = c1*x0 - c1*x1 + c1*x5 + c1*x6 + c1*x7 + r[0]*u_dir[0] + x_dir[6]*(c1*x10 - c1*x12 + c1*x14) + x_dir[7]*(2*c1*lmd[3]*x2*x[9] - c1*x15 - c1*x16) + x_dir[8]*(c1*x17 + c1*x19 - c1*x20) + x_dir[9]*(c1*x21 + c1*x22 + c1*x23);
+    hu_jvp[1] = r[1]*u_dir[1] + x24 + x26;
+    hu_jvp[2] = r[2]*u_dir[2] + x0 + x1 + x25;
+    hu_jvp[3] = r[3]*u_dir[3] - x24 + x26;
+ 
+  }
+
+  ///
+  /// @brief Computes the stage cost L(t, x, u).
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @param[in] u Control input.
+  /// @return Evaluated value of the stage cost.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  /// Use the overloaded method if you call this outside of the cgmres solvers. 
+  ///
+  double eval_L(const double t, const double* x, const double* u) const {
+    return (1.0/2.0)*r[0]*pow(u[0] - u_ref[0], 2) + (1.0/2.0)*r[1]*pow(u[1] - u_ref[1], 2) + (1.0/2.0)*r[2]*pow(u[2] - u_ref[2], 2) + (1.0/2.0)*r[3]*pow(u[3] - u_ref[3], 2) + (1.0/2.0)*s[0]*pow(x[0] - x_ref[0], 2) + (1.0/2.0)*s[10]*pow(x[10] - x_ref[10], 2) + (1.0/2.0)*s[11]*pow(x[11] - x_ref[11], 2) + (1.0/2.0)*s[12]*pow(x[12] - x_ref[12], 2) + (1.0/2.0)*s[1]*pow(x[1] - x_ref[1], 2) + (1.0/2.0)*s[2]*pow(x[2] - x_ref[2], 2) + (1.0/2.0)*s[3]*pow(x[3] - x_ref[3], 2) + (1.0/2.0)*s[4]*pow(x[4] - x_ref[4], 2) + (1.0/2.0)*s[5]*pow(x[5] - x_ref[5], 2) + (1.0/2.0)*s[6]*pow(x[6] - x_ref[6], 2) + (1.0/2.0)*s[7]*pow(x[7] - x_ref[7], 2) + (1.0/2.0)*s[8]*pow(x[8] - x_ref[8], 2) + (1.0/2.0)*s[9]*pow(x[9] - x_ref[9], 2);
+ 
+  }
+
+  ///
+  /// @brief Computes the terminal cost phi(t, x).
+  /// @param[in] t Time.
+  /// @param[in] x State.
+  /// @return Evaluated value of the terminal cost.
+  /// @remark This method is intended to be used inside of the cgmres solvers and does not check size of each argument. 
+  /// Use the overloaded method if you call this outside of the cgmres solvers. 
+  ///
+  double eval_phi(const double t, const double* x) const {
+    return (1.0/2.0)*s_terminal[0]*pow(x[0] - x_ref[0], 2) + (1.0/2.0)*s_terminal[10]*pow(x[10] - x_ref[10], 2) + (1.0/2.0)*s_terminal[11]*pow(x[11] - x_ref[11], 2) + (1.0/2.0)*s_terminal[12]*pow(x[12] - x_ref[12], 2) + (1.0/2.0)*s_terminal[1]*pow(x[1] - x_ref[1], 2) + (1.0/2.0)*s_terminal[2]*pow(x[2] - x_ref[2], 2) + (1.0/2.0)*s_terminal[3]*pow(x[3] - x_ref[3], 2) + (1.0/2.0)*s_terminal[4]*pow(x[4] - x_ref[4], 2) + (1.0/2.0)*s_terminal[5]*pow(x[5] - x_ref[5], 2) + (1.0/2.0)*s_terminal[6]*pow(x[6] - x_ref[6], 2) + (1.0/2.0)*s_terminal[7]*pow(x[7] - x_ref[7], 2) + (1.0/2.0)*s_terminal[8]*pow(x[8] - x_ref[8], 2) + (1.0/2.0)*s_terminal[9]*pow(x[9] - x_ref[9], 2);
+ 
+  }
+
   ///
   /// @brief Computes the state equation dx = f(t, x, u).
   /// @param[in] t Time.
@@ -364,6 +799,99 @@ public:
     eval_hu(t, x.derived().data(), uc.derived().data(), lmd.derived().data(), CGMRES_EIGEN_CONST_CAST(VectorType4, hu).data());
   }
 
+  ///
+  /// @brief Computes the Hessian of the Hamiltonian with respect to control input and the equality constraints, 
+  /// i.e., huu = d^2H/du^2(t, x, u, lmd).
+  /// @param[in] t Time.
+  /// @param[in] x State. Size must be nx.
+  /// @param[in] uc Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. Size must be nuc. 
+  /// @param[in] lmd Costate. Size must be nx. 
+  /// @param[out] huu Evaluated value of the Hessian of the Hamiltonian. Size must be nuc x nuc.
+  ///
+  template <typename VectorType1, typename VectorType2, typename VectorType3, typename MatrixType>
+  void eval_huu(const double t, const MatrixBase<VectorType1>& x, 
+                const MatrixBase<VectorType2>& uc, 
+                const MatrixBase<VectorType3>& lmd, 
+                const MatrixBase<MatrixType>& huu) const {
+    static_assert(!MatrixType::IsRowMajor);
+    if (x.size() != nx) {
+      throw std::invalid_argument("[OCP]: x.size() must be " + std::to_string(nx));
+    }
+    if (uc.size() != nuc) {
+      throw std::invalid_argument("[OCP]: uc.size() must be " + std::to_string(nuc));
+    }
+    if (lmd.size() != nx) {
+      throw std::invalid_argument("[OCP]: lmd.size() must be " + std::to_string(nx));
+    }
+    if (huu.rows() != nuc || huu.cols() != nuc) {
+      throw std::invalid_argument("[OCP]: huu must be " + std::to_string(nuc) + "x" + std::to_string(nuc));
+    }
+    eval_huu(t, x.derived().data(), uc.derived().data(), lmd.derived().data(), CGMRES_EIGEN_CONST_CAST(MatrixType, huu).data());
+  }
+
+  ///
+  /// @brief Computes the Jacobian of hu with respect to the state, 
+  /// i.e., hux = d^2H/dudx(t, x, u, lmd).
+  /// @param[in] t Time.
+  /// @param[in] x State. Size must be nx.
+  /// @param[in] uc Concatenatin of the control input and Lagrange multiplier with respect to the equality constraints. Size must be nuc. 
+  /// @param[in] lmd Costate. Size must be nx. 
+  /// @param[out] hux Evaluated value of the Jacobian of hu. Size must be nuc x nx.
+  ///
+  template <typename VectorType1, typename VectorType2, typename VectorType3, typename MatrixType>
+  void eval_hux(const double t, const MatrixBase<VectorType1>& x, 
+                const MatrixBase<VectorType2>& uc, 
+                const MatrixBase<VectorType3>& lmd, 
+                const MatrixBase<MatrixType>& hux) const {
+    static_assert(!MatrixType::IsRowMajor);
+    if (x.size() != nx) {
+      throw std::invalid_argument("[OCP]: x.size() must be " + std::to_string(nx));
+    }
+    if (uc.size() != nuc) {
+      throw std::invalid_argument("[OCP]: uc.size() must be " + std::to_string(nuc));
+    }
+    if (lmd.size() != nx) {
+      throw std::invalid_argument("[OCP]: lmd.size() must be " + std::to_string(nx));
+    }
+    if (hux.rows() != nuc || hux.cols() != nx) {
+      throw std::invalid_argument("[OCP]: hux must be " + std::to_string(nuc) + "x" + std::to_string(nx));
+    }
+    eval_hux(t, x.derived().data(), uc.derived().data(), lmd.derived().data(), CGMRES_EIGEN_CONST_CAST(MatrixType, hux).data());
+  }
+
+  ///
+  /// @brief Computes the stage cost L(t, x, u).
+  /// @param[in] t Time.
+  /// @param[in] x State. Size must be nx.
+  /// @param[in] u Control input. Size must be nu.
+  /// @return Evaluated value of the stage cost.
+  ///
+  template <typename VectorType1, typename VectorType2>
+  double eval_L(const double t, const MatrixBase<VectorType1>& x, 
+                const MatrixBase<VectorType2>& u) const {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[OCP]: x.size() must be " + std::to_string(nx));
+    }
+    if (u.size() != nu) {
+      throw std::invalid_argument("[OCP]: u.size() must be " + std::to_string(nu));
+    }
+    return eval_L(t, x.derived().data(), u.derived().data());
+  }
+
+  ///
+  /// @brief Computes the terminal cost phi(t, x).
+  /// @param[in] t Time.
+  /// @param[in] x State. Size must be nx.
+  /// @return Evaluated value of the terminal cost.
+  ///
+  template <typename VectorType>
+  double eval_phi(const double t, const MatrixBase<VectorType>& x) const {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[OCP]: x.size() must be " + std::to_string(nx));
+    }
+    return eval_phi(t, x.derived().data());
+  }
+
 };
 
 } // namespace cgmres
@@ -6,3 +6,4 @@ from .ocp import *
 from .zero_horizon_ocp_solver import *
 from .single_shooting_cgmres_solver import *
 from .multiple_shooting_cgmres_solver import *
+from .riccati_newton_solver import *
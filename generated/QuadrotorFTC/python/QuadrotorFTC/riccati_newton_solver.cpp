@@ -0,0 +1,27 @@
+
+// This file was automatically generated by autogenu-jupyter (https://github.com/ohtsukalab/autogenu-jupyter). 
+// The autogenu-jupyter copyright holders make no ownership claim of its contents. 
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
+
+#include "cgmres/riccati_newton_solver.hpp"
+#include "cgmres/python/riccati_newton_solver.hpp"
+#include "ocp.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace cgmres {
+namespace python {
+
+namespace py = pybind11;
+
+constexpr int N = 100;
+DEFINE_PYBIND11_MODULE_RICCATI_NEWTON_SOLVER(OCP_QuadrotorFTC, N)
+
+
+} // namespace python
+} // namespace cgmres
@@ -0,0 +1,271 @@
+#ifndef CGMRES__ASYNC_CGMRES_SOLVER_HPP_
+#define CGMRES__ASYNC_CGMRES_SOLVER_HPP_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "cgmres/types.hpp"
+
+#include "cgmres/detail/spsc_queue.hpp"
+#include "cgmres/detail/triple_buffer.hpp"
+
+namespace cgmres {
+
+///
+/// @class AsyncCGMRESSolver
+/// @brief Runs a C/GMRES solver on a dedicated thread. The state samples are
+/// passed to the solver thread through a lock-free queue and the solutions are
+/// published through a triple buffer, so that the control (actuator) thread
+/// reads the latest consistent solution without waiting for the solver and
+/// without mutexes. If several samples are queued, the solver thread skips to
+/// the newest one. The solver thread sleeps while the queue is empty. If an update 
+/// throws, the solver thread stops and the exception is rethrown by the next 
+/// latest() or stop().
+/// @tparam MPCSolver MultipleShootingCGMRESSolver or SingleShootingCGMRESSolver.
+/// @tparam QueueCapacity Capacity of the state sample queue. Must be a power of two. Default is 16.
+/// @remark push() must be called from a single thread, and latest() must be called
+/// from a single (possibly another) thread.
+///
+template <class MPCSolver, int QueueCapacity=16>
+class AsyncCGMRESSolver {
+public:
+  ///
+  /// @brief Dimension of the state.
+  ///
+  static constexpr int nx = MPCSolver::nx;
+
+  ///
+  /// @brief Dimension of the control input.
+  ///
+  static constexpr int nu = MPCSolver::nu;
+
+  using UoptArray = std::decay_t<decltype(std::declval<const MPCSolver&>().uopt())>;
+  using XoptArray = std::decay_t<decltype(std::declval<const MPCSolver&>().xopt())>;
+
+  ///
+  /// @struct StateSample
+  /// @brief Timestamped state.
+  ///
+  struct StateSample {
+    Scalar t;
+    Vector<nx> x;
+  };
+
+  ///
+  /// @struct Solution
+  /// @brief Solution published by the solver thread.
+  ///
+  struct Solution {
+    ///
+    /// @brief Number of the updates performed before this solution is published.
+    /// The initial solution has 0.
+    ///
+    unsigned long sequence;
+
+    ///
+    /// @brief Time of the state sample that this solution is computed from.
+    /// NaN for the initial solution.
+    ///
+    Scalar t;
+
+    ///
+    /// @brief The l2-norm of the optimality errors evaluated in the update.
+    ///
+    Scalar opt_error;
+
+    UoptArray uopt;
+    XoptArray xopt;
+  };
+
+  ///
+  /// @brief Starts the solver thread.
+  /// @param[in] mpc Initialized MPC solver. It is copied into this object.
+  /// @param[in] cpu CPU that the solver thread is pinned to. Negative value
+  /// leaves the thread unpinned. Default is -1. Pinning is supported only on Linux.
+  ///
+  explicit AsyncCGMRESSolver(const MPCSolver& mpc, const int cpu=-1)
+    : mpc_(mpc),
+      buffer_(),
+      stop_(false),
+      sleeping_(false),
+      failed_(false),
+      num_updates_(0) {
+    auto& solution = buffer_.back();
+    solution.sequence = 0;
+    solution.t = std::numeric_limits<Scalar>::quiet_NaN();
+    solution.opt_error = mpc_.optError();
+    solution.uopt = mpc_.uopt();
+    solution.xopt = mpc_.xopt();
+    buffer_.publish();
+    thread_ = std::thread([this]() { solverLoop(); });
+    if (cpu >= 0) {
+      if (!pin(cpu)) {
+        stop();
+        throw std::invalid_argument("[AsyncCGMRESSolver]: failed to pin the solver thread to cpu " + std::to_string(cpu));
+      }
+    }
+  }
+
+  AsyncCGMRESSolver(const AsyncCGMRESSolver&) = delete;
+
+  AsyncCGMRESSolver& operator=(const AsyncCGMRESSolver&) = delete;
+
+  ///
+  /// @brief Stops the solver thread.
+  ///
+  ~AsyncCGMRESSolver() {
+    join();
+  }
+
+  ///
+  /// @brief Passes a state sample to the solver thread. Does not wait for the solver: 
+  /// a mutex is taken briefly only to wake up the sleeping solver thread.
+  /// @param[in] t Time of the state sample.
+  /// @param[in] x State. Size must be AsyncCGMRESSolver::nx.
+  /// @return false if the queue is full. Then the sample is discarded.
+  ///
+  template <typename VectorType>
+  bool push(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[AsyncCGMRESSolver::push] x.size() must be " + std::to_string(nx));
+    }
+    StateSample sample;
+    sample.t = t;
+    sample.x = x;
+    if (!queue_.push(sample)) return false;
+    // Pairs with the fence in solverLoop(): either the solver thread sees the 
+    // sample or this thread sees that the solver thread is sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+      wake();
+    }
+    return true;
+  }
+
+  ///
+  /// @brief Gets the latest published solution. Does not block.
+  /// @return const reference to the solution. It remains valid and unchanged
+  /// until the next call of this method.
+  /// @remark Rethrows the exception thrown by an update on the solver thread, if any.
+  ///
+  const Solution& latest() {
+    rethrowIfFailed();
+    buffer_.update();
+    return buffer_.front();
+  }
+
+  ///
+  /// @brief Stops the solver thread. The queued samples are discarded.
+  /// @remark Rethrows the exception thrown by an update on the solver thread 
+  /// if it has not been rethrown by latest().
+  ///
+  void stop() {
+    join();
+    rethrowIfFailed();
+  }
+
+  ///
+  /// @brief Number of the updates performed by the solver thread.
+  ///
+  unsigned long num_updates() const { return num_updates_.load(std::memory_order_acquire); }
+
+  ///
+  /// @brief Gets the wrapped solver. Must not be called while the solver thread is running.
+  ///
+  const MPCSolver& solver() const { return mpc_; }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  MPCSolver mpc_;
+  detail::SPSCQueue<StateSample, QueueCapacity> queue_;
+  detail::TripleBuffer<Solution> buffer_;
+  std::thread thread_;
+  std::atomic<bool> stop_, sleeping_, failed_;
+  std::atomic<unsigned long> num_updates_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::exception_ptr exception_;
+
+  void wake() {
+    // Waits until the solver thread is blocked in cv_ or has seen the new state.
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_one();
+  }
+
+  void join() {
+    stop_.store(true, std::memory_order_seq_cst);
+    if (thread_.joinable()) {
+      wake();
+      thread_.join();
+    }
+  }
+
+  void rethrowIfFailed() {
+    if (failed_.load(std::memory_order_acquire) && failed_.exchange(false, std::memory_order_acq_rel)) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+  bool pin(const int cpu) {
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(thread_.native_handle(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+    return true;
+#endif
+  }
+
+  void solverLoop() {
+    StateSample sample;
+    unsigned long sequence = 0;
+    while (!stop_.load(std::memory_order_acquire)) {
+      if (!queue_.pop_latest(sample)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cv_.wait(lock, [this]() {
+          return !queue_.empty() || stop_.load(std::memory_order_acquire);
+        });
+        sleeping_.store(false, std::memory_order_relaxed);
+        continue;
+      }
+      try {
+        mpc_.update(sample.t, sample.x);
+      }
+      catch (...) {
+        exception_ = std::current_exception();
+        failed_.store(true, std::memory_order_release);
+        return;
+      }
+      auto& solution = buffer_.back();
+      solution.sequence = ++sequence;
+      solution.t = sample.t;
+      solution.opt_error = mpc_.optError();
+      solution.uopt = mpc_.uopt();
+      solution.xopt = mpc_.xopt();
+      buffer_.publish();
+      num_updates_.fetch_add(1, std::memory_order_release);
+    }
+  }
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__ASYNC_CGMRES_SOLVER_HPP_
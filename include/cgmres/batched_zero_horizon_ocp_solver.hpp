@@ -0,0 +1,383 @@
+#ifndef CGMRES__BATCHED_ZERO_HORIZON_OCP_SOLVER_HPP_
+#define CGMRES__BATCHED_ZERO_HORIZON_OCP_SOLVER_HPP_
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+
+#include "cgmres/types.hpp"
+#include "cgmres/solver_settings.hpp"
+#include "cgmres/timer.hpp"
+
+#include "cgmres/detail/matrixfree_gmres.hpp"
+#include "cgmres/detail/zero_horizon_nlp.hpp"
+#include "cgmres/detail/newton_gmres.hpp"
+#include "cgmres/detail/thread_pool.hpp"
+
+namespace cgmres {
+
+///
+/// @class BatchedZeroHorizonOCPSolver
+/// @brief Solves the zero-horizon OCP for a batch of states in one call, e.g.,
+/// to precompute the initial guesses over an envelope of initial conditions or
+/// for Monte-Carlo initialization. The batch is stored in structure-of-arrays
+/// form, i.e., each column of the matrices is a lane (an instance). The Newton-GMRES
+/// iterations are swept over the lanes and each lane is retired from the sweep
+/// as soon as it converges. The lanes are split into contiguous chunks solved in parallel.
+/// @tparam OCP A definition of the optimal control problem (OCP).
+/// @tparam kmax Maximum number of the GMRES iterations. Must be positive.
+///
+template <class OCP, int kmax>
+class BatchedZeroHorizonOCPSolver {
+public:
+  ///
+  /// @brief Dimension of the state.
+  ///
+  static constexpr int nx = OCP::nx;
+
+  ///
+  /// @brief Dimension of the control input.
+  ///
+  static constexpr int nu = OCP::nu;
+
+  ///
+  /// @brief Dimension of the equality constraints.
+  ///
+  static constexpr int nc = OCP::nc;
+
+  ///
+  /// @brief Dimension of the concatenation of the control input and equality constraints.
+  ///
+  static constexpr int nuc = nu + nc;
+
+  ///
+  /// @brief Dimension of the bound constraints on the control input.
+  ///
+  static constexpr int nub = OCP::nub;
+
+  ///
+  /// @brief Dimension of the linear problem solved by the GMRES solver.
+  ///
+  static constexpr int dim = nuc + 2 * nub;
+
+  using ZeroHorizonNLP_ = detail::ZeroHorizonNLP<OCP>;
+  using NewtonGMRES_ = detail::NewtonGMRES<ZeroHorizonNLP_>;
+  using MatrixFreeGMRES_ = detail::MatrixFreeGMRES<NewtonGMRES_, kmax>;
+
+  ///
+  /// @brief Constructs the batched zero-horizon OCP solver.
+  /// @param[in] ocp A definition of the optimal control problem (OCP).
+  /// @param[in] settings Solver settings.
+  /// @param[in] batch_size Number of the lanes. Must be positive.
+  /// @param[in] num_threads Number of threads. Default is 1.
+  ///
+  BatchedZeroHorizonOCPSolver(const OCP& ocp, const SolverSettings& settings,
+                              const int batch_size, const int num_threads=1)
+    : workers_(),
+      thread_pool_(),
+      settings_(settings),
+      batch_size_(batch_size),
+      uopt_(MatrixX::Zero(nu, std::max(batch_size, 0))),
+      ucopt_(MatrixX::Zero(nuc, std::max(batch_size, 0))),
+      dummyopt_(MatrixX::Zero(nub, std::max(batch_size, 0))),
+      muopt_(MatrixX::Zero(nub, std::max(batch_size, 0))),
+      lmdopt_(MatrixX::Zero(nx, std::max(batch_size, 0))),
+      solution_(MatrixX::Zero(dim, std::max(batch_size, 0))),
+      solution_update_(MatrixX::Zero(dim, std::max(batch_size, 0))),
+      opt_error_(VectorX::Zero(std::max(batch_size, 0))),
+      num_iter_(VectorXi::Zero(std::max(batch_size, 0))),
+      converged_(Eigen::Matrix<bool, Eigen::Dynamic, 1>::Constant(std::max(batch_size, 0), false)) {
+    if (batch_size <= 0) {
+      throw std::invalid_argument("[BatchedZeroHorizonOCPSolver]: 'batch_size' must be positive!");
+    }
+    if (num_threads <= 0) {
+      throw std::invalid_argument("[BatchedZeroHorizonOCPSolver]: 'num_threads' must be positive!");
+    }
+    const int num_chunks = std::min(num_threads, batch_size);
+    workers_.reserve(num_chunks);
+    for (int i=0; i<num_chunks; ++i) {
+      workers_.emplace_back(NewtonGMRES_(ZeroHorizonNLP_(ocp), settings.finite_difference_epsilon));
+    }
+    thread_pool_ = std::make_unique<detail::ThreadPool>(num_chunks);
+  }
+
+  BatchedZeroHorizonOCPSolver(const BatchedZeroHorizonOCPSolver&) = delete;
+
+  BatchedZeroHorizonOCPSolver& operator=(const BatchedZeroHorizonOCPSolver&) = delete;
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~BatchedZeroHorizonOCPSolver() = default;
+
+  ///
+  /// @brief Gets the number of the lanes.
+  /// @return The number of the lanes.
+  ///
+  int batch_size() const { return batch_size_; }
+
+  ///
+  /// @brief Sets the control input vector of all the lanes.
+  /// @param[in] u The control input vector. Size must be BatchedZeroHorizonOCPSolver::nu.
+  ///
+  template <typename VectorType>
+  void set_u(const MatrixBase<VectorType>& u) {
+    if (u.size() != nu) {
+      throw std::invalid_argument("[BatchedZeroHorizonOCPSolver::set_u] u.size() must be " + std::to_string(nu));
+    }
+    solution_.topRows(nu).colwise() = u.derived();
+    retrieveSolution();
+  }
+
+  ///
+  /// @brief Sets the control input vector and Lagrange multiplier with respect to the equality constraints of all the lanes.
+  /// @param[in] uc Concatenatin of the control input vector and Lagrange multiplier with respect to the equality constraints.
+  /// Size must be BatchedZeroHorizonOCPSolver::nuc.
+  ///
+  template <typename VectorType>
+  void set_uc(const MatrixBase<VectorType>& uc) {
+    if (uc.size() != nuc) {
+      throw std::invalid_argument("[BatchedZeroHorizonOCPSolver::set_uc] uc.size() must be " + std::to_string(nuc));
+    }
+    solution_.topRows(nuc).colwise() = uc.derived();
+    retrieveSolution();
+  }
+
+  ///
+  /// @brief Sets the control input vectors and Lagrange multipliers with respect to the equality constraints lane by lane.
+  /// @param[in] uc_batch Concatenations of the control input vector and Lagrange multiplier with respect to the equality constraints.
+  /// Size must be BatchedZeroHorizonOCPSolver::nuc x batch_size().
+  ///
+  template <typename MatrixType>
+  void set_uc_batch(const MatrixBase<MatrixType>& uc_batch) {
+    if (uc_batch.rows() != nuc || uc_batch.cols() != batch_size_) {
+      throw std::invalid_argument("[BatchedZeroHorizonOCPSolver::set_uc_batch] uc_batch must be "
+                                  + std::to_string(nuc) + " x " + std::to_string(batch_size_));
+    }
+    solution_.topRows(nuc) = uc_batch;
+    retrieveSolution();
+  }
+
+  ///
+  /// @brief Sets the dummy input vector with respect to the control input bounds constraint of all the lanes.
+  /// @param[in] dummy The dummy input vector. Size must be BatchedZeroHorizonOCPSolver::nub.
+  ///
+  template <typename VectorType>
+  void set_dummy(const MatrixBase<VectorType>& dummy) {
+    if (dummy.size() != nub) {
+      throw std::invalid_argument("[BatchedZeroHorizonOCPSolver::set_dummy] dummy.size() must be " + std::to_string(nub));
+    }
+    if constexpr (nub > 0) {
+      solution_.middleRows(nuc, nub).colwise() = dummy.derived();
+      retrieveSolution();
+    }
+  }
+
+  ///
+  /// @brief Sets the Lagrange multiplier with respect to the control input bounds constraint of all the lanes.
+  /// @param[in] mu The Lagrange multiplier. Size must be BatchedZeroHorizonOCPSolver::nub.
+  ///
+  template <typename VectorType>
+  void set_mu(const MatrixBase<VectorType>& mu) {
+    if (mu.size() != nub) {
+      throw std::invalid_argument("[BatchedZeroHorizonOCPSolver::set_mu] mu.size() must be " + std::to_string(nub));
+    }
+    if constexpr (nub > 0) {
+      solution_.middleRows(nuc+nub, nub).colwise() = mu.derived();
+      retrieveSolution();
+    }
+  }
+
+  ///
+  /// @brief Getter of the optimal solutions.
+  /// @return const reference to the optimal control input vectors. Size is BatchedZeroHorizonOCPSolver::nu x batch_size().
+  ///
+  const MatrixX& uopt() const { return uopt_; }
+
+  ///
+  /// @brief Getter of the optimal solutions.
+  /// @return const reference to the optimal concatenatins of the control input vector and Lagrange multiplier
+  /// with respect to the equality constraints. Size is BatchedZeroHorizonOCPSolver::nuc x batch_size().
+  ///
+  const MatrixX& ucopt() const { return ucopt_; }
+
+  ///
+  /// @brief Getter of the optimal solutions.
+  /// @return const reference to the optimal dummy input vectors. Size is BatchedZeroHorizonOCPSolver::nub x batch_size().
+  ///
+  const MatrixX& dummyopt() const { return dummyopt_; }
+
+  ///
+  /// @brief Getter of the optimal solutions.
+  /// @return const reference to the Lagrange multipliers with respect to the control input bounds constraint.
+  /// Size is BatchedZeroHorizonOCPSolver::nub x batch_size().
+  ///
+  const MatrixX& muopt() const { return muopt_; }
+
+  ///
+  /// @brief Getter of the optimal solutions.
+  /// @return const reference to the optimal costate vectors. Size is BatchedZeroHorizonOCPSolver::nx x batch_size().
+  ///
+  const MatrixX& lmdopt() const { return lmdopt_; }
+
+  ///
+  /// @brief Gets the l2-norms of the optimality errors of the lanes evaluated in the last iterations.
+  /// @return const reference to the l2-norms. Size is batch_size().
+  ///
+  const VectorX& optError() const { return opt_error_; }
+
+  ///
+  /// @brief Gets the numbers of the Newton iterations performed by the lanes in the last solve().
+  /// @return const reference to the numbers of the iterations. Size is batch_size().
+  ///
+  const VectorXi& num_iter() const { return num_iter_; }
+
+  ///
+  /// @brief Gets the convergence mask of the last solve().
+  /// @return const reference to the mask. true if the lane converges. Size is batch_size().
+  ///
+  const Eigen::Matrix<bool, Eigen::Dynamic, 1>& converged() const { return converged_; }
+
+  ///
+  /// @brief Gets the number of the converged lanes in the last solve().
+  /// @return The number of the converged lanes.
+  ///
+  int num_converged() const { return converged_.count(); }
+
+  ///
+  /// @brief Solves the zero-horizon optimal control problems of all the lanes by Newton-GMRES method.
+  /// The current solutions are used as the initial guesses.
+  /// @param[in] t Time.
+  /// @param[in] x States of the lanes. Size must be BatchedZeroHorizonOCPSolver::nx x batch_size().
+  ///
+  template <typename MatrixType>
+  void solve(const Scalar t, const MatrixBase<MatrixType>& x) {
+    if (x.rows() != nx || x.cols() != batch_size_) {
+      throw std::invalid_argument("[BatchedZeroHorizonOCPSolver::solve] x must be "
+                                  + std::to_string(nx) + " x " + std::to_string(batch_size_));
+    }
+    if (settings_.verbose_level >= 1) {
+      std::cout << "\n=================== solve batched zero horizon OCP ===================" << std::endl;
+    }
+
+    if (settings_.profile_solver) timer_.tick();
+    const int num_chunks = workers_.size();
+    thread_pool_->parallel_for(num_chunks, [&](const int c) {
+      const int begin = (batch_size_ * c) / num_chunks;
+      const int end = (batch_size_ * (c+1)) / num_chunks;
+      solveChunk(workers_[c], t, x.derived(), begin, end);
+    });
+    retrieveSolution();
+    if (settings_.profile_solver) timer_.tock();
+
+    // verbose
+    if (settings_.verbose_level >= 1) {
+      std::cout << "converged lanes: " << num_converged() << " / " << batch_size_
+                << " (opt tol: " << settings_.opterr_tol << ")" << std::endl;
+    }
+    if (settings_.verbose_level >= 2) {
+      std::cout << "max opt error: " << opt_error_.maxCoeff() << std::endl;
+      std::cout << "max number of Newton iter: " << num_iter_.maxCoeff()
+                << " (max iter: " << settings_.max_iter << ")" << std::endl;
+    }
+  }
+
+  ///
+  /// @brief Get timing result as TimingProfile. Each count is a call of solve().
+  /// @return Timing profile.
+  ///
+  TimingProfile getProfile() const {
+    return timer_.getProfile();
+  }
+
+  void disp(std::ostream& os) const {
+    os << "Batched zero horizon OCP solver: " << std::endl;
+    os << "  kmax:       " << kmax << std::endl;
+    os << "  batch size: " << batch_size_ << std::endl;
+    os << "  number of threads: " << thread_pool_->num_threads() << std::endl;
+    os << workers_.front().newton_gmres.get_nlp().ocp() << std::endl;
+    os << settings_ << std::endl;
+    os << timer_.getProfile() << std::flush;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const BatchedZeroHorizonOCPSolver& solver) {
+    solver.disp(os);
+    return os;
+  }
+
+private:
+  // Workspace of a chunk of the lanes.
+  struct Worker {
+    explicit Worker(const NewtonGMRES_& newton_gmres)
+      : newton_gmres(newton_gmres),
+        gmres(),
+        solution(Vector<dim>::Zero()),
+        solution_update(Vector<dim>::Zero()) {}
+
+    NewtonGMRES_ newton_gmres;
+    MatrixFreeGMRES_ gmres;
+    Vector<dim> solution, solution_update;
+    Vector<nx> x;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  std::vector<Worker> workers_;
+  std::unique_ptr<detail::ThreadPool> thread_pool_;
+  SolverSettings settings_;
+  Timer timer_;
+  int batch_size_;
+
+  MatrixX uopt_, ucopt_, dummyopt_, muopt_, lmdopt_;
+  MatrixX solution_, solution_update_;
+  VectorX opt_error_;
+  VectorXi num_iter_;
+  Eigen::Matrix<bool, Eigen::Dynamic, 1> converged_;
+
+  template <typename MatrixType>
+  void solveChunk(Worker& worker, const Scalar t, const MatrixType& x,
+                  const int begin, const int end) {
+    worker.newton_gmres.synchronize_ocp();
+    for (int i=begin; i<end; ++i) {
+      num_iter_.coeffRef(i) = 0;
+      converged_.coeffRef(i) = false;
+    }
+    // Sweeps one Newton iteration over the lanes that have not converged yet.
+    int num_active = end - begin;
+    for (size_t iter=0; iter<settings_.max_iter && num_active>0; ++iter) {
+      for (int i=begin; i<end; ++i) {
+        if (converged_.coeff(i)) continue;
+        worker.x = x.col(i);
+        worker.solution = solution_.col(i);
+        worker.solution_update = solution_update_.col(i);
+        worker.gmres.template solve<const Scalar, const Vector<nx>&, const Vector<dim>&>(
+            worker.newton_gmres, t, worker.x, worker.solution, worker.solution_update);
+        worker.solution.noalias() += worker.solution_update;
+        solution_.col(i) = worker.solution;
+        solution_update_.col(i) = worker.solution_update;
+        lmdopt_.col(i) = worker.newton_gmres.lmd();
+        opt_error_.coeffRef(i) = worker.newton_gmres.optError();
+        ++num_iter_.coeffRef(i);
+        if (opt_error_.coeff(i) < settings_.opterr_tol) {
+          converged_.coeffRef(i) = true;
+          --num_active;
+        }
+      }
+    }
+  }
+
+  void retrieveSolution() {
+    uopt_ = solution_.topRows(nu);
+    ucopt_ = solution_.topRows(nuc);
+    dummyopt_ = solution_.middleRows(nuc, nub);
+    muopt_ = solution_.middleRows(nuc+nub, nub);
+  }
+
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__BATCHED_ZERO_HORIZON_OCP_SOLVER_HPP_
@@ -0,0 +1,289 @@
+#ifndef CGMRES__BROYDEN_JACOBIAN_HPP_
+#define CGMRES__BROYDEN_JACOBIAN_HPP_
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "cgmres/types.hpp"
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Quasi-Newton solver of the linear problem of the continuation that reuses
+/// the Jacobian over the updates. The Jacobian is assembled column by column from
+/// LinearProblem::eval_Ax() along the unit vectors and LU-factorized with partial
+/// pivoting. Both are spread over the updates by assemble(), which proceeds column
+/// by column and pivot by pivot within its time limit, so that no single update pays
+/// for the whole assembly. A new assembly starts every refresh_period solves and the
+/// previous factors are used until it is complete. In between, the inverse Jacobian
+/// is corrected by Broyden's rank-one updates with the exact directional derivative
+/// along each step, which are kept as the low-rank terms on top of the LU factors.
+/// A step is accepted only if its relative residual is below tol. The interface of
+/// solve() is the same as MatrixFreeGMRES::solve().
+///
+template <typename LinearProblem>
+class BroydenJacobian {
+public:
+  static constexpr int dim = LinearProblem::dim;
+
+  using Clock = std::chrono::steady_clock;
+
+  BroydenJacobian(const size_t refresh_period, const Scalar tol)
+    : lu_(MatrixX::Zero(dim, dim)),
+      next_lu_(MatrixX::Zero(dim, dim)),
+      pivots_(Eigen::VectorXi::Zero(dim)),
+      next_pivots_(Eigen::VectorXi::Zero(dim)),
+      broyden_a_(MatrixX::Zero(dim, refresh_period)),
+      broyden_b_(MatrixX::Zero(dim, refresh_period)),
+      b_vec_(Vector<dim>::Zero()),
+      ax_vec_(Vector<dim>::Zero()),
+      step_(Vector<dim>::Zero()),
+      hy_vec_(Vector<dim>::Zero()),
+      sh_vec_(Vector<dim>::Zero()),
+      unit_vec_(Vector<dim>::Zero()),
+      refresh_period_(refresh_period),
+      tol_(tol) {
+  }
+
+  BroydenJacobian() = default;
+
+  ~BroydenJacobian() = default;
+
+  ///
+  /// @brief Solves the linear problem by the quasi-Newton step.
+  /// @return true if the step is accepted and added to linear_problem_solution.
+  /// false if no factorization is available or the residual test fails:
+  /// linear_problem_solution is then unchanged and the factors are not used
+  /// until the next assembly is complete.
+  ///
+  template <typename... LinearProblemArgs>
+  bool solve(LinearProblem& linear_problem,
+             LinearProblemArgs... linear_problem_args,
+             Vector<dim>& linear_problem_solution) {
+    refreshed_ = fresh_;
+    fresh_ = false;
+    if (!valid_) return false;
+    if (solves_since_refresh_ >= refresh_period_) {
+      startAssembly();
+    }
+    linear_problem.eval_b(linear_problem_args..., linear_problem_solution, b_vec_);
+    const Scalar b_norm = b_vec_.template lpNorm<2>();
+    if (!std::isfinite(b_norm)) {
+      invalidate();
+      return false;
+    }
+    ++solves_since_refresh_;
+    applyInverse(b_vec_, step_);
+    linear_problem.eval_Ax(linear_problem_args..., step_, ax_vec_);
+    residual_ = (b_norm > 0.0) ? (ax_vec_ - b_vec_).template lpNorm<2>() / b_norm : 0.0;
+    if (!(residual_ <= tol_)) {
+      valid_ = false;
+      ++num_fallbacks_;
+      startAssembly();
+      return false;
+    }
+    broydenUpdate();
+    linear_problem_solution.noalias() += step_;
+    return true;
+  }
+
+  ///
+  /// @brief Continues the assembly and factorization of the Jacobian, if any,
+  /// within the time limit. The operator is evaluated at the base point set by the
+  /// last LinearProblem::eval_b(), i.e., that of the last solve of the linear problem.
+  /// A column or pivot is processed only if it is expected to end before the time 
+  /// limit and the deadline, i.e., if the previous one would. The first one is 
+  /// processed regardless of the time limit so that the assembly always proceeds 
+  /// unless the deadline does not allow it.
+  /// @param[in] until Time limit of the assembly.
+  /// @param[in] deadline Deadline of the assembly. 
+  ///
+  template <typename... LinearProblemArgs>
+  void assemble(const Clock::time_point& until, const Clock::time_point& deadline,
+                LinearProblem& linear_problem,
+                LinearProblemArgs... linear_problem_args) {
+    if (!assembling_) return;
+    auto now = Clock::now();
+    bool progress = false;
+    const auto fits = [&](const Clock::duration& time) {
+      return (now + time < deadline) && (now + time < until || !progress);
+    };
+    while (column_ < dim && fits(column_time_)) {
+      unit_vec_.coeffRef(column_) = 1.0;
+      linear_problem.eval_Ax(linear_problem_args..., unit_vec_, ax_vec_);
+      unit_vec_.coeffRef(column_) = 0.0;
+      next_lu_.col(column_) = ax_vec_;
+      // The variables that the problem does not depend on, e.g., those of the
+      // inactive grids, are kept unchanged by the step.
+      if (ax_vec_.template lpNorm<Eigen::Infinity>() == 0.0) {
+        next_lu_.coeffRef(column_, column_) = 1.0;
+      }
+      ++column_;
+      const auto prev = now;
+      now = Clock::now();
+      column_time_ = now - prev;
+      progress = true;
+    }
+    // The time of a pivot decreases as the factorization proceeds.
+    while (column_ == dim && pivot_ < dim && fits(pivot_time_)) {
+      if (!eliminate()) {
+        ++num_fallbacks_;
+        restartAssembly();
+        return;
+      }
+      const auto prev = now;
+      now = Clock::now();
+      pivot_time_ = now - prev;
+      progress = true;
+    }
+    if (pivot_ == dim) {
+      finishAssembly();
+    }
+  }
+
+  ///
+  /// @brief Discards the factors and restarts the assembly, e.g., after the solution
+  /// or the linear problem is replaced.
+  ///
+  void invalidate() {
+    valid_ = false;
+    restartAssembly();
+  }
+
+  ///
+  /// @brief Returns true if the factors used by the last solve() were completed
+  /// after the previous solve().
+  ///
+  bool refreshed() const { return refreshed_; }
+
+  ///
+  /// @brief Relative residual of the step of the last solve().
+  ///
+  Scalar residual() const { return residual_; }
+
+  std::size_t num_refreshes() const { return num_refreshes_; }
+
+  std::size_t num_fallbacks() const { return num_fallbacks_; }
+
+private:
+  // LU factors of the Jacobian in use and of the Jacobian being assembled, stored
+  // in place with the row interchanges pivots_ as in LAPACK's getrf.
+  MatrixX lu_, next_lu_;
+  Eigen::VectorXi pivots_, next_pivots_;
+  // The inverse Jacobian is lu_^{-1} + broyden_a_ * broyden_b_^T over the first
+  // num_broyden_ columns.
+  MatrixX broyden_a_, broyden_b_;
+  int num_broyden_ = 0;
+  Vector<dim> b_vec_, ax_vec_, step_, hy_vec_, sh_vec_, unit_vec_;
+  size_t refresh_period_ = 1;
+  Scalar tol_ = 0.0;
+  bool valid_ = false;
+  bool refreshed_ = false;
+  bool fresh_ = false;
+  bool assembling_ = true;
+  int column_ = 0;
+  int pivot_ = 0;
+  Clock::duration column_time_ = Clock::duration::zero();
+  Clock::duration pivot_time_ = Clock::duration::zero();
+  size_t solves_since_refresh_ = 0;
+  Scalar residual_ = std::numeric_limits<Scalar>::quiet_NaN();
+  std::size_t num_refreshes_ = 0;
+  std::size_t num_fallbacks_ = 0;
+
+  // Starts a new assembly unless one is in progress.
+  void startAssembly() {
+    if (!assembling_) {
+      restartAssembly();
+    }
+  }
+
+  void restartAssembly() {
+    assembling_ = true;
+    column_ = 0;
+    pivot_ = 0;
+    pivot_time_ = Clock::duration::zero();
+  }
+
+  // One step of the right-looking LU factorization with partial pivoting.
+  bool eliminate() {
+    const int k = pivot_;
+    const int m = dim - k - 1;
+    Eigen::Index p;
+    const Scalar max_abs = next_lu_.col(k).tail(dim-k).cwiseAbs().maxCoeff(&p);
+    if (!(max_abs > 0.0) || !std::isfinite(max_abs)) return false;
+    p += k;
+    next_pivots_.coeffRef(k) = static_cast<int>(p);
+    if (p != k) {
+      next_lu_.row(k).swap(next_lu_.row(p));
+    }
+    next_lu_.col(k).tail(m) /= next_lu_.coeff(k, k);
+    next_lu_.bottomRightCorner(m, m).noalias() -= next_lu_.col(k).tail(m) * next_lu_.row(k).tail(m);
+    ++pivot_;
+    return true;
+  }
+
+  void finishAssembly() {
+    assembling_ = false;
+    if (!next_lu_.allFinite()) {
+      ++num_fallbacks_;
+      restartAssembly();
+      return;
+    }
+    std::swap(lu_, next_lu_);
+    std::swap(pivots_, next_pivots_);
+    valid_ = true;
+    fresh_ = true;
+    num_broyden_ = 0;
+    solves_since_refresh_ = 0;
+    ++num_refreshes_;
+  }
+
+  // out = H rhs.
+  void applyInverse(const Vector<dim>& rhs, Vector<dim>& out) const {
+    out = rhs;
+    for (int k=0; k<dim; ++k) {
+      std::swap(out.coeffRef(k), out.coeffRef(pivots_.coeff(k)));
+    }
+    lu_.template triangularView<Eigen::UnitLower>().solveInPlace(out);
+    lu_.template triangularView<Eigen::Upper>().solveInPlace(out);
+    for (int j=0; j<num_broyden_; ++j) {
+      out.noalias() += broyden_b_.col(j).dot(rhs) * broyden_a_.col(j);
+    }
+  }
+
+  // out = H^T rhs.
+  void applyInverseTranspose(const Vector<dim>& rhs, Vector<dim>& out) const {
+    out = rhs;
+    lu_.transpose().template triangularView<Eigen::Lower>().solveInPlace(out);
+    lu_.transpose().template triangularView<Eigen::UnitUpper>().solveInPlace(out);
+    for (int k=dim-1; k>=0; --k) {
+      std::swap(out.coeffRef(k), out.coeffRef(pivots_.coeff(k)));
+    }
+    for (int j=0; j<num_broyden_; ++j) {
+      out.noalias() += broyden_a_.col(j).dot(rhs) * broyden_b_.col(j);
+    }
+  }
+
+  // Good Broyden's update of the inverse Jacobian H by the secant pair (s, y) with
+  // s = step_ and y = ax_vec_, i.e., H += (s - H y) s^T H / (s^T H y).
+  void broydenUpdate() {
+    if (num_broyden_ >= broyden_a_.cols()) return;
+    applyInverse(ax_vec_, hy_vec_);
+    const Scalar denom = step_.dot(hy_vec_);
+    if (!(std::abs(denom) > std::numeric_limits<Scalar>::epsilon() * step_.squaredNorm())) return;
+    applyInverseTranspose(step_, sh_vec_);
+    broyden_a_.col(num_broyden_) = (step_ - hy_vec_) / denom;
+    broyden_b_.col(num_broyden_) = sh_vec_;
+    ++num_broyden_;
+  }
+
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__BROYDEN_JACOBIAN_HPP_
@@ -20,10 +20,11 @@ public:
   static constexpr int dim = NLP::dim;
 
   ContinuationGMRES(const NLP& nlp, const Scalar finite_difference_epsilon, 
-                    const Scalar zeta) 
+                    const Scalar zeta, const bool use_jvp=false) 
     : nlp_(nlp), 
       finite_difference_epsilon_(finite_difference_epsilon),
       zeta_(zeta),
+      use_jvp_(use_jvp),
       updated_solution_(Vector<dim>::Zero()), 
       fonc_(Vector<dim>::Zero()), 
       fonc_1_(Vector<dim>::Zero()),
@@ -67,6 +68,15 @@ public:
 
     nlp_.eval_fonc_hu(t, x, solution, fonc_);
     nlp_.eval_fonc_hu(t1, x_1_, solution, fonc_1_);
+    if constexpr (NLP::has_jvp) {
+      if (use_jvp_) {
+        // The trajectories of the last eval_fonc_hu() are the base point of eval_Ax().
+        nlp_.eval_fonc_hu_jvp(t1, x_1_, solution, solution_update, fonc_2_);
+        CGMRES_EIGEN_CONST_CAST(VectorType4, b_vec) = (1/finite_difference_epsilon_ - zeta_) * fonc_ 
+                                                        - fonc_1_ / finite_difference_epsilon_ - fonc_2_;
+        return;
+      }
+    }
     nlp_.eval_fonc_hu(t1, x_1_, updated_solution_, fonc_2_);
 
     CGMRES_EIGEN_CONST_CAST(VectorType4, b_vec) = (1/finite_difference_epsilon_ - zeta_) * fonc_ 
@@ -82,6 +92,13 @@ public:
     assert(solution_update.size() == dim);
     assert(ax_vec.size() == dim);
     const Scalar t1 = t + finite_difference_epsilon_;
+    if constexpr (NLP::has_jvp) {
+      if (use_jvp_) {
+        nlp_.eval_fonc_hu_jvp(t1, x_1_, solution, solution_update, fonc_2_);
+        CGMRES_EIGEN_CONST_CAST(VectorType4, ax_vec) = fonc_2_;
+        return;
+      }
+    }
     updated_solution_ = solution + finite_difference_epsilon_ * solution_update;
     nlp_.eval_fonc_hu(t1, x_1_, updated_solution_, fonc_2_);
     CGMRES_EIGEN_CONST_CAST(VectorType4, ax_vec) = (fonc_2_ - fonc_1_) / finite_difference_epsilon_;
@@ -105,11 +122,26 @@ public:
 
   void synchronize_ocp() { nlp_.synchronize_ocp(); }
 
+  static constexpr int state_dim = dim + NLP::state_dim;
+
+  template <typename StateWriter>
+  void save_state(StateWriter& writer) const {
+    writer.write(fonc_);
+    nlp_.save_state(writer);
+  }
+
+  template <typename StateReader>
+  void load_state(StateReader& reader) {
+    reader.read(fonc_);
+    nlp_.load_state(reader);
+  }
+
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 private:
   NLP nlp_;
-  Scalar finite_difference_epsilon_, zeta_; 
+  Scalar finite_difference_epsilon_, zeta_;
+  bool use_jvp_ = false;
   Vector<dim> updated_solution_, fonc_, fonc_1_, fonc_2_;
   Vector<nx> x_1_, dx_;
 };
@@ -1,11 +1,13 @@
 #ifndef CGMRES__CONTINUATION_GMRES_CONDENSING_HPP_
 #define CGMRES__CONTINUATION_GMRES_CONDENSING_HPP_
 
+#include <array>
 #include <stdexcept>
 
 #include "cgmres/types.hpp"
 
 #include "cgmres/detail/macros.hpp"
+#include "cgmres/detail/phase_profiler.hpp"
 
 
 namespace cgmres {
@@ -24,10 +26,11 @@ public:
 
   ContinuationGMRESCondensing(const NLP& nlp, 
                               const Scalar finite_difference_epsilon, 
-                              const Scalar zeta) 
+                              const Scalar zeta, const bool use_jvp=false) 
     : nlp_(nlp), 
       finite_difference_epsilon_(finite_difference_epsilon),
       zeta_(zeta),
+      use_jvp_(use_jvp),
       updated_solution_(Vector<dim>::Zero()), 
       fonc_hu_(Vector<dim>::Zero()), 
       fonc_hu_1_(Vector<dim>::Zero()), 
@@ -111,6 +114,7 @@ public:
     assert(solution.size() == dim);
     assert(solution_update.size() == dim);
     assert(b_vec.size() == dim);
+    CGMRES_PHASE_PROBE(rhs_timer_);
 
     const Scalar t1 = t + finite_difference_epsilon_;
     nlp_.ocp().eval_f(t, x0.derived().data(), solution.derived().data(), dx_.data());
@@ -158,6 +162,18 @@ public:
       nlp_.eval_fonc_hu(solution, dummy_1_, mu_1_, fonc_hu_3_);
     }
 
+    if constexpr (NLP::has_jvp) {
+      if (use_jvp_) {
+        // The base point of eval_Ax().
+        x_1_ = x;
+        lmd_1_ = lmd;
+        evalAx(t, x0, solution, x, lmd, dummy, mu, solution_update, fonc_hu_2_);
+        CGMRES_EIGEN_CONST_CAST(VectorType4, b_vec) = (1.0/finite_difference_epsilon_ - zeta_) * fonc_hu_ 
+                                                      - fonc_hu_3_ / finite_difference_epsilon_ - fonc_hu_2_;
+        return;
+      }
+    }
+
     nlp_.eval_fonc_f(t1, x0_1_, solution, x, fonc_f_1_);
     nlp_.eval_fonc_hx(t1, x0_1_, solution, x, lmd, fonc_hx_1_);
 
@@ -187,28 +203,8 @@ public:
                const std::array<Vector<nub>, N>& mu,
                const MatrixBase<VectorType3>& solution_update, 
                const MatrixBase<VectorType4>& ax_vec) {
-    assert(x0.size() == nx);
-    assert(solution.size() == dim);
-    assert(solution_update.size() == dim);
-    assert(ax_vec.size() == dim);
-
-    const Scalar t1 = t + finite_difference_epsilon_;
-    updated_solution_ = solution + finite_difference_epsilon_ * solution_update;
-
-    nlp_.retrieve_x(t1, x0_1_, updated_solution_, x_1_, fonc_f_1_);
-    nlp_.retrieve_lmd(t1, x0_1_, updated_solution_, x_1_, lmd_1_, fonc_hx_1_);
-    if constexpr (nub > 0) {
-      nlp_.retrieve_mu_update(solution, dummy, mu, solution_update, mu_update_);
-      for (size_t i=0; i<N; ++i) {
-        mu_1_[i] = mu[i] - finite_difference_epsilon_ * mu_update_[i];
-      }
-    }
-
-    nlp_.eval_fonc_hu(t1, x0_1_, updated_solution_, x_1_, lmd_1_, fonc_hu_2_);
-    if constexpr (nub > 0) {
-      nlp_.eval_fonc_hu(updated_solution_, dummy_1_, mu_1_, fonc_hu_2_);
-    }
-    CGMRES_EIGEN_CONST_CAST(VectorType4, ax_vec) = (fonc_hu_2_ - fonc_hu_1_) / finite_difference_epsilon_;
+    CGMRES_PHASE_PROBE(operator_timer_);
+    evalAx(t, x0, solution, x, lmd, dummy, mu, solution_update, ax_vec);
   }
 
   template <typename VectorType1, typename VectorType2, typename VectorType3>
@@ -221,6 +217,7 @@ public:
                  const MatrixBase<VectorType3>& solution_update, 
                  const Scalar dt, const Scalar min_dummy) {
     assert(x0.size() == nx);
+    CGMRES_PHASE_PROBE(expansion_timer_);
     const Scalar t1 = t + finite_difference_epsilon_;
     updated_solution_ = solution + finite_difference_epsilon_ * solution_update;
     for (size_t i=0; i<N+1; ++i) {
@@ -252,6 +249,105 @@ public:
     }
   }
 
+  // Right-hand side of the Newton-type step at the fixed time t, i.e., J * solution_update = b_vec 
+  // with the condensed Jacobian J of eval_Ax() around the solution at (t, x0). If fonc_hu_ref 
+  // is given, b_vec = fonc_hu_ref - fonc_hu with the state and costate retrieved with the 
+  // residuals of the last eval_fonc(), i.e., the first-order correction of the change of 
+  // the OCP after eval_fonc() (parametric sensitivity). Otherwise, b_vec = - fonc_hu with 
+  // the state and costate retrieved exactly and the Lagrange multiplier with respect to the 
+  // bounds updated by the Newton step of the condensed hdummy and hmu (Newton step).
+  template <typename VectorType1, typename VectorType2, typename VectorType3>
+  void eval_b_fixed_time(const Scalar t, const MatrixBase<VectorType1>& x0, 
+                         const MatrixBase<VectorType2>& solution, 
+                         const std::array<Vector<nub>, N>& dummy,
+                         const std::array<Vector<nub>, N>& mu,
+                         const Vector<dim>* fonc_hu_ref,
+                         const MatrixBase<VectorType3>& b_vec) {
+    assert(x0.size() == nx);
+    assert(solution.size() == dim);
+    assert(b_vec.size() == dim);
+    CGMRES_PHASE_PROBE(rhs_timer_);
+    if (fonc_hu_ref) {
+      fonc_f_1_ = fonc_f_;
+      fonc_hx_1_ = fonc_hx_;
+    }
+    else {
+      std::fill(fonc_f_1_.begin(), fonc_f_1_.end(), Vector<nx>::Zero());
+      std::fill(fonc_hx_1_.begin(), fonc_hx_1_.end(), Vector<nx>::Zero());
+    }
+    nlp_.retrieve_x(t, x0, solution, x_1_, fonc_f_1_);
+    nlp_.retrieve_lmd(t, x0, solution, x_1_, lmd_1_, fonc_hx_1_);
+    nlp_.eval_fonc_hu(t, x0, solution, x_1_, lmd_1_, fonc_hu_3_);
+    // condensing of dummy and mu
+    if constexpr (nub > 0) {
+      if (fonc_hu_ref) {
+        std::fill(fonc_hdummy_1_.begin(), fonc_hdummy_1_.end(), Vector<nub>::Zero());
+        std::fill(fonc_hmu_1_.begin(), fonc_hmu_1_.end(), Vector<nub>::Zero());
+        mu_1_ = mu;
+      }
+      else {
+        nlp_.eval_fonc_hdummy(solution, dummy, mu, dummy_1_);
+        nlp_.eval_fonc_hmu(solution, dummy, mu, mu_1_);
+        for (size_t i=0; i<N; ++i) {
+          dummy_1_[i] = - dummy_1_[i];
+        }
+        for (size_t i=0; i<N; ++i) {
+          mu_1_[i] = - mu_1_[i];
+        }
+        nlp_.multiply_hdummy_inv(dummy, mu, dummy_1_, mu_1_, fonc_hdummy_1_);
+        nlp_.multiply_hmu_inv(dummy, mu, dummy_1_, mu_1_, fonc_hdummy_1_, fonc_hmu_1_);
+        for (size_t i=0; i<N; ++i) {
+          mu_1_[i] = mu[i] + fonc_hmu_1_[i];
+        }
+      }
+      nlp_.eval_fonc_hu(solution, dummy, mu_1_, fonc_hu_3_);
+    }
+    if (fonc_hu_ref) {
+      CGMRES_EIGEN_CONST_CAST(VectorType3, b_vec) = *fonc_hu_ref - fonc_hu_3_;
+    }
+    else {
+      CGMRES_EIGEN_CONST_CAST(VectorType3, b_vec) = - fonc_hu_3_;
+    }
+    // The base point of eval_Ax(). 
+    const Scalar t1 = t + finite_difference_epsilon_;
+    x0_1_ = x0;
+    nlp_.retrieve_x(t1, x0_1_, solution, x_1_, fonc_f_1_);
+    nlp_.retrieve_lmd(t1, x0_1_, solution, x_1_, lmd_1_, fonc_hx_1_);
+    nlp_.eval_fonc_hu(t1, x0_1_, solution, x_1_, lmd_1_, fonc_hu_1_);
+    if constexpr (nub > 0) {
+      nlp_.eval_fonc_hu(solution, dummy, mu, fonc_hu_1_);
+      dummy_1_ = dummy;
+    }
+  }
+
+  // Applies the step computed with eval_b_fixed_time() and eval_Ax(). 
+  template <typename VectorType1, typename VectorType2>
+  void expansion_fixed_time(const Scalar t, const MatrixBase<VectorType1>& x0, 
+                            Vector<dim>& solution, 
+                            std::array<Vector<nx>, N+1>& x,
+                            std::array<Vector<nx>, N+1>& lmd,
+                            std::array<Vector<nub>, N>& dummy,
+                            std::array<Vector<nub>, N>& mu,
+                            const MatrixBase<VectorType2>& solution_update, 
+                            const Scalar min_dummy) {
+    assert(x0.size() == nx);
+    CGMRES_PHASE_PROBE(expansion_timer_);
+    if constexpr (nub > 0) {
+      nlp_.retrieve_dummy_update(solution, dummy, mu, solution_update, dummy_update_);
+      nlp_.retrieve_mu_update(solution, dummy, mu, solution_update, mu_update_);
+      for (size_t i=0; i<N; ++i) {
+        dummy[i].noalias() += fonc_hdummy_1_[i] - dummy_update_[i];
+      }
+      for (size_t i=0; i<N; ++i) {
+        mu[i].noalias() += fonc_hmu_1_[i] - mu_update_[i];
+      }
+      nlp_.clip_dummy(dummy, min_dummy);
+    }
+    solution.noalias() += solution_update;
+    nlp_.retrieve_x(t, x0, solution, x, fonc_f_1_);
+    nlp_.retrieve_lmd(t, x0, solution, x, lmd, fonc_hx_1_);
+  }
+
   template <typename VectorType>
   void retrieve_x(const Scalar t, const MatrixBase<VectorType>& x0, const Vector<dim>& solution, 
                  std::array<Vector<nx>, N+1>& x) {
@@ -291,7 +387,7 @@ public:
       std::fill(fonc_hdummy_1_.begin(), fonc_hdummy_1_.end(), Vector<nub>::Zero());
       std::fill(mu.begin(), mu.end(), Vector<nub>::Zero());
       nlp_.eval_fonc_hdummy(solution, dummy, mu, fonc_hdummy_1_);
-      for (size_t i=0; i<N; ++i) {
+      for (int i=0; i<nlp_.active_N(); ++i) {
         mu[i].array() = - fonc_hdummy_1_[i].array() / (2.0 * dummy[i].array());
       }
     }
@@ -299,18 +395,146 @@ public:
 
   const NLP& get_nlp() const { return nlp_; }
 
+  NLP& get_nlp() { return nlp_; }
+
   void synchronize_ocp() { nlp_.synchronize_ocp(); }
 
+  const Vector<dim>& fonc_hu() const { return fonc_hu_; }
+
+  const PhaseTimer& rhs_timer() const { return rhs_timer_; }
+
+  const PhaseTimer& operator_timer() const { return operator_timer_; }
+
+  const PhaseTimer& expansion_timer() const { return expansion_timer_; }
+
+  static constexpr int state_dim = dim + 2 * (N+1) * nx + 2 * N * nub;
+
+  template <typename StateWriter>
+  void save_state(StateWriter& writer) const {
+    writer.write(fonc_hu_);
+    writer.write(fonc_f_);
+    writer.write(fonc_hx_);
+    writer.write(fonc_hdummy_);
+    writer.write(fonc_hmu_);
+  }
+
+  template <typename StateReader>
+  void load_state(StateReader& reader) {
+    reader.read(fonc_hu_);
+    reader.read(fonc_f_);
+    reader.read(fonc_hx_);
+    reader.read(fonc_hdummy_);
+    reader.read(fonc_hmu_);
+  }
+
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 private:
   NLP nlp_;
   Scalar finite_difference_epsilon_, zeta_; 
+  bool use_jvp_ = false;
   Vector<dim> updated_solution_, fonc_hu_, fonc_hu_1_, fonc_hu_2_, fonc_hu_3_;
   std::array<Vector<nx>, N+1> x_1_, lmd_1_, fonc_f_, fonc_hx_, fonc_f_1_, fonc_hx_1_;
   std::array<Vector<nub>, N> dummy_1_, mu_1_, fonc_hdummy_, fonc_hmu_, 
                              fonc_hdummy_1_, fonc_hmu_1_, dummy_update_, mu_update_;
   Vector<nx> x0_1_, dx_;
+  PhaseTimer rhs_timer_, operator_timer_, expansion_timer_;
+
+  template <typename VectorType1, typename VectorType2, typename VectorType3, typename VectorType4>
+  void evalAx(const Scalar t, const MatrixBase<VectorType1>& x0, 
+              const MatrixBase<VectorType2>& solution, 
+              const std::array<Vector<nx>, N+1>& x,
+              const std::array<Vector<nx>, N+1>& lmd,
+              const std::array<Vector<nub>, N>& dummy,
+              const std::array<Vector<nub>, N>& mu,
+              const MatrixBase<VectorType3>& solution_update, 
+              const MatrixBase<VectorType4>& ax_vec) {
+    assert(x0.size() == nx);
+    assert(solution.size() == dim);
+    assert(solution_update.size() == dim);
+    assert(ax_vec.size() == dim);
+
+    const Scalar t1 = t + finite_difference_epsilon_;
+    if constexpr (NLP::has_jvp) {
+      if (use_jvp_) {
+        // Exact directional derivative around the base point (t1, x0_1_, x_1_, lmd_1_) 
+        // set by eval_b() or eval_b_fixed_time().
+        nlp_.eval_fonc_hu_jvp(t1, x0_1_, solution, x_1_, lmd_1_, solution_update, fonc_hu_2_);
+        if constexpr (nub > 0) {
+          nlp_.retrieve_mu_update(solution, dummy, mu, solution_update, mu_update_);
+          for (size_t i=0; i<N; ++i) {
+            mu_1_[i] = - mu_update_[i];
+          }
+          nlp_.eval_fonc_hu_jvp(solution, mu, solution_update, mu_1_, fonc_hu_2_);
+        }
+        CGMRES_EIGEN_CONST_CAST(VectorType4, ax_vec) = fonc_hu_2_;
+        return;
+      }
+    }
+    updated_solution_ = solution + finite_difference_epsilon_ * solution_update;
+
+    nlp_.retrieve_x(t1, x0_1_, updated_solution_, x_1_, fonc_f_1_);
+    nlp_.retrieve_lmd(t1, x0_1_, updated_solution_, x_1_, lmd_1_, fonc_hx_1_);
+    if constexpr (nub > 0) {
+      nlp_.retrieve_mu_update(solution, dummy, mu, solution_update, mu_update_);
+      for (size_t i=0; i<N; ++i) {
+        mu_1_[i] = mu[i] - finite_difference_epsilon_ * mu_update_[i];
+      }
+    }
+
+    nlp_.eval_fonc_hu(t1, x0_1_, updated_solution_, x_1_, lmd_1_, fonc_hu_2_);
+    if constexpr (nub > 0) {
+      nlp_.eval_fonc_hu(updated_solution_, dummy_1_, mu_1_, fonc_hu_2_);
+    }
+    CGMRES_EIGEN_CONST_CAST(VectorType4, ax_vec) = (fonc_hu_2_ - fonc_hu_1_) / finite_difference_epsilon_;
+  }
+};
+
+///
+/// @brief Linear problem of the Newton-type step at a fixed time of ContinuationGMRESCondensing, 
+/// i.e., the right-hand side of ContinuationGMRESCondensing::eval_b_fixed_time() and the 
+/// operator ContinuationGMRESCondensing::eval_Ax(), solved by MatrixFreeGMRES::solve_other().
+///
+template <class ContinuationGMRES>
+class FixedTimeLinearProblem {
+public:
+  static constexpr int nx = ContinuationGMRES::nx;
+  static constexpr int nub = ContinuationGMRES::nub;
+  static constexpr int dim = ContinuationGMRES::dim;
+  static constexpr int N = ContinuationGMRES::N;
+
+  FixedTimeLinearProblem(ContinuationGMRES& continuation_gmres, const Vector<dim>* fonc_hu_ref)
+    : continuation_gmres_(continuation_gmres),
+      fonc_hu_ref_(fonc_hu_ref) {
+  }
+
+  template <typename VectorType1, typename VectorType2, typename VectorType3, typename VectorType4>
+  void eval_b(const Scalar t, const MatrixBase<VectorType1>& x0, 
+              const MatrixBase<VectorType2>& solution, 
+              const std::array<Vector<nx>, N+1>&,
+              const std::array<Vector<nx>, N+1>&,
+              const std::array<Vector<nub>, N>& dummy,
+              const std::array<Vector<nub>, N>& mu,
+              const MatrixBase<VectorType3>&, 
+              const MatrixBase<VectorType4>& b_vec) {
+    continuation_gmres_.eval_b_fixed_time(t, x0, solution, dummy, mu, fonc_hu_ref_, b_vec);
+  }
+
+  template <typename VectorType1, typename VectorType2, typename VectorType3, typename VectorType4>
+  void eval_Ax(const Scalar t, const MatrixBase<VectorType1>& x0, 
+               const MatrixBase<VectorType2>& solution, 
+               const std::array<Vector<nx>, N+1>& x,
+               const std::array<Vector<nx>, N+1>& lmd,
+               const std::array<Vector<nub>, N>& dummy,
+               const std::array<Vector<nub>, N>& mu,
+               const MatrixBase<VectorType3>& solution_update, 
+               const MatrixBase<VectorType4>& ax_vec) {
+    continuation_gmres_.eval_Ax(t, x0, solution, x, lmd, dummy, mu, solution_update, ax_vec);
+  }
+
+private:
+  ContinuationGMRES& continuation_gmres_;
+  const Vector<dim>* fonc_hu_ref_;
 };
 
 } // namespace detail
@@ -0,0 +1,87 @@
+#ifndef CGMRES__CONTINUATION_MHE_HPP_
+#define CGMRES__CONTINUATION_MHE_HPP_
+
+#include <stdexcept>
+
+#include "cgmres/types.hpp"
+
+#include "cgmres/detail/macros.hpp"
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Linear problem of the continuation of the moving horizon estimation,
+/// i.e., H dz/dt = - zeta F with the gradient F of the least-squares cost and its
+/// Gauss-Newton Hessian H, for MatrixFreeGMRES. The argument of the linear problem
+/// is the decision variable z.
+///
+template <class NLP>
+class ContinuationMHE {
+public:
+  static constexpr int dim = NLP::dim;
+
+  ContinuationMHE(const NLP& nlp, const Scalar finite_difference_epsilon,
+                  const Scalar zeta)
+    : nlp_(nlp),
+      finite_difference_epsilon_(finite_difference_epsilon),
+      zeta_(zeta),
+      fonc_(Vector<dim>::Zero()),
+      hess_dir_(Vector<dim>::Zero()) {
+    if (finite_difference_epsilon <= 0.0) {
+      throw std::invalid_argument("[ContinuationMHE]: 'finite_difference_epsilon' must be positive!");
+    }
+    if (zeta <= 0.0) {
+      throw std::invalid_argument("[ContinuationMHE]: 'zeta' must be positive!");
+    }
+  }
+
+  ContinuationMHE() = default;
+
+  ~ContinuationMHE() = default;
+
+  Scalar optError() const { return fonc_.template lpNorm<2>(); }
+
+  void eval_fonc(const Vector<dim>& z) {
+    nlp_.rollout(z);
+    nlp_.eval_fonc(z, fonc_);
+  }
+
+  template <typename VectorType1, typename VectorType2>
+  void eval_b(const Vector<dim>& z, const MatrixBase<VectorType1>& z_update,
+              const MatrixBase<VectorType2>& b_vec) {
+    assert(z_update.size() == dim);
+    assert(b_vec.size() == dim);
+    eval_fonc(z);
+    CGMRES_EIGEN_CONST_CAST(VectorType2, b_vec) = - zeta_ * fonc_;
+    if (z_update.squaredNorm() > 0.0) {
+      nlp_.eval_gauss_newton_product(z_update, finite_difference_epsilon_, hess_dir_);
+      CGMRES_EIGEN_CONST_CAST(VectorType2, b_vec) -= hess_dir_;
+    }
+  }
+
+  template <typename VectorType1, typename VectorType2>
+  void eval_Ax(const Vector<dim>&, const MatrixBase<VectorType1>& z_update,
+               const MatrixBase<VectorType2>& ax_vec) {
+    assert(z_update.size() == dim);
+    assert(ax_vec.size() == dim);
+    nlp_.eval_gauss_newton_product(z_update, finite_difference_epsilon_, ax_vec);
+  }
+
+  const NLP& get_nlp() const { return nlp_; }
+
+  NLP& get_nlp() { return nlp_; }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  NLP nlp_;
+  Scalar finite_difference_epsilon_, zeta_;
+  Vector<dim> fonc_, hess_dir_;
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__CONTINUATION_MHE_HPP_
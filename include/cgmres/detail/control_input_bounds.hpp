@@ -62,6 +62,83 @@ void eval_hmu(const OCP& ocp, const MatrixBase<VectorType1>& u,
   }
 }
 
+template <typename OCP, typename VectorType1, typename VectorType2, typename VectorType3, 
+          typename VectorType4, typename VectorType5>
+void eval_hu_jvp(const OCP& ocp, const MatrixBase<VectorType1>& u, 
+                 const MatrixBase<VectorType2>& mu, 
+                 const MatrixBase<VectorType3>& u_dir, 
+                 const MatrixBase<VectorType4>& mu_dir, 
+                 const MatrixBase<VectorType5>& hu_jvp) {
+  constexpr int nub = OCP::nub;
+  if constexpr (nub > 0) {
+    assert(mu.size() == nub);
+    assert(mu_dir.size() == nub);
+    for (int i=0; i<nub; ++i) {
+      const auto ui = OCP::ubound_indices[i];
+      CGMRES_EIGEN_CONST_CAST(VectorType5, hu_jvp).coeffRef(ui)
+          += mu_dir.coeff(i) * (2.0*u.coeff(ui) - ocp.umin[i] - ocp.umax[i]) 
+              + 2.0 * mu.coeff(i) * u_dir.coeff(ui);
+    }
+  }
+}
+
+template <typename VectorType1, typename VectorType2, typename VectorType3, 
+          typename VectorType4, typename VectorType5>
+void eval_hdummy_jvp(const MatrixBase<VectorType1>& dummy, 
+                     const MatrixBase<VectorType2>& mu, 
+                     const MatrixBase<VectorType3>& dummy_dir, 
+                     const MatrixBase<VectorType4>& mu_dir, 
+                     const MatrixBase<VectorType5>& hdummy_jvp) {
+  CGMRES_EIGEN_CONST_CAST(VectorType5, hdummy_jvp).array() 
+      = 2.0 * (mu_dir.array() * dummy.array() + mu.array() * dummy_dir.array());
+}
+
+template <typename OCP, typename VectorType1, typename VectorType2, typename VectorType3, 
+          typename VectorType4, typename VectorType5>
+void eval_hmu_jvp(const OCP& ocp, const MatrixBase<VectorType1>& u, 
+                  const MatrixBase<VectorType2>& dummy, 
+                  const MatrixBase<VectorType3>& u_dir, 
+                  const MatrixBase<VectorType4>& dummy_dir, 
+                  const MatrixBase<VectorType5>& hmu_jvp) {
+  constexpr int nub = OCP::nub;
+  if constexpr (nub > 0) {
+    assert(dummy.size() == nub);
+    assert(hmu_jvp.size() == nub);
+    for (int i=0; i<nub; ++i) {
+      const auto ui = OCP::ubound_indices[i];
+      CGMRES_EIGEN_CONST_CAST(VectorType5, hmu_jvp).coeffRef(i)
+          = (2.0*u.coeff(ui) - ocp.umin[i] - ocp.umax[i]) * u_dir.coeff(ui) 
+              + 2.0 * dummy.coeff(i) * dummy_dir.coeff(i);
+    }
+  }
+}
+
+template <typename OCP, typename VectorType1, typename VectorType2, typename VectorType3, typename MatrixType>
+void add_fonc_jacobian(const OCP& ocp, const MatrixBase<VectorType1>& u, 
+                       const MatrixBase<VectorType2>& dummy, 
+                       const MatrixBase<VectorType3>& mu, 
+                       const MatrixBase<MatrixType>& jac) {
+  constexpr int nub = OCP::nub;
+  if constexpr (nub > 0) {
+    constexpr int nuc = OCP::nu + OCP::nc;
+    assert(dummy.size() == nub);
+    assert(mu.size() == nub);
+    assert(jac.rows() == nuc + 2 * nub);
+    assert(jac.cols() == nuc + 2 * nub);
+    auto& jac_ = CGMRES_EIGEN_CONST_CAST(MatrixType, jac);
+    for (int i=0; i<nub; ++i) {
+      const auto ui = OCP::ubound_indices[i];
+      const Scalar hmu_u = 2.0*u.coeff(ui) - ocp.umin[i] - ocp.umax[i];
+      jac_.coeffRef(ui, ui) += 2.0 * mu.coeff(i);
+      jac_.coeffRef(ui, nuc+nub+i) += hmu_u;
+      jac_.coeffRef(nuc+i, nuc+i) += 2.0 * mu.coeff(i);
+      jac_.coeffRef(nuc+i, nuc+nub+i) += 2.0 * dummy.coeff(i);
+      jac_.coeffRef(nuc+nub+i, ui) += hmu_u;
+      jac_.coeffRef(nuc+nub+i, nuc+i) += 2.0 * dummy.coeff(i);
+    }
+  }
+}
+
 template <typename VectorType1, typename VectorType2, typename VectorType3, 
           typename VectorType4, typename VectorType5>
 void multiply_hdummy_inv(const MatrixBase<VectorType1>& dummy, 
@@ -16,27 +16,49 @@ template <typename OCP, int N>
 void eval_fonc_hu(const OCP& ocp, const Vector<OCP::nuc*N>& solution,
                   const std::array<Vector<OCP::nub>, N>& dummy, 
                   const std::array<Vector<OCP::nub>, N>& mu,
-                  Vector<OCP::nuc*N>& fonc_hu) {
+                  Vector<OCP::nuc*N>& fonc_hu,
+                  const int n=N) {
   if constexpr (OCP::nub > 0) {
     constexpr int nuc = OCP::nuc;
-    for (size_t i=0; i<N; ++i) {
+    for (int i=0; i<n; ++i) {
       eval_hu(ocp, solution.template segment<nuc>(nuc*i), dummy[i], mu[i],
               fonc_hu.template segment<nuc>(nuc*i));
     }
   }
 }
 
+template <typename OCP, int N, typename VectorType>
+void eval_fonc_hu_jvp(const OCP& ocp, const Vector<OCP::nuc*N>& solution,
+                      const std::array<Vector<OCP::nub>, N>& mu,
+                      const MatrixBase<VectorType>& solution_dir,
+                      const std::array<Vector<OCP::nub>, N>& mu_dir,
+                      Vector<OCP::nuc*N>& fonc_hu_jvp,
+                      const int n=N) {
+  if constexpr (OCP::nub > 0) {
+    constexpr int nuc = OCP::nuc;
+    for (int i=0; i<n; ++i) {
+      eval_hu_jvp(ocp, solution.template segment<nuc>(nuc*i), mu[i],
+                  solution_dir.template segment<nuc>(nuc*i), mu_dir[i],
+                  fonc_hu_jvp.template segment<nuc>(nuc*i));
+    }
+  }
+}
+
 template <typename OCP, int N>
 void eval_fonc_hdummy(const OCP& ocp, const Vector<OCP::nuc*N>& solution,
                       const std::array<Vector<OCP::nub>, N>& dummy, 
                       const std::array<Vector<OCP::nub>, N>& mu,
-                      std::array<Vector<OCP::nub>, N>& fonc_hdummy) {
+                      std::array<Vector<OCP::nub>, N>& fonc_hdummy,
+                      const int n=N) {
   if constexpr (OCP::nub > 0) {
     constexpr int nuc = OCP::nuc;
-    for (size_t i=0; i<N; ++i) {
+    for (int i=0; i<n; ++i) {
       eval_hdummy(ocp, solution.template segment<nuc>(nuc*i), dummy[i], mu[i],
                   fonc_hdummy[i]);
     }
+    for (int i=n; i<N; ++i) {
+      fonc_hdummy[i].setZero();
+    }
   }
 }
 
@@ -44,13 +66,17 @@ template <typename OCP, int N>
 void eval_fonc_hmu(const OCP& ocp, const Vector<OCP::nuc*N>& solution,
                    const std::array<Vector<OCP::nub>, N>& dummy, 
                    const std::array<Vector<OCP::nub>, N>& mu,
-                   std::array<Vector<OCP::nub>, N>& fonc_hmu) {
+                   std::array<Vector<OCP::nub>, N>& fonc_hmu,
+                   const int n=N) {
   if constexpr (OCP::nub > 0) {
     constexpr int nuc = OCP::nuc;
-    for (size_t i=0; i<N; ++i) {
+    for (int i=0; i<n; ++i) {
       eval_hmu(ocp, solution.template segment<nuc>(nuc*i), dummy[i], mu[i],
                fonc_hmu[i]);
     }
+    for (int i=n; i<N; ++i) {
+      fonc_hmu[i].setZero();
+    }
   }
 }
 
@@ -59,12 +85,16 @@ void multiply_hdummy_inv(const std::array<Vector<OCP::nub>, N>& dummy,
                          const std::array<Vector<OCP::nub>, N>& mu,
                          const std::array<Vector<OCP::nub>, N>& fonc_hdummy,
                          const std::array<Vector<OCP::nub>, N>& fonc_hmu,
-                         std::array<Vector<OCP::nub>, N>& fonc_hdummy_inv) {
+                         std::array<Vector<OCP::nub>, N>& fonc_hdummy_inv,
+                         const int n=N) {
   if constexpr (OCP::nub > 0) {
-    for (size_t i=0; i<N; ++i) {
+    for (int i=0; i<n; ++i) {
       multiply_hdummy_inv(dummy[i], mu[i], fonc_hdummy[i], fonc_hmu[i],
                           fonc_hdummy_inv[i]);
     }
+    for (int i=n; i<N; ++i) {
+      fonc_hdummy_inv[i].setZero();
+    }
   }
 }
 
@@ -74,12 +104,16 @@ void multiply_hmu_inv(const std::array<Vector<OCP::nub>, N>& dummy,
                       const std::array<Vector<OCP::nub>, N>& fonc_hdummy,
                       const std::array<Vector<OCP::nub>, N>& fonc_hmu,
                       const std::array<Vector<OCP::nub>, N>& fonc_hdummy_inv,
-                      std::array<Vector<OCP::nub>, N>& fonc_hmu_inv) {
+                      std::array<Vector<OCP::nub>, N>& fonc_hmu_inv,
+                      const int n=N) {
   if constexpr (OCP::nub > 0) {
-    for (size_t i=0; i<N; ++i) {
+    for (int i=0; i<n; ++i) {
       multiply_hmu_inv(dummy[i], mu[i], fonc_hdummy[i], fonc_hmu[i],
                        fonc_hdummy_inv[i], fonc_hmu_inv[i]);
     }
+    for (int i=n; i<N; ++i) {
+      fonc_hmu_inv[i].setZero();
+    }
   }
 }
 
@@ -89,13 +123,17 @@ void retrieve_dummy_update(const OCP& ocp,
                           const std::array<Vector<OCP::nub>, N>& dummy, 
                           const std::array<Vector<OCP::nub>, N>& mu,
                           const Vector<OCP::nuc*N>& solution_update,
-                          std::array<Vector<OCP::nub>, N>& dummy_update) {
+                          std::array<Vector<OCP::nub>, N>& dummy_update,
+                           const int n=N) {
   if constexpr (OCP::nub > 0) {
     constexpr int nuc = OCP::nuc;
-    for (size_t i=0; i<N; ++i) {
+    for (int i=0; i<n; ++i) {
       retrieve_dummy_update(ocp, solution.template segment<nuc>(nuc*i), dummy[i], mu[i], 
                            solution_update.template segment<nuc>(nuc*i), dummy_update[i]);
     }
+    for (int i=n; i<N; ++i) {
+      dummy_update[i].setZero();
+    }
   } 
 }
 
@@ -105,20 +143,25 @@ void retrieve_mu_update(const OCP& ocp,
                        const std::array<Vector<OCP::nub>, N>& dummy, 
                        const std::array<Vector<OCP::nub>, N>& mu,
                        const Vector<OCP::nuc*N>& solution_update,
-                       std::array<Vector<OCP::nub>, N>& mu_update) {
+                       std::array<Vector<OCP::nub>, N>& mu_update,
+                        const int n=N) {
   if constexpr (OCP::nub > 0) {
     constexpr int nuc = OCP::nuc;
-    for (size_t i=0; i<N; ++i) {
+    for (int i=0; i<n; ++i) {
       retrieve_mu_update(ocp, solution.template segment<nuc>(nuc*i), dummy[i], mu[i], 
                         solution_update.template segment<nuc>(nuc*i), mu_update[i]);
     }
+    for (int i=n; i<N; ++i) {
+      mu_update[i].setZero();
+    }
   } 
 }
 
 template <typename OCP, int N>
-void clip_dummy(std::array<Vector<OCP::nub>, N>& dummy, const Scalar min) {
+void clip_dummy(std::array<Vector<OCP::nub>, N>& dummy, const Scalar min,
+                const int n=N) {
   if constexpr (OCP::nub > 0) {
-    for (size_t i=0; i<N; ++i) {
+    for (int i=0; i<n; ++i) {
       clip_dummy(dummy[i], min);
     }
   } 
@@ -0,0 +1,121 @@
+#ifndef CGMRES__HORIZON_SHIFT_HPP_
+#define CGMRES__HORIZON_SHIFT_HPP_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "cgmres/types.hpp"
+#include "cgmres/input_interpolation.hpp"
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Resamples a trajectory over the horizon in-place so that the i-th entry 
+/// becomes the value at the (possibly non-integer) grid position offset + scale * i 
+/// of the original trajectory. The entries between the grid points are linearly 
+/// interpolated and the tail beyond the last grid point is extrapolated by holding 
+/// the last entry.
+/// @param[in, out] traj Trajectory over the horizon. 
+/// @param[in] offset Offset of the grid positions. Must be non-negative.
+/// @param[in] scale Scale of the grid positions. Must be no less than 1.
+/// @param[in] size Number of the valid entries of traj. The other entries are 
+/// not touched. Must be in [1, M]. Default is M.
+///
+template <typename T, std::size_t M>
+void shift_trajectory(std::array<T, M>& traj, const Scalar offset, const Scalar scale=1.0,
+                      const std::size_t size=M) {
+  for (std::size_t i=0; i<size; ++i) {
+    const Scalar pos = offset + scale * static_cast<Scalar>(i);
+    if (pos >= static_cast<Scalar>(size-1)) {
+      traj[i] = traj[size-1];
+    }
+    else {
+      const std::size_t k = static_cast<std::size_t>(std::floor(pos));
+      const Scalar w = pos - static_cast<Scalar>(k);
+      traj[i] = (1.0-w) * traj[k] + w * traj[k+1];
+    }
+  }
+}
+
+///
+/// @brief Resamples the valid entries of a trajectory in-place onto another number 
+/// of the grids, i.e., the i-th entry becomes the value at the grid position 
+/// scale * i of the original trajectory, linearly interpolated and held beyond 
+/// the last valid entry. The entries from new_size are set to zero.
+/// @param[in, out] traj Trajectory over the horizon. 
+/// @param[in] size Number of the valid entries before resampling. Must be in [1, M].
+/// @param[in] new_size Number of the valid entries after resampling. Must be in [1, M].
+/// @param[in] scale Ratio of the new grid interval to the old one. Must be positive.
+///
+template <typename T, std::size_t M>
+void resample_trajectory(std::array<T, M>& traj, const std::size_t size, 
+                         const std::size_t new_size, const Scalar scale) {
+  const auto resample = [&](const std::size_t i) {
+    const Scalar pos = scale * static_cast<Scalar>(i);
+    if (pos >= static_cast<Scalar>(size-1)) {
+      traj[i] = traj[size-1];
+    }
+    else {
+      const std::size_t k = static_cast<std::size_t>(std::floor(pos));
+      const Scalar w = pos - static_cast<Scalar>(k);
+      traj[i] = (1.0-w) * traj[k] + w * traj[k+1];
+    }
+  };
+  // Each entry only depends on the entries at and after (coarsening) or at and 
+  // before (refining) its index, so the order of the loop makes it in-place.
+  if (scale >= 1.0) {
+    for (std::size_t i=0; i<new_size; ++i) {
+      resample(i);
+    }
+  }
+  else {
+    for (std::size_t i=new_size; i-->0; ) {
+      resample(i);
+    }
+  }
+  for (std::size_t i=new_size; i<M; ++i) {
+    traj[i].setZero();
+  }
+}
+
+///
+/// @brief Evaluates a trajectory over the horizon at a (possibly non-integer)
+/// grid position. Positions before the first grid and after the last valid
+/// grid are clamped.
+/// @param[in] traj Trajectory over the horizon.
+/// @param[in] pos Grid position.
+/// @param[in] size Number of the valid entries of traj. Must be in [1, M].
+/// @param[in] method Interpolation method.
+/// @return The interpolated value.
+///
+template <typename T, std::size_t M>
+T interpolate_trajectory(const std::array<T, M>& traj, const Scalar pos,
+                         const std::size_t size, const InputInterpolation method) {
+  if (!(pos > 0.0)) return traj[0];
+  if (pos >= static_cast<Scalar>(size-1)) return traj[size-1];
+  const std::size_t k = static_cast<std::size_t>(std::floor(pos));
+  const Scalar w = pos - static_cast<Scalar>(k);
+  switch (method) {
+    case InputInterpolation::ZeroOrderHold:
+      return traj[k];
+    case InputInterpolation::Linear:
+      return (1.0-w) * traj[k] + w * traj[k+1];
+    default: {
+      // Tangents by the central differences, one-sided at the ends.
+      const T m0 = (k > 0) ? T(0.5 * (traj[k+1] - traj[k-1])) : T(traj[k+1] - traj[k]);
+      const T m1 = (k+2 < size) ? T(0.5 * (traj[k+2] - traj[k])) : T(traj[k+1] - traj[k]);
+      const Scalar w2 = w * w;
+      const Scalar w3 = w2 * w;
+      return (2.0*w3 - 3.0*w2 + 1.0) * traj[k] + (w3 - 2.0*w2 + w) * m0
+              + (-2.0*w3 + 3.0*w2) * traj[k+1] + (w3 - w2) * m1;
+    }
+  }
+}
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__HORIZON_SHIFT_HPP_
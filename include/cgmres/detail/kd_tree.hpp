@@ -0,0 +1,112 @@
+#ifndef CGMRES__KD_TREE_HPP_
+#define CGMRES__KD_TREE_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "cgmres/types.hpp"
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @class KDTree
+/// @brief Static k-d tree for the nearest neighbour search of points of dimension n.
+/// The tree is stored implicitly in a permutation of the point indices: the median
+/// of each index range is the node splitting the range.
+///
+template <int n>
+class KDTree {
+public:
+  KDTree() = default;
+
+  ~KDTree() = default;
+
+  ///
+  /// @brief Builds the tree.
+  /// @param[in] points Points.
+  ///
+  void build(std::vector<Vector<n>> points) {
+    points_ = std::move(points);
+    indices_.resize(points_.size());
+    split_dims_.resize(points_.size());
+    for (std::size_t i=0; i<indices_.size(); ++i) {
+      indices_[i] = i;
+    }
+    buildRange(0, indices_.size());
+  }
+
+  std::size_t size() const { return points_.size(); }
+
+  ///
+  /// @brief Finds the nearest point in the Euclidean distance.
+  /// @param[in] query Query point.
+  /// @param[out] squared_distance Squared distance to the nearest point.
+  /// @return Index of the nearest point. Must not be called if the tree is empty.
+  ///
+  std::size_t nearest(const Vector<n>& query, Scalar& squared_distance) const {
+    std::size_t best = 0;
+    squared_distance = std::numeric_limits<Scalar>::infinity();
+    searchRange(0, indices_.size(), query, best, squared_distance);
+    return best;
+  }
+
+private:
+  std::vector<Vector<n>> points_;
+  std::vector<std::size_t> indices_;
+  std::vector<int> split_dims_;
+
+  void buildRange(const std::size_t begin, const std::size_t end) {
+    if (end - begin <= 1) return;
+    // Splits along the dimension of the largest spread.
+    Vector<n> lb = points_[indices_[begin]], ub = lb;
+    for (std::size_t i=begin+1; i<end; ++i) {
+      lb = lb.cwiseMin(points_[indices_[i]]);
+      ub = ub.cwiseMax(points_[indices_[i]]);
+    }
+    int dim = 0;
+    (ub - lb).maxCoeff(&dim);
+    const std::size_t mid = begin + (end - begin) / 2;
+    std::nth_element(indices_.begin()+begin, indices_.begin()+mid, indices_.begin()+end,
+                     [&](const std::size_t a, const std::size_t b) {
+                       return points_[a].coeff(dim) < points_[b].coeff(dim);
+                     });
+    split_dims_[mid] = dim;
+    buildRange(begin, mid);
+    buildRange(mid+1, end);
+  }
+
+  void searchRange(const std::size_t begin, const std::size_t end, const Vector<n>& query,
+                   std::size_t& best, Scalar& best_squared_distance) const {
+    if (begin >= end) return;
+    const std::size_t mid = begin + (end - begin) / 2;
+    const auto& point = points_[indices_[mid]];
+    const Scalar squared_distance = (point - query).squaredNorm();
+    if (squared_distance < best_squared_distance) {
+      best = indices_[mid];
+      best_squared_distance = squared_distance;
+    }
+    if (end - begin == 1) return;
+    const int dim = split_dims_[mid];
+    const Scalar diff = query.coeff(dim) - point.coeff(dim);
+    if (diff < 0.0) {
+      searchRange(begin, mid, query, best, best_squared_distance);
+      if (diff * diff < best_squared_distance) {
+        searchRange(mid+1, end, query, best, best_squared_distance);
+      }
+    }
+    else {
+      searchRange(mid+1, end, query, best, best_squared_distance);
+      if (diff * diff < best_squared_distance) {
+        searchRange(begin, mid, query, best, best_squared_distance);
+      }
+    }
+  }
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__KD_TREE_HPP_
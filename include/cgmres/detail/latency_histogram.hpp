@@ -0,0 +1,97 @@
+#ifndef CGMRES__LATENCY_HISTOGRAM_HPP_
+#define CGMRES__LATENCY_HISTOGRAM_HPP_
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Fixed-memory log-linear histogram of latencies in nanoseconds in the
+/// manner of the HDR histogram. The latencies are recorded in units of 2^unit_bits ns
+/// (128 ns), the lowest discernible value. The values below 2 * sub_buckets units
+/// (about 16 us) are recorded at this resolution and each power-of-two range above
+/// is split into sub_buckets linear buckets, i.e., the relative error of the recorded
+/// values is below 1 / sub_buckets (1.6%). The values above 2^max_bits ns (about 69 s)
+/// are saturated. Histograms are merged by adding the counts, e.g., across solver
+/// instances and threads.
+///
+class LatencyHistogram {
+public:
+  static constexpr int unit_bits = 7;
+  static constexpr int sub_bucket_bits = 6;
+  static constexpr int max_bits = 36;
+  static constexpr std::uint64_t sub_buckets = std::uint64_t(1) << sub_bucket_bits;
+  static constexpr std::uint64_t max_value = (std::uint64_t(1) << max_bits) - 1;
+  static constexpr int max_shift = max_bits - unit_bits - sub_bucket_bits - 1;
+  static constexpr std::size_t num_buckets = (max_shift + 2) * sub_buckets;
+
+  LatencyHistogram() { reset(); }
+
+  ~LatencyHistogram() = default;
+
+  void reset() {
+    counts_.fill(0);
+    total_count_ = 0;
+  }
+
+  void record(const std::uint64_t value_ns) {
+    ++counts_[bucketIndex(std::min(value_ns, max_value) >> unit_bits)];
+    ++total_count_;
+  }
+
+  void merge(const LatencyHistogram& other) {
+    for (std::size_t i=0; i<num_buckets; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    total_count_ += other.total_count_;
+  }
+
+  std::uint64_t total_count() const { return total_count_; }
+
+  std::uint64_t count(const std::size_t bucket) const { return counts_[bucket]; }
+
+  // Upper bound of the bucket of the q-quantile, i.e., a conservative estimate of the
+  // q-quantile. Zero if empty.
+  std::uint64_t quantile(const double q) const {
+    if (total_count_ == 0) return 0;
+    const auto rank = std::max<std::uint64_t>(
+        static_cast<std::uint64_t>(std::ceil(std::min(std::max(q, 0.0), 1.0) * total_count_)), 1);
+    std::uint64_t cumulative = 0;
+    for (std::size_t i=0; i<num_buckets; ++i) {
+      cumulative += counts_[i];
+      if (cumulative >= rank) return bucketUpperBound(i);
+    }
+    return max_value;
+  }
+
+  // Largest value in nanoseconds recorded in the bucket.
+  static std::uint64_t bucketUpperBound(const std::size_t bucket) {
+    if (bucket < 2 * sub_buckets) return ((bucket + 1) << unit_bits) - 1;
+    const int shift = bucket / sub_buckets - 1;
+    const std::uint64_t mantissa = bucket - shift * sub_buckets;
+    return ((mantissa + 1) << (shift + unit_bits)) - 1;
+  }
+
+private:
+  std::array<std::uint64_t, num_buckets> counts_;
+  std::uint64_t total_count_;
+
+  // The values in units of the bit length b > sub_bucket_bits + 1 are shifted by
+  // s = b - sub_bucket_bits - 1 so that the leading sub_bucket_bits + 1 bits, i.e.,
+  // the mantissa in [sub_buckets, 2 * sub_buckets), are kept.
+  static std::size_t bucketIndex(const std::uint64_t value) {
+    int shift = 0;
+    while ((value >> shift) >= 2 * sub_buckets) ++shift;
+    return shift * sub_buckets + (value >> shift);
+  }
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__LATENCY_HISTOGRAM_HPP_
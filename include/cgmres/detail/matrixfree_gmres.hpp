@@ -2,6 +2,7 @@
 #define CGMRES__MATRIXFREE_GMRES_HPP_
 
 #include <iostream>
+#include <chrono>
 #include <cmath>
 #include <limits>
 #include <stdexcept>
@@ -9,6 +10,7 @@
 #include "cgmres/types.hpp"
 
 #include "cgmres/detail/macros.hpp"
+#include "cgmres/detail/phase_profiler.hpp"
 
 
 namespace cgmres {
@@ -34,10 +36,85 @@ public:
 
   ~MatrixFreeGMRES() = default;
 
+  using Clock = std::chrono::steady_clock;
+
   template <typename... LinearProblemArgs>
   int solve(LinearProblem& linear_problem, 
             LinearProblemArgs... linear_problem_args, 
             Vector<dim>& linear_problem_solution) {
+    return solve_impl<LinearProblem, LinearProblemArgs...>(nullptr, linear_problem, linear_problem_args..., 
+                                                           linear_problem_solution);
+  }
+
+  ///
+  /// @brief Same as solve() but for another linear problem of the same dimension, 
+  /// e.g., one sharing the operator of LinearProblem, without another workspace.
+  ///
+  template <typename OtherLinearProblem, typename... LinearProblemArgs>
+  int solve_other(OtherLinearProblem& linear_problem, 
+                  LinearProblemArgs... linear_problem_args, 
+                  Vector<dim>& linear_problem_solution) {
+    static_assert(OtherLinearProblem::dim == dim);
+    return solve_impl<OtherLinearProblem, LinearProblemArgs...>(nullptr, linear_problem, linear_problem_args..., 
+                                                                linear_problem_solution);
+  }
+
+  ///
+  /// @brief Same as solve() but stops the Arnoldi process before the next step 
+  /// once the deadline has passed. The solution is then computed from the Krylov 
+  /// subspace built so far.
+  ///
+  template <typename... LinearProblemArgs>
+  int solve_until(const Clock::time_point& deadline, 
+                  LinearProblem& linear_problem, 
+                  LinearProblemArgs... linear_problem_args, 
+                  Vector<dim>& linear_problem_solution) {
+    return solve_impl<LinearProblem, LinearProblemArgs...>(&deadline, linear_problem, linear_problem_args..., 
+                                                           linear_problem_solution);
+  }
+
+  ///
+  /// @brief Returns true if the last solve_until() was stopped by its deadline.
+  ///
+  bool truncated() const { return truncated_; }
+
+  ///
+  /// @brief Returns true if the last solve() or solve_until() broke down by 
+  /// non-finite values in the Krylov subspace. The solution is then computed 
+  /// from the Krylov subspace built before the breakdown.
+  ///
+  bool breakdown() const { return breakdown_; }
+
+  ///
+  /// @brief Timer of the orthogonalization of each Arnoldi step, excluding the 
+  /// operator LinearProblem::eval_Ax(). See CGMRES_ENABLE_PHASE_PROFILING.
+  ///
+  const PhaseTimer& arnoldi_timer() const { return arnoldi_timer_; }
+
+  ///
+  /// @brief Timer of the Givens rotations and the back substitution. 
+  /// See CGMRES_ENABLE_PHASE_PROFILING.
+  ///
+  const PhaseTimer& givens_timer() const { return givens_timer_; }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  Matrix<kmax+1, kmax+1> hessenberg_mat_;
+  Matrix<dim, kmax+1> basis_mat_;
+  Vector<dim> b_vec_;
+  Vector<kmax+1> givens_c_vec_, givens_s_vec_, g_vec_;
+  bool truncated_ = false;
+  bool breakdown_ = false;
+  PhaseTimer arnoldi_timer_, givens_timer_;
+
+  template <typename Problem, typename... LinearProblemArgs>
+  int solve_impl(const Clock::time_point* deadline,
+                 Problem& linear_problem, 
+                 LinearProblemArgs... linear_problem_args, 
+                 Vector<dim>& linear_problem_solution) {
+    truncated_ = false;
+    breakdown_ = false;
     // Initializes vectors for QR factrization by Givens rotation.
     givens_c_vec_.setZero();
     givens_s_vec_.setZero();
@@ -45,67 +122,80 @@ public:
     // Generates the initial basis of the Krylov subspace.
     linear_problem.eval_b(linear_problem_args..., linear_problem_solution, b_vec_);
     g_vec_.coeffRef(0) = b_vec_.template lpNorm<2>();
+    if (!std::isfinite(g_vec_.coeff(0))) {
+      breakdown_ = true;
+      return 0;
+    }
     basis_mat_.col(0) = b_vec_ / g_vec_.coeff(0);
     // k : the dimension of the Krylov subspace at the current iteration.
     int k = 0;
     for (; k<kmax; ++k) {
+      if (deadline && Clock::now() >= *deadline) {
+        truncated_ = true;
+        break;
+      }
       linear_problem.eval_Ax(linear_problem_args..., basis_mat_.col(k), 
                              basis_mat_.col(k+1));
-      for (int j=0; j<=k; ++j) {
-        hessenberg_mat_.coeffRef(k, j) = basis_mat_.col(k+1).dot(basis_mat_.col(j));
-        basis_mat_.col(k+1).noalias() -= hessenberg_mat_.coeff(k, j) * basis_mat_.col(j);
+      {
+        CGMRES_PHASE_PROBE(arnoldi_timer_);
+        for (int j=0; j<=k; ++j) {
+          hessenberg_mat_.coeffRef(k, j) = basis_mat_.col(k+1).dot(basis_mat_.col(j));
+          basis_mat_.col(k+1).noalias() -= hessenberg_mat_.coeff(k, j) * basis_mat_.col(j);
+        }
+        hessenberg_mat_.coeffRef(k, k+1) = basis_mat_.col(k+1).template lpNorm<2>();
+      }
+      if (!std::isfinite(hessenberg_mat_.coeff(k, k+1))) {
+        breakdown_ = true;
+        break;
       }
-      hessenberg_mat_.coeffRef(k, k+1) = basis_mat_.col(k+1).template lpNorm<2>();
       if (std::abs(hessenberg_mat_.coeff(k, k+1)) < std::numeric_limits<double>::epsilon()) {
         break;
       }
       else {
         basis_mat_.col(k+1).array() /= hessenberg_mat_.coeff(k, k+1);
       }
-      // Givens Rotation for QR factrization of the least squares problem.
-      for (int j=0; j<k; ++j) {
-        givensRotation(hessenberg_mat_.row(k), j);
-      }
-      const Scalar nu = std::sqrt(hessenberg_mat_.coeff(k, k)*hessenberg_mat_.coeff(k, k)
-                                  +hessenberg_mat_.coeff(k, k+1)*hessenberg_mat_.coeff(k, k+1));
-      if (nu) {
-        givens_c_vec_.coeffRef(k) = hessenberg_mat_.coeff(k, k) / nu;
-        givens_s_vec_.coeffRef(k) = - hessenberg_mat_.coeff(k, k+1) / nu;
-        hessenberg_mat_.coeffRef(k, k) = givens_c_vec_.coeff(k) * hessenberg_mat_.coeff(k, k) 
-                                          - givens_s_vec_.coeff(k) * hessenberg_mat_.coeff(k, k+1);
-        hessenberg_mat_.coeffRef(k, k+1) = 0.0;
-        givensRotation(g_vec_, k);
-      }
-      else {
-        throw std::runtime_error("Lose orthogonality of the basis of the Krylov subspace");
+      {
+        CGMRES_PHASE_PROBE(givens_timer_);
+        // Givens Rotation for QR factrization of the least squares problem.
+        for (int j=0; j<k; ++j) {
+          givensRotation(hessenberg_mat_.row(k), j);
+        }
+        const Scalar nu = std::sqrt(hessenberg_mat_.coeff(k, k)*hessenberg_mat_.coeff(k, k)
+                                    +hessenberg_mat_.coeff(k, k+1)*hessenberg_mat_.coeff(k, k+1));
+        if (nu) {
+          givens_c_vec_.coeffRef(k) = hessenberg_mat_.coeff(k, k) / nu;
+          givens_s_vec_.coeffRef(k) = - hessenberg_mat_.coeff(k, k+1) / nu;
+          hessenberg_mat_.coeffRef(k, k) = givens_c_vec_.coeff(k) * hessenberg_mat_.coeff(k, k) 
+                                            - givens_s_vec_.coeff(k) * hessenberg_mat_.coeff(k, k+1);
+          hessenberg_mat_.coeffRef(k, k+1) = 0.0;
+          givensRotation(g_vec_, k);
+        }
+        else {
+          throw std::runtime_error("Lose orthogonality of the basis of the Krylov subspace");
+        }
       }
     }
-    // Computes solution_vec by solving hessenberg_mat_ * y = g_vec.
-    for (int i=k-1; i>=0; --i) {
-      Scalar tmp = g_vec_.coeff(i);
-      for (int j=i+1; j<k; ++j) {
-        tmp -= hessenberg_mat_.coeff(j, i) * givens_c_vec_.coeff(j);
+    {
+      CGMRES_PHASE_PROBE(givens_timer_);
+      // Computes solution_vec by solving hessenberg_mat_ * y = g_vec.
+      for (int i=k-1; i>=0; --i) {
+        Scalar tmp = g_vec_.coeff(i);
+        for (int j=i+1; j<k; ++j) {
+          tmp -= hessenberg_mat_.coeff(j, i) * givens_c_vec_.coeff(j);
+        }
+        givens_c_vec_.coeffRef(i) = tmp / hessenberg_mat_.coeff(i, i);
       }
-      givens_c_vec_.coeffRef(i) = tmp / hessenberg_mat_.coeff(i, i);
-    }
-    for (int i=0; i<dim; ++i) {
-      Scalar tmp = 0.0;
-      for (int j=0; j<k; ++j) { 
-        tmp += basis_mat_.coeff(i, j) * givens_c_vec_.coeff(j);
+      for (int i=0; i<dim; ++i) {
+        Scalar tmp = 0.0;
+        for (int j=0; j<k; ++j) { 
+          tmp += basis_mat_.coeff(i, j) * givens_c_vec_.coeff(j);
+        }
+        linear_problem_solution.coeffRef(i) += tmp;
       }
-      linear_problem_solution.coeffRef(i) += tmp;
     }
     return k;
   }
 
-  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
-
-private:
-  Matrix<kmax+1, kmax+1> hessenberg_mat_;
-  Matrix<dim, kmax+1> basis_mat_;
-  Vector<dim> b_vec_;
-  Vector<kmax+1> givens_c_vec_, givens_s_vec_, g_vec_;
-
   template <typename VectorType>
   inline void givensRotation(const MatrixBase<VectorType>& column_vec, 
                              const int i_column) const {
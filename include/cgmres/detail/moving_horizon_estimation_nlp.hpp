@@ -0,0 +1,243 @@
+#ifndef CGMRES__MOVING_HORIZON_ESTIMATION_NLP_HPP_
+#define CGMRES__MOVING_HORIZON_ESTIMATION_NLP_HPP_
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+
+#include "cgmres/types.hpp"
+
+#include "cgmres/detail/macros.hpp"
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Least-squares problem of the moving horizon estimation over a window of
+/// N+1 measurements of the state y_i and the control inputs u_i at the times t_i.
+/// The decision variable z = [x_0; p] is the state at the oldest measurement and np
+/// model parameters of the OCP, i.e., the data members given by the pointers.
+/// The state is predicted by x_{i+1} = x_i + (t_{i+1}-t_i) f(t_i, x_i, u_i; p) and
+/// the residuals are the deviations of x_0 from the arrival state, x_i from y_i, and
+/// p from the parameter prior, weighted by the diagonal weights.
+///
+template <class OCP, int N, int np>
+class MovingHorizonEstimationNLP {
+public:
+  static constexpr int nx = OCP::nx;
+  static constexpr int nu = OCP::nu;
+  static constexpr int nc = OCP::nc;
+  static constexpr int nuc = nu + nc;
+  static constexpr int dim = nx + np;
+
+  using ParameterMembers = std::array<Scalar OCP::*, np>;
+
+  MovingHorizonEstimationNLP(const OCP& ocp, const ParameterMembers& parameters)
+    : ocp_(ocp),
+      parameters_(parameters),
+      arrival_state_(Vector<nx>::Zero()),
+      parameter_prior_(Vector<np>::Zero()),
+      arrival_weight_(Vector<nx>::Ones()),
+      measurement_weight_(Vector<nx>::Ones()),
+      parameter_weight_(Vector<np>::Ones()),
+      dx_(Vector<nx>::Zero()),
+      dx1_(Vector<nx>::Zero()),
+      hx_(Vector<nx>::Zero()) {
+    static_assert(OCP::nx > 0);
+    static_assert(OCP::nu > 0);
+    static_assert(np >= 0);
+    static_assert(N > 0);
+    std::fill(t_.begin(), t_.end(), 0.0);
+    std::fill(y_.begin(), y_.end(), Vector<nx>::Zero());
+    std::fill(u_.begin(), u_.end(), Vector<nuc>::Zero());
+    std::fill(x_.begin(), x_.end(), Vector<nx>::Zero());
+    std::fill(x1_.begin(), x1_.end(), Vector<nx>::Zero());
+    std::fill(lmd_.begin(), lmd_.end(), Vector<nx>::Zero());
+    std::fill(hx0_.begin(), hx0_.end(), Vector<nx>::Zero());
+    std::fill(fp_.begin(), fp_.end(), Matrix<nx, np>::Zero());
+  }
+
+  MovingHorizonEstimationNLP() = default;
+
+  ~MovingHorizonEstimationNLP() = default;
+
+  // Appends a measurement to the window. If the window is full, the oldest one is dropped.
+  template <typename VectorType1, typename VectorType2>
+  void push_measurement(const Scalar t, const MatrixBase<VectorType1>& y,
+                        const MatrixBase<VectorType2>& u) {
+    if (num_measurements_ == N+1) {
+      for (int i=0; i<N; ++i) {
+        t_[i] = t_[i+1];
+        y_[i] = y_[i+1];
+        u_[i] = u_[i+1];
+      }
+      --num_measurements_;
+    }
+    t_[num_measurements_] = t;
+    y_[num_measurements_] = y;
+    u_[num_measurements_].template head<nu>() = u;
+    u_[num_measurements_].template tail<nc>().setZero();
+    ++num_measurements_;
+  }
+
+  void clear_measurements() { num_measurements_ = 0; }
+
+  int num_measurements() const { return num_measurements_; }
+
+  bool full() const { return num_measurements_ == N+1; }
+
+  void set_parameters(OCP& ocp, const Vector<np>& p) const {
+    for (int j=0; j<np; ++j) {
+      ocp.*parameters_[j] = p.coeff(j);
+    }
+  }
+
+  void get_parameters(const OCP& ocp, Vector<np>& p) const {
+    for (int j=0; j<np; ++j) {
+      p.coeffRef(j) = ocp.*parameters_[j];
+    }
+  }
+
+  // Predicts the state over the window and keeps the quantities for the subsequent
+  // eval_fonc() and eval_gauss_newton_product() at z.
+  void rollout(const Vector<dim>& z) {
+    if constexpr (np > 0) {
+      set_parameters(ocp_, z.template tail<np>());
+    }
+    x_[0] = z.template head<nx>();
+    lmd_[0].setZero();
+    for (int i=0; i+1<num_measurements_; ++i) {
+      const Scalar dt = t_[i+1] - t_[i];
+      ocp_.eval_f(t_[i], x_[i].data(), u_[i].data(), dx_.data());
+      x_[i+1] = x_[i] + dt * dx_;
+      // hx at the zero costate, i.e., without f_x^T lmd.
+      ocp_.eval_hx(t_[i], x_[i].data(), u_[i].data(), lmd_[0].data(), hx0_[i].data());
+      if constexpr (np > 0) {
+        for (int j=0; j<np; ++j) {
+          const Scalar pj = ocp_.*parameters_[j];
+          const Scalar eps = parameter_epsilon_ * std::max(1.0, std::abs(pj));
+          ocp_.*parameters_[j] = pj + eps;
+          ocp_.eval_f(t_[i], x_[i].data(), u_[i].data(), dx1_.data());
+          ocp_.*parameters_[j] = pj;
+          fp_[i].col(j) = (dx1_ - dx_) / eps;
+        }
+      }
+    }
+  }
+
+  // Gradient of the least-squares cost at z of the last rollout().
+  void eval_fonc(const Vector<dim>& z, Vector<dim>& fonc) {
+    const int n = num_measurements_ - 1;
+    lmd_[n].array() = measurement_weight_.array() * (x_[n] - y_[n]).array();
+    backward(n);
+    fonc.template head<nx>().array() = arrival_weight_.array() * (x_[0] - arrival_state_).array();
+    fonc.template head<nx>() += lmd_[0];
+    if constexpr (np > 0) {
+      fonc.template tail<np>().array() = parameter_weight_.array() * (z.template tail<np>() - parameter_prior_).array();
+      for (int i=0; i<n; ++i) {
+        fonc.template tail<np>().noalias() += (t_[i+1] - t_[i]) * fp_[i].transpose() * lmd_[i+1];
+      }
+    }
+  }
+
+  // Gauss-Newton approximation of the Hessian of the least-squares cost at the z of 
+  // the last rollout() multiplied by z_dir, i.e., J^T J z_dir with the Jacobian J of
+  // the residuals. The forward sensitivity J z_dir is computed by the finite
+  // difference of the prediction.
+  template <typename VectorType1, typename VectorType2>
+  void eval_gauss_newton_product(const MatrixBase<VectorType1>& z_dir,
+                                 const Scalar finite_difference_epsilon,
+                                 const MatrixBase<VectorType2>& hess_dir) {
+    const int n = num_measurements_ - 1;
+    const Scalar eps = finite_difference_epsilon;
+    x1_[0] = x_[0] + eps * z_dir.template head<nx>();
+    for (int i=0; i<n; ++i) {
+      ocp_.eval_f(t_[i], x1_[i].data(), u_[i].data(), dx1_.data());
+      if constexpr (np > 0) {
+        dx1_.noalias() += eps * fp_[i] * z_dir.template tail<np>();
+      }
+      x1_[i+1] = x1_[i] + (t_[i+1] - t_[i]) * dx1_;
+    }
+    // x1_ holds the forward sensitivity from here.
+    for (int i=0; i<=n; ++i) {
+      x1_[i] = (x1_[i] - x_[i]) / eps;
+    }
+    lmd_[n].array() = measurement_weight_.array() * x1_[n].array();
+    backward(n, x1_);
+    auto& out = CGMRES_EIGEN_CONST_CAST(VectorType2, hess_dir);
+    out.template head<nx>().array() = arrival_weight_.array() * x1_[0].array();
+    out.template head<nx>() += lmd_[0];
+    if constexpr (np > 0) {
+      out.template tail<np>().array() = parameter_weight_.array() * z_dir.template tail<np>().array();
+      for (int i=0; i<n; ++i) {
+        out.template tail<np>().noalias() += (t_[i+1] - t_[i]) * fp_[i].transpose() * lmd_[i+1];
+      }
+    }
+  }
+
+  const std::array<Vector<nx>, N+1>& x() const { return x_; }
+
+  Vector<nx>& arrival_state() { return arrival_state_; }
+
+  const Vector<nx>& arrival_state() const { return arrival_state_; }
+
+  Vector<np>& parameter_prior() { return parameter_prior_; }
+
+  const Vector<np>& parameter_prior() const { return parameter_prior_; }
+
+  Vector<nx>& arrival_weight() { return arrival_weight_; }
+
+  Vector<nx>& measurement_weight() { return measurement_weight_; }
+
+  Vector<np>& parameter_weight() { return parameter_weight_; }
+
+  const OCP& ocp() const { return ocp_; }
+
+  void set_parameter_epsilon(const Scalar parameter_epsilon) { parameter_epsilon_ = parameter_epsilon; }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  OCP ocp_;
+  ParameterMembers parameters_;
+  std::array<Scalar, N+1> t_;
+  std::array<Vector<nx>, N+1> y_;
+  std::array<Vector<nuc>, N+1> u_;
+  std::array<Vector<nx>, N+1> x_, x1_, lmd_, hx0_;
+  std::array<Matrix<nx, np>, N+1> fp_;
+  Vector<nx> arrival_state_;
+  Vector<np> parameter_prior_;
+  Vector<nx> arrival_weight_, measurement_weight_;
+  Vector<np> parameter_weight_;
+  Vector<nx> dx_, dx1_, hx_;
+  Scalar parameter_epsilon_ = 1.0e-08;
+  int num_measurements_ = 0;
+
+  // Backward recursion of the adjoint lmd_i = W (x_i - y_i) + lmd_{i+1} + dt f_x^T lmd_{i+1}
+  // from lmd_n, where f_x^T lmd is given by the difference of eval_hx() of the OCP
+  // since hx is affine in the costate.
+  void backward(const int n) {
+    for (int i=n-1; i>=0; --i) {
+      adjoint_step(i);
+      lmd_[i].array() += measurement_weight_.array() * (x_[i] - y_[i]).array();
+    }
+  }
+
+  void backward(const int n, const std::array<Vector<nx>, N+1>& dx) {
+    for (int i=n-1; i>=0; --i) {
+      adjoint_step(i);
+      lmd_[i].array() += measurement_weight_.array() * dx[i].array();
+    }
+  }
+
+  void adjoint_step(const int i) {
+    ocp_.eval_hx(t_[i], x_[i].data(), u_[i].data(), lmd_[i+1].data(), hx_.data());
+    lmd_[i] = lmd_[i+1] + (t_[i+1] - t_[i]) * (hx_ - hx0_[i]);
+  }
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__MOVING_HORIZON_ESTIMATION_NLP_HPP_
@@ -8,6 +8,8 @@
 
 #include "cgmres/detail/control_input_bounds.hpp"
 #include "cgmres/detail/control_input_bounds_shooting.hpp"
+#include "cgmres/detail/ocp_synchronization.hpp"
+#include "cgmres/detail/ocp_derivatives.hpp"
 
 namespace cgmres {
 namespace detail {
@@ -21,6 +23,7 @@ public:
   static constexpr int nuc = nu + nc;
   static constexpr int nub = OCP::nub;
   static constexpr int dim = nuc * N;
+  static constexpr bool has_jvp = detail::has_jvp<OCP>::value;
 
   MultipleShootingNLP(const OCP& ocp, const Horizon& horizon) 
     : ocp_(ocp),
@@ -30,6 +33,8 @@ public:
     static_assert(OCP::nc >= 0);
     static_assert(OCP::nub >= 0);
     static_assert(N > 0);
+    std::fill(x_dir_.begin(), x_dir_.end(), Vector<nx>::Zero());
+    std::fill(lmd_dir_.begin(), lmd_dir_.end(), Vector<nx>::Zero());
   }
 
   MultipleShootingNLP() = default;
@@ -42,15 +47,16 @@ public:
                     Vector<dim>& fonc_hu) {
     assert(x0.size());
     const Scalar T = horizon_.T(t);
-    const Scalar dt = T / N;
+    const Scalar dt = T / active_N_;
     assert(T >= 0);
     // Compute the erros in the first order necessary conditions (FONC)
     ocp_.eval_hu(t, x0.derived().data(), solution.template head<nuc>().data(), lmd[1].data(), 
                  fonc_hu.template head<nuc>().data());
-    for (size_t i=1; i<N; ++i) {
+    for (int i=1; i<active_N_; ++i) {
       ocp_.eval_hu(t+i*dt, x[i].data(), solution.template segment<nuc>(nuc*i).data(),
                    lmd[i+1].data(), fonc_hu.template segment<nuc>(nuc*i).data());
     }
+    fonc_hu.tail(nuc*(N-active_N_)).setZero();
   }
 
   template <typename VectorType>
@@ -58,15 +64,18 @@ public:
                    const std::array<Vector<nx>, N+1>& x, 
                    std::array<Vector<nx>, N+1>& fonc_f) {
     const Scalar T = horizon_.T(t);
-    const Scalar dt = T / N;
+    const Scalar dt = T / active_N_;
     assert(T >= 0);
     // Compute optimality error for state.
     ocp_.eval_f(t, x0.derived().data(), solution.template head<nuc>().data(), dx_.data());
     fonc_f[0] = x[1] - x0 - dt * dx_;
-    for (size_t i=1; i<N; ++i) {
+    for (int i=1; i<active_N_; ++i) {
       ocp_.eval_f(t+i*dt, x[i].data(), solution.template segment<nuc>(nuc*i).data(), dx_.data());
       fonc_f[i] = x[i+1] - x[i] - dt * dx_;
     }
+    for (int i=active_N_; i<N+1; ++i) {
+      fonc_f[i].setZero();
+    }
   }
 
   template <typename VectorType>
@@ -74,15 +83,18 @@ public:
                  std::array<Vector<nx>, N+1>& x,
                  const std::array<Vector<nx>, N+1>& fonc_f) {
     const Scalar T = horizon_.T(t);
-    const Scalar dt = T / N;
+    const Scalar dt = T / active_N_;
     assert(T >= 0);
     // Compute optimality error for state.
     ocp_.eval_f(t, x0.derived().data(), solution.template head<nuc>().data(), dx_.data());
     x[1] = x0 + dt * dx_  + fonc_f[0];
-    for (size_t i=1; i<N; ++i) {
+    for (int i=1; i<active_N_; ++i) {
       ocp_.eval_f(t+i*dt, x[i].data(), solution.template segment<nuc>(nuc*i).data(), dx_.data());
       x[i+1] = x[i] + dt * dx_ + fonc_f[i];
     }
+    for (int i=active_N_+1; i<N+1; ++i) {
+      x[i].setZero();
+    }
   }
 
   template <typename VectorType>
@@ -90,16 +102,19 @@ public:
                     const std::array<Vector<nx>, N+1>& x, const std::array<Vector<nx>, N+1>& lmd,
                     std::array<Vector<nx>, N+1>& fonc_hx) {
     const Scalar T = horizon_.T(t);
-    const Scalar dt = T / N;
+    const Scalar dt = T / active_N_;
     assert(T >= 0);
     // Compute optimality error for lambda.
-    ocp_.eval_phix(t+T, x[N].data(), dx_.data());
-    fonc_hx[N] = lmd[N] - dx_;
-    for (size_t i=N-1; i>=1; --i) {
+    ocp_.eval_phix(t+T, x[active_N_].data(), dx_.data());
+    fonc_hx[active_N_] = lmd[active_N_] - dx_;
+    for (int i=active_N_-1; i>=1; --i) {
       ocp_.eval_hx(t+i*dt, x[i].data(), solution.template segment<nuc>(nuc*i).data(), 
                    lmd[i+1].data(), dx_.data());
       fonc_hx[i] = lmd[i] - lmd[i+1] - dt * dx_;
     }
+    for (int i=active_N_+1; i<N+1; ++i) {
+      fonc_hx[i].setZero();
+    }
   }
 
   template <typename VectorType>
@@ -107,56 +122,109 @@ public:
                    const std::array<Vector<nx>, N+1>& x, std::array<Vector<nx>, N+1>& lmd,
                    const std::array<Vector<nx>, N+1>& fonc_hx) {
     const Scalar T = horizon_.T(t);
-    const Scalar dt = T / N;
+    const Scalar dt = T / active_N_;
     assert(T >= 0);
     // Compute optimality error for state.
-    ocp_.eval_phix(t+T, x[N].data(), dx_.data());
-    lmd[N] = dx_ + fonc_hx[N];
-    for (size_t i=N-1; i>=1; --i) {
+    ocp_.eval_phix(t+T, x[active_N_].data(), dx_.data());
+    lmd[active_N_] = dx_ + fonc_hx[active_N_];
+    for (int i=active_N_-1; i>=1; --i) {
       ocp_.eval_hx(t+i*dt, x[i].data(), solution.template segment<nuc>(nuc*i).data(), 
                    lmd[i+1].data(), dx_.data());
       lmd[i] = lmd[i+1] + dt * dx_ + fonc_hx[i];
     }
+    for (int i=active_N_+1; i<N+1; ++i) {
+      lmd[i].setZero();
+    }
+  }
+
+  // Directional derivative of eval_fonc_hu() along solution_dir, where the state and costate 
+  // are the functions of the solution given by retrieve_x() and retrieve_lmd() and are 
+  // linearized around x and lmd. Requires the JVPs of the OCP, i.e., has_jvp.
+  template <typename VectorType1, typename VectorType2>
+  void eval_fonc_hu_jvp(const Scalar t, const MatrixBase<VectorType1>& x0, const Vector<dim>& solution,
+                        const std::array<Vector<nx>, N+1>& x, const std::array<Vector<nx>, N+1>& lmd,
+                        const MatrixBase<VectorType2>& solution_dir, Vector<dim>& fonc_hu_jvp) {
+    static_assert(has_jvp, "OCP must provide eval_f_jvp(), eval_phix_jvp(), eval_hx_jvp(), and eval_hu_jvp()");
+    const Scalar T = horizon_.T(t);
+    const Scalar dt = T / active_N_;
+    assert(T >= 0);
+    const auto& u_dir = solution_dir.derived();
+    // Forward sensitivity of the state.
+    x_dir_[0].setZero();
+    ocp_.eval_f_jvp(t, x0.derived().data(), solution.template head<nuc>().data(), 
+                    x_dir_[0].data(), u_dir.template head<nuc>().data(), dx_.data());
+    x_dir_[1] = dt * dx_;
+    for (int i=1; i<active_N_; ++i) {
+      ocp_.eval_f_jvp(t+i*dt, x[i].data(), solution.template segment<nuc>(nuc*i).data(), 
+                      x_dir_[i].data(), u_dir.template segment<nuc>(nuc*i).data(), dx_.data());
+      x_dir_[i+1] = x_dir_[i] + dt * dx_;
+    }
+    // Backward sensitivity of the costate.
+    ocp_.eval_phix_jvp(t+T, x[active_N_].data(), x_dir_[active_N_].data(), lmd_dir_[active_N_].data());
+    for (int i=active_N_-1; i>=1; --i) {
+      ocp_.eval_hx_jvp(t+i*dt, x[i].data(), solution.template segment<nuc>(nuc*i).data(), 
+                       lmd[i+1].data(), x_dir_[i].data(), u_dir.template segment<nuc>(nuc*i).data(),
+                       lmd_dir_[i+1].data(), dx_.data());
+      lmd_dir_[i] = lmd_dir_[i+1] + dt * dx_;
+    }
+    ocp_.eval_hu_jvp(t, x0.derived().data(), solution.template head<nuc>().data(), lmd[1].data(), 
+                     x_dir_[0].data(), u_dir.template head<nuc>().data(), lmd_dir_[1].data(),
+                     fonc_hu_jvp.template head<nuc>().data());
+    for (int i=1; i<active_N_; ++i) {
+      ocp_.eval_hu_jvp(t+i*dt, x[i].data(), solution.template segment<nuc>(nuc*i).data(),
+                       lmd[i+1].data(), x_dir_[i].data(), u_dir.template segment<nuc>(nuc*i).data(),
+                       lmd_dir_[i+1].data(), fonc_hu_jvp.template segment<nuc>(nuc*i).data());
+    }
+    fonc_hu_jvp.tail(nuc*(N-active_N_)).setZero();
+  }
+
+  template <typename VectorType>
+  void eval_fonc_hu_jvp(const Vector<dim>& solution,
+                        const std::array<Vector<nub>, N>& mu,
+                        const MatrixBase<VectorType>& solution_dir,
+                        const std::array<Vector<nub>, N>& mu_dir,
+                        Vector<dim>& fonc_hu_jvp) const {
+    ubounds::eval_fonc_hu_jvp<OCP, N>(ocp_, solution, mu, solution_dir, mu_dir, fonc_hu_jvp, active_N_);
   }
 
   void eval_fonc_hu(const Vector<dim>& solution,
                     const std::array<Vector<nub>, N>& dummy, 
                     const std::array<Vector<nub>, N>& mu,
                     Vector<dim>& fonc_hu) const {
-    ubounds::eval_fonc_hu<OCP, N>(ocp_, solution, dummy, mu, fonc_hu);
+    ubounds::eval_fonc_hu<OCP, N>(ocp_, solution, dummy, mu, fonc_hu, active_N_);
   }
 
   void eval_fonc_hdummy(const Vector<dim>& solution,
                         const std::array<Vector<nub>, N>& dummy, 
                         const std::array<Vector<nub>, N>& mu,
                         std::array<Vector<nub>, N>& fonc_hdummy) const {
-    ubounds::eval_fonc_hdummy<OCP, N>(ocp_, solution, dummy, mu, fonc_hdummy);
+    ubounds::eval_fonc_hdummy<OCP, N>(ocp_, solution, dummy, mu, fonc_hdummy, active_N_);
   }
 
   void eval_fonc_hmu(const Vector<dim>& solution,
                      const std::array<Vector<nub>, N>& dummy, 
                      const std::array<Vector<nub>, N>& mu,
                      std::array<Vector<nub>, N>& fonc_hmu) const {
-    ubounds::eval_fonc_hmu<OCP, N>(ocp_, solution, dummy, mu, fonc_hmu);
+    ubounds::eval_fonc_hmu<OCP, N>(ocp_, solution, dummy, mu, fonc_hmu, active_N_);
   }
 
-  static void multiply_hdummy_inv(const std::array<Vector<nub>, N>& dummy, 
-                                  const std::array<Vector<nub>, N>& mu,
-                                  const std::array<Vector<nub>, N>& fonc_hdummy,
-                                  const std::array<Vector<nub>, N>& fonc_hmu,
-                                  std::array<Vector<nub>, N>& fonc_hdummy_inv) {
+  void multiply_hdummy_inv(const std::array<Vector<nub>, N>& dummy, 
+                           const std::array<Vector<nub>, N>& mu,
+                           const std::array<Vector<nub>, N>& fonc_hdummy,
+                           const std::array<Vector<nub>, N>& fonc_hmu,
+                           std::array<Vector<nub>, N>& fonc_hdummy_inv) const {
     ubounds::multiply_hdummy_inv<OCP, N>(dummy, mu, fonc_hdummy, fonc_hmu,
-                                         fonc_hdummy_inv);
+                                         fonc_hdummy_inv, active_N_);
   }
 
-  static void multiply_hmu_inv(const std::array<Vector<nub>, N>& dummy, 
-                               const std::array<Vector<nub>, N>& mu,
-                               const std::array<Vector<nub>, N>& fonc_hdummy,
-                               const std::array<Vector<nub>, N>& fonc_hmu,
-                               const std::array<Vector<nub>, N>& fonc_hdummy_inv,
-                               std::array<Vector<nub>, N>& fonc_hmu_inv) {
+  void multiply_hmu_inv(const std::array<Vector<nub>, N>& dummy, 
+                        const std::array<Vector<nub>, N>& mu,
+                        const std::array<Vector<nub>, N>& fonc_hdummy,
+                        const std::array<Vector<nub>, N>& fonc_hmu,
+                        const std::array<Vector<nub>, N>& fonc_hdummy_inv,
+                        std::array<Vector<nub>, N>& fonc_hmu_inv) const {
     ubounds::multiply_hmu_inv<OCP, N>(dummy, mu, fonc_hdummy, fonc_hmu,
-                                      fonc_hdummy_inv, fonc_hmu_inv);
+                                      fonc_hdummy_inv, fonc_hmu_inv, active_N_);
   }
 
   void retrieve_dummy_update(const Vector<OCP::nuc*N>& solution,
@@ -164,7 +232,7 @@ public:
                             const std::array<Vector<OCP::nub>, N>& mu,
                             const Vector<OCP::nuc*N>& solution_update,
                             std::array<Vector<OCP::nub>, N>& dummy_update) {
-    ubounds::retrieve_dummy_update<OCP, N>(ocp_, solution, dummy, mu, solution_update, dummy_update);
+    ubounds::retrieve_dummy_update<OCP, N>(ocp_, solution, dummy, mu, solution_update, dummy_update, active_N_);
   }
 
   void retrieve_mu_update(const Vector<OCP::nuc*N>& solution,
@@ -172,14 +240,34 @@ public:
                          const std::array<Vector<OCP::nub>, N>& mu,
                          const Vector<OCP::nuc*N>& solution_update,
                          std::array<Vector<OCP::nub>, N>& mu_update) {
-    ubounds::retrieve_mu_update<OCP, N>(ocp_, solution, dummy, mu, solution_update, mu_update);
+    ubounds::retrieve_mu_update<OCP, N>(ocp_, solution, dummy, mu, solution_update, mu_update, active_N_);
   }
 
   void clip_dummy(std::array<Vector<OCP::nub>, N>& dummy, const Scalar min) {
-    ubounds::clip_dummy<OCP, N>(dummy, min);
+    ubounds::clip_dummy<OCP, N>(dummy, min, active_N_);
   }
 
-  void synchronize_ocp() { ocp_.synchronize(); }
+  ///
+  /// @brief Sets the number of the active discretization grids. The grids from 
+  /// active_N are not evaluated and the corresponding outputs are set to zero.
+  /// @param[in] active_N Number of the active grids. Must be in [1, N].
+  ///
+  void set_active_N(const int active_N) {
+    assert(active_N > 0);
+    assert(active_N <= N);
+    active_N_ = active_N;
+  }
+
+  int active_N() const { return active_N_; }
+
+  void synchronize_ocp() { detail::synchronize_ocp(ocp_, ocp_epoch_); }
+
+  bool ocp_parameters_changed() const { return detail::ocp_parameters_changed(ocp_, ocp_epoch_); }
+
+  ///
+  /// @brief Replaces the OCP. The epoch of the last synchronization is kept.
+  ///
+  void set_ocp(const OCP& ocp) { ocp_ = ocp; }
 
   const OCP& ocp() const { return ocp_; }
 
@@ -189,8 +277,11 @@ public:
 
 private:
   OCP ocp_;
+  unsigned long ocp_epoch_ = kUnsynchronizedEpoch;
   Horizon horizon_;
   Vector<nx> dx_;
+  std::array<Vector<nx>, N+1> x_dir_, lmd_dir_;
+  int active_N_ = N;
 };
 
 } // namespace detail
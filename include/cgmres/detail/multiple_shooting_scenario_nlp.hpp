@@ -0,0 +1,319 @@
+#ifndef CGMRES__MULTIPLE_SHOOTING_SCENARIO_NLP_HPP_
+#define CGMRES__MULTIPLE_SHOOTING_SCENARIO_NLP_HPP_
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+
+#include "cgmres/types.hpp"
+#include "cgmres/horizon.hpp"
+#include "cgmres/scenario_ocp.hpp"
+
+#include "cgmres/detail/control_input_bounds.hpp"
+#include "cgmres/detail/control_input_bounds_shooting.hpp"
+#include "cgmres/detail/multiple_shooting_nlp.hpp"
+#include "cgmres/detail/thread_pool.hpp"
+#include "cgmres/detail/ocp_synchronization.hpp"
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Multiple-shooting NLP of the multi-scenario OCP ScenarioOCP<OCP, S>.
+/// The S state and costate trajectories are stacked. The first-stage control input
+/// of the first scenario is shared by all scenarios: its FONC is the weighted sum of
+/// those of the scenarios and the first-stage blocks of the other scenarios are
+/// kept equal to it by the weighted residuals of their differences. The scenarios
+/// are evaluated on a worker pool if ScenarioOCP::num_threads > 1.
+///
+template <class OCP, int N, int S>
+class MultipleShootingScenarioNLP {
+public:
+  using ScenarioOCP_ = ScenarioOCP<OCP, S>;
+  static constexpr int nxs = OCP::nx;
+  static constexpr int nucs = OCP::nuc;
+  static constexpr int nubs = OCP::nub;
+  static constexpr int nx = ScenarioOCP_::nx;
+  static constexpr int nu = ScenarioOCP_::nu;
+  static constexpr int nc = ScenarioOCP_::nc;
+  static constexpr int nuc = nu + nc;
+  static constexpr int nub = ScenarioOCP_::nub;
+  static constexpr int dim = nuc * N;
+  // The continuation operators use the finite-difference approximation, i.e., the
+  // JVPs of the scenarios are not used.
+  static constexpr bool has_jvp = false;
+  // Weight of the residuals of the first-stage blocks of the other scenarios. No other
+  // FONC depends on these blocks, so that the truncated GMRES otherwise leaves their
+  // residuals unresolved and the blocks drift apart from the shared control input.
+  static constexpr Scalar consensus_weight = 1.0e+04;
+
+  MultipleShootingScenarioNLP(const ScenarioOCP_& ocp, const Horizon& horizon)
+    : ocp_(ocp),
+      horizon_(horizon),
+      thread_pool_() {
+    static_assert(OCP::nx > 0);
+    static_assert(OCP::nu > 0);
+    static_assert(OCP::nc >= 0);
+    static_assert(OCP::nub >= 0);
+    static_assert(N > 0);
+    static_assert(S > 0);
+    std::fill(dx_.begin(), dx_.end(), Vector<nxs>::Zero());
+    std::fill(hu0_.begin(), hu0_.end(), Vector<nucs>::Zero());
+    if (ocp.num_threads > 1) {
+      thread_pool_ = std::make_shared<ThreadPool>(std::min(ocp.num_threads, S));
+    }
+  }
+
+  MultipleShootingScenarioNLP() = default;
+
+  ~MultipleShootingScenarioNLP() = default;
+
+  template <typename VectorType>
+  void eval_fonc_hu(const Scalar t, const MatrixBase<VectorType>& x0, const Vector<dim>& solution,
+                    const std::array<Vector<nx>, N+1>& x, const std::array<Vector<nx>, N+1>& lmd,
+                    Vector<dim>& fonc_hu) {
+    assert(x0.size());
+    const Scalar T = horizon_.T(t);
+    const Scalar dt = T / N;
+    assert(T >= 0);
+    // Compute the erros in the first order necessary conditions (FONC)
+    parallel_for_scenarios([&](const int s) {
+      const OCP& ocp = ocp_.scenarios[s];
+      ocp.eval_hu(t, x0.derived().data()+s*nxs, solution.data(), lmd[1].data()+s*nxs,
+                  hu0_[s].data());
+      for (size_t i=1; i<N; ++i) {
+        ocp.eval_hu(t+i*dt, x[i].data()+s*nxs, solution.data()+nuc*i+nucs*s,
+                    lmd[i+1].data()+s*nxs, fonc_hu.data()+nuc*i+nucs*s);
+      }
+    });
+    // the shared first-stage control input
+    fonc_hu.template head<nucs>() = ocp_.weights[0] * hu0_[0];
+    for (size_t s=1; s<S; ++s) {
+      fonc_hu.template head<nucs>().noalias() += ocp_.weights[s] * hu0_[s];
+      fonc_hu.template segment<nucs>(nucs*s) = consensus_weight * (solution.template segment<nucs>(nucs*s)
+                                                                   - solution.template head<nucs>());
+    }
+  }
+
+  template <typename VectorType>
+  void eval_fonc_f(const Scalar t, const MatrixBase<VectorType>& x0, const Vector<dim>& solution,
+                   const std::array<Vector<nx>, N+1>& x,
+                   std::array<Vector<nx>, N+1>& fonc_f) {
+    const Scalar T = horizon_.T(t);
+    const Scalar dt = T / N;
+    assert(T >= 0);
+    // Compute optimality error for state.
+    parallel_for_scenarios([&](const int s) {
+      const OCP& ocp = ocp_.scenarios[s];
+      ocp.eval_f(t, x0.derived().data()+s*nxs, solution.data(), dx_[s].data());
+      fonc_f[0].template segment<nxs>(s*nxs) = x[1].template segment<nxs>(s*nxs)
+                                                - x0.template segment<nxs>(s*nxs) - dt * dx_[s];
+      for (size_t i=1; i<N; ++i) {
+        ocp.eval_f(t+i*dt, x[i].data()+s*nxs, solution.data()+nuc*i+nucs*s, dx_[s].data());
+        fonc_f[i].template segment<nxs>(s*nxs) = x[i+1].template segment<nxs>(s*nxs)
+                                                  - x[i].template segment<nxs>(s*nxs) - dt * dx_[s];
+      }
+    });
+  }
+
+  template <typename VectorType>
+  void retrieve_x(const Scalar t, const MatrixBase<VectorType>& x0, const Vector<dim>& solution,
+                 std::array<Vector<nx>, N+1>& x,
+                 const std::array<Vector<nx>, N+1>& fonc_f) {
+    const Scalar T = horizon_.T(t);
+    const Scalar dt = T / N;
+    assert(T >= 0);
+    // Compute optimality error for state.
+    parallel_for_scenarios([&](const int s) {
+      const OCP& ocp = ocp_.scenarios[s];
+      ocp.eval_f(t, x0.derived().data()+s*nxs, solution.data(), dx_[s].data());
+      x[1].template segment<nxs>(s*nxs) = x0.template segment<nxs>(s*nxs) + dt * dx_[s]
+                                            + fonc_f[0].template segment<nxs>(s*nxs);
+      for (size_t i=1; i<N; ++i) {
+        ocp.eval_f(t+i*dt, x[i].data()+s*nxs, solution.data()+nuc*i+nucs*s, dx_[s].data());
+        x[i+1].template segment<nxs>(s*nxs) = x[i].template segment<nxs>(s*nxs) + dt * dx_[s]
+                                                + fonc_f[i].template segment<nxs>(s*nxs);
+      }
+    });
+  }
+
+  template <typename VectorType>
+  void eval_fonc_hx(const Scalar t, const MatrixBase<VectorType>& x0, const Vector<dim>& solution,
+                    const std::array<Vector<nx>, N+1>& x, const std::array<Vector<nx>, N+1>& lmd,
+                    std::array<Vector<nx>, N+1>& fonc_hx) {
+    const Scalar T = horizon_.T(t);
+    const Scalar dt = T / N;
+    assert(T >= 0);
+    // Compute optimality error for lambda.
+    parallel_for_scenarios([&](const int s) {
+      const OCP& ocp = ocp_.scenarios[s];
+      ocp.eval_phix(t+T, x[N].data()+s*nxs, dx_[s].data());
+      fonc_hx[N].template segment<nxs>(s*nxs) = lmd[N].template segment<nxs>(s*nxs) - dx_[s];
+      for (size_t i=N-1; i>=1; --i) {
+        ocp.eval_hx(t+i*dt, x[i].data()+s*nxs, solution.data()+nuc*i+nucs*s,
+                    lmd[i+1].data()+s*nxs, dx_[s].data());
+        fonc_hx[i].template segment<nxs>(s*nxs) = lmd[i].template segment<nxs>(s*nxs)
+                                                   - lmd[i+1].template segment<nxs>(s*nxs) - dt * dx_[s];
+      }
+    });
+  }
+
+  template <typename VectorType>
+  void retrieve_lmd(const Scalar t, const MatrixBase<VectorType>& x0, const Vector<dim>& solution,
+                   const std::array<Vector<nx>, N+1>& x, std::array<Vector<nx>, N+1>& lmd,
+                   const std::array<Vector<nx>, N+1>& fonc_hx) {
+    const Scalar T = horizon_.T(t);
+    const Scalar dt = T / N;
+    assert(T >= 0);
+    // Compute optimality error for state.
+    parallel_for_scenarios([&](const int s) {
+      const OCP& ocp = ocp_.scenarios[s];
+      ocp.eval_phix(t+T, x[N].data()+s*nxs, dx_[s].data());
+      lmd[N].template segment<nxs>(s*nxs) = dx_[s] + fonc_hx[N].template segment<nxs>(s*nxs);
+      for (size_t i=N-1; i>=1; --i) {
+        ocp.eval_hx(t+i*dt, x[i].data()+s*nxs, solution.data()+nuc*i+nucs*s,
+                    lmd[i+1].data()+s*nxs, dx_[s].data());
+        lmd[i].template segment<nxs>(s*nxs) = lmd[i+1].template segment<nxs>(s*nxs) + dt * dx_[s]
+                                                + fonc_hx[i].template segment<nxs>(s*nxs);
+      }
+    });
+  }
+
+  void eval_fonc_hu(const Vector<dim>& solution,
+                    const std::array<Vector<nub>, N>& dummy,
+                    const std::array<Vector<nub>, N>& mu,
+                    Vector<dim>& fonc_hu) const {
+    if constexpr (nubs > 0) {
+      // The bounds on the shared first-stage control input are counted once.
+      ubounds::eval_hu(ocp_.scenarios[0], solution.template head<nucs>(),
+                       dummy[0].template head<nubs>(), mu[0].template head<nubs>(),
+                       fonc_hu.template head<nucs>());
+      for (size_t i=1; i<N; ++i) {
+        for (size_t s=0; s<S; ++s) {
+          ubounds::eval_hu(ocp_.scenarios[s], solution.template segment<nucs>(nuc*i+nucs*s),
+                           dummy[i].template segment<nubs>(nubs*s), mu[i].template segment<nubs>(nubs*s),
+                           fonc_hu.template segment<nucs>(nuc*i+nucs*s));
+        }
+      }
+    }
+  }
+
+  void eval_fonc_hdummy(const Vector<dim>& solution,
+                        const std::array<Vector<nub>, N>& dummy,
+                        const std::array<Vector<nub>, N>& mu,
+                        std::array<Vector<nub>, N>& fonc_hdummy) const {
+    ubounds::eval_fonc_hdummy<ScenarioOCP_, N>(ocp_, solution, dummy, mu, fonc_hdummy);
+  }
+
+  void eval_fonc_hmu(const Vector<dim>& solution,
+                     const std::array<Vector<nub>, N>& dummy,
+                     const std::array<Vector<nub>, N>& mu,
+                     std::array<Vector<nub>, N>& fonc_hmu) const {
+    ubounds::eval_fonc_hmu<ScenarioOCP_, N>(ocp_, solution, dummy, mu, fonc_hmu);
+  }
+
+  static void multiply_hdummy_inv(const std::array<Vector<nub>, N>& dummy,
+                                  const std::array<Vector<nub>, N>& mu,
+                                  const std::array<Vector<nub>, N>& fonc_hdummy,
+                                  const std::array<Vector<nub>, N>& fonc_hmu,
+                                  std::array<Vector<nub>, N>& fonc_hdummy_inv) {
+    ubounds::multiply_hdummy_inv<ScenarioOCP_, N>(dummy, mu, fonc_hdummy, fonc_hmu,
+                                                  fonc_hdummy_inv);
+  }
+
+  static void multiply_hmu_inv(const std::array<Vector<nub>, N>& dummy,
+                               const std::array<Vector<nub>, N>& mu,
+                               const std::array<Vector<nub>, N>& fonc_hdummy,
+                               const std::array<Vector<nub>, N>& fonc_hmu,
+                               const std::array<Vector<nub>, N>& fonc_hdummy_inv,
+                               std::array<Vector<nub>, N>& fonc_hmu_inv) {
+    ubounds::multiply_hmu_inv<ScenarioOCP_, N>(dummy, mu, fonc_hdummy, fonc_hmu,
+                                               fonc_hdummy_inv, fonc_hmu_inv);
+  }
+
+  void retrieve_dummy_update(const Vector<dim>& solution,
+                            const std::array<Vector<nub>, N>& dummy,
+                            const std::array<Vector<nub>, N>& mu,
+                            const Vector<dim>& solution_update,
+                            std::array<Vector<nub>, N>& dummy_update) {
+    ubounds::retrieve_dummy_update<ScenarioOCP_, N>(ocp_, solution, dummy, mu, solution_update, dummy_update);
+  }
+
+  void retrieve_mu_update(const Vector<dim>& solution,
+                         const std::array<Vector<nub>, N>& dummy,
+                         const std::array<Vector<nub>, N>& mu,
+                         const Vector<dim>& solution_update,
+                         std::array<Vector<nub>, N>& mu_update) {
+    ubounds::retrieve_mu_update<ScenarioOCP_, N>(ocp_, solution, dummy, mu, solution_update, mu_update);
+  }
+
+  void clip_dummy(std::array<Vector<nub>, N>& dummy, const Scalar min) {
+    ubounds::clip_dummy<ScenarioOCP_, N>(dummy, min);
+  }
+
+  void set_active_N(const int active_N) {
+    if (active_N != N) {
+      throw std::invalid_argument("[MultipleShootingScenarioNLP::set_active_N] the scenario NLP supports only active_N = N");
+    }
+  }
+
+  int active_N() const { return N; }
+
+  void synchronize_ocp() { detail::synchronize_ocp(ocp_, ocp_epoch_); }
+
+  bool ocp_parameters_changed() const { return detail::ocp_parameters_changed(ocp_, ocp_epoch_); }
+
+  ///
+  /// @brief Replaces the OCP. The epoch of the last synchronization is kept.
+  ///
+  void set_ocp(const ScenarioOCP_& ocp) { ocp_ = ocp; }
+
+  const ScenarioOCP_& ocp() const { return ocp_; }
+
+  const Horizon& horizon() const { return horizon_; }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  ScenarioOCP_ ocp_;
+  unsigned long ocp_epoch_ = kUnsynchronizedEpoch;
+  Horizon horizon_;
+  std::array<Vector<nxs>, S> dx_;
+  std::array<Vector<nucs>, S> hu0_;
+  std::shared_ptr<ThreadPool> thread_pool_;
+
+  template <typename Function>
+  void parallel_for_scenarios(const Function& func) {
+    if (thread_pool_) {
+      thread_pool_->parallel_for(S, func);
+    }
+    else {
+      for (int s=0; s<S; ++s) {
+        func(s);
+      }
+    }
+  }
+};
+
+///
+/// @brief MultipleShootingNLP of the multi-scenario OCP. This specialization lets
+/// MultipleShootingCGMRESSolver<ScenarioOCP<OCP, S>, N, kmax> solve the scenario-tree
+/// problem with the condensing and GMRES of the nominal solver.
+///
+template <class OCP, int S, int N>
+class MultipleShootingNLP<ScenarioOCP<OCP, S>, N>
+  : public MultipleShootingScenarioNLP<OCP, N, S> {
+public:
+  using MultipleShootingScenarioNLP<OCP, N, S>::MultipleShootingScenarioNLP;
+
+  MultipleShootingNLP() = default;
+
+  ~MultipleShootingNLP() = default;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__MULTIPLE_SHOOTING_SCENARIO_NLP_HPP_
@@ -40,6 +40,15 @@ public:
     nlp_.eval_fonc_hu(t, x, solution, fonc_);
   }
 
+  template <typename VectorType>
+  void eval_fonc_jacobian(const Scalar t, const MatrixBase<VectorType>& x, const Vector<dim>& solution,
+                          Matrix<dim, dim>& jac) {
+    nlp_.eval_fonc_hu(t, x, solution, fonc_);
+    nlp_.eval_fonc_hu_jacobian(t, x, solution, jac);
+  }
+
+  const Vector<dim>& fonc() const { return fonc_; }
+
   template <typename VectorType1, typename VectorType2, typename VectorType3, typename VectorType4>
   void eval_b(const Scalar t, const MatrixBase<VectorType1>& x, 
               const MatrixBase<VectorType2>& solution, 
@@ -85,6 +94,20 @@ public:
 
   void synchronize_ocp() { nlp_.synchronize_ocp(); }
 
+  static constexpr int state_dim = dim + NLP::state_dim;
+
+  template <typename StateWriter>
+  void save_state(StateWriter& writer) const {
+    writer.write(fonc_);
+    nlp_.save_state(writer);
+  }
+
+  template <typename StateReader>
+  void load_state(StateReader& reader) {
+    reader.read(fonc_);
+    nlp_.load_state(reader);
+  }
+
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 private:
@@ -0,0 +1,66 @@
+#ifndef CGMRES__OCP_DERIVATIVES_HPP_
+#define CGMRES__OCP_DERIVATIVES_HPP_
+
+#include <type_traits>
+#include <utility>
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Checks if the OCP provides the Hessian of the Hamiltonian with respect to
+/// the control input, i.e., `eval_huu(t, x, u, lmd, huu)` generated by AutoGenU.
+///
+template <class OCP, class = void>
+struct has_eval_huu : std::false_type {};
+
+template <class OCP>
+struct has_eval_huu<OCP, std::void_t<decltype(std::declval<const OCP&>().eval_huu(
+    std::declval<double>(), std::declval<const double*>(), std::declval<const double*>(),
+    std::declval<const double*>(), std::declval<double*>()))>>
+  : std::true_type {};
+
+///
+/// @brief Checks if the OCP provides the Jacobian of hu with respect to the state,
+/// i.e., `eval_hux(t, x, u, lmd, hux)` generated by AutoGenU.
+///
+template <class OCP, class = void>
+struct has_eval_hux : std::false_type {};
+
+template <class OCP>
+struct has_eval_hux<OCP, std::void_t<decltype(std::declval<const OCP&>().eval_hux(
+    std::declval<double>(), std::declval<const double*>(), std::declval<const double*>(),
+    std::declval<const double*>(), std::declval<double*>()))>>
+  : std::true_type {};
+
+///
+/// @brief Checks if the OCP provides the directional derivatives (Jacobian-vector 
+/// products) `eval_f_jvp()`, `eval_phix_jvp()`, `eval_hx_jvp()`, and `eval_hu_jvp()` 
+/// generated by AutoGenU.
+///
+template <class OCP, class = void>
+struct has_jvp : std::false_type {};
+
+template <class OCP>
+struct has_jvp<OCP, std::void_t<
+    decltype(std::declval<const OCP&>().eval_f_jvp(
+        std::declval<double>(), std::declval<const double*>(), std::declval<const double*>(),
+        std::declval<const double*>(), std::declval<const double*>(), std::declval<double*>())),
+    decltype(std::declval<const OCP&>().eval_phix_jvp(
+        std::declval<double>(), std::declval<const double*>(), std::declval<const double*>(),
+        std::declval<double*>())),
+    decltype(std::declval<const OCP&>().eval_hx_jvp(
+        std::declval<double>(), std::declval<const double*>(), std::declval<const double*>(),
+        std::declval<const double*>(), std::declval<const double*>(), std::declval<const double*>(),
+        std::declval<const double*>(), std::declval<double*>())),
+    decltype(std::declval<const OCP&>().eval_hu_jvp(
+        std::declval<double>(), std::declval<const double*>(), std::declval<const double*>(),
+        std::declval<const double*>(), std::declval<const double*>(), std::declval<const double*>(),
+        std::declval<const double*>(), std::declval<double*>()))>>
+  : std::true_type {};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__OCP_DERIVATIVES_HPP_
@@ -0,0 +1,64 @@
+#ifndef CGMRES__OCP_SYNCHRONIZATION_HPP_
+#define CGMRES__OCP_SYNCHRONIZATION_HPP_
+
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+
+namespace cgmres {
+namespace detail {
+
+template <class OCP, class = void>
+struct has_parameter_epoch : std::false_type {};
+
+template <class OCP>
+struct has_parameter_epoch<OCP, std::void_t<decltype(std::declval<const OCP&>().parameter_epoch())>> 
+  : std::true_type {};
+
+///
+/// @brief Epoch that means the OCP has not been synchronized yet.
+///
+constexpr unsigned long kUnsynchronizedEpoch = std::numeric_limits<unsigned long>::max();
+
+///
+/// @brief Synchronizes the OCP with its external references. If the OCP has 
+/// `parameter_epoch()`, the synchronization is skipped while the epoch is unchanged.
+/// @param[in, out] ocp The OCP.
+/// @param[in, out] epoch The epoch of the last synchronization.
+///
+template <class OCP>
+void synchronize_ocp(OCP& ocp, unsigned long& epoch) {
+  if constexpr (has_parameter_epoch<OCP>::value) {
+    const unsigned long current_epoch = ocp.parameter_epoch();
+    if (current_epoch == epoch) return;
+    ocp.synchronize();
+    epoch = current_epoch;
+  }
+  else {
+    ocp.synchronize();
+  }
+}
+
+///
+/// @brief Checks if the parameters of the OCP have been changed since the last 
+/// synchronization, i.e., if the epoch of the OCP has changed. Always false if 
+/// the OCP does not have `parameter_epoch()` since the change cannot be detected.
+/// @param[in] ocp The OCP.
+/// @param[in] epoch The epoch of the last synchronization.
+/// @return true if the parameters have been changed.
+///
+template <class OCP>
+bool ocp_parameters_changed(const OCP& ocp, const unsigned long epoch) {
+  if constexpr (has_parameter_epoch<OCP>::value) {
+    return (epoch != kUnsynchronizedEpoch && ocp.parameter_epoch() != epoch);
+  }
+  else {
+    return false;
+  }
+}
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__OCP_SYNCHRONIZATION_HPP_
@@ -0,0 +1,101 @@
+#ifndef CGMRES__PHASE_PROFILER_HPP_
+#define CGMRES__PHASE_PROFILER_HPP_
+
+#include <algorithm>
+#include <chrono>
+
+#include "cgmres/types.hpp"
+#include "cgmres/timer.hpp"
+
+
+namespace cgmres {
+namespace detail {
+
+// Scoped probes of the phases of the solvers. The probes are compiled only if 
+// CGMRES_ENABLE_PHASE_PROFILING is defined. Otherwise, CGMRES_PHASE_PROBE() expands 
+// to nothing and PhaseTimer is an empty class, so that the probes cost nothing in 
+// the production builds.
+#ifdef CGMRES_ENABLE_PHASE_PROFILING
+
+// Accumulates the total and maximum time and the number of the probes of a phase.
+// Unlike Timer, it keeps no histogram so that the probes stay small and cheap.
+class PhaseTimer {
+public:
+  void reset() {
+    total_time_ms_ = 0;
+    max_time_ms_ = 0;
+    counts_ = 0;
+  }
+
+  void tick() {
+    time_point_ = std::chrono::high_resolution_clock::now();
+  }
+
+  void tock() {
+    const std::chrono::duration<Scalar, std::milli> elapsed_time
+        = std::chrono::high_resolution_clock::now() - time_point_;
+    const Scalar elapsed_time_ms = elapsed_time.count();
+    total_time_ms_ += elapsed_time_ms;
+    max_time_ms_ = std::max(max_time_ms_, elapsed_time_ms);
+    ++counts_;
+  }
+
+  Scalar total_time_ms() const { return total_time_ms_; }
+
+  Scalar max_time_ms() const { return max_time_ms_; }
+
+  unsigned long counts() const { return counts_; }
+
+private:
+  std::chrono::high_resolution_clock::time_point time_point_;
+  Scalar total_time_ms_ = 0;
+  Scalar max_time_ms_ = 0;
+  unsigned long counts_ = 0;
+};
+
+class PhaseProbe {
+public:
+  explicit PhaseProbe(PhaseTimer& timer) : timer_(timer) { timer_.tick(); }
+
+  PhaseProbe(const PhaseProbe&) = delete;
+
+  PhaseProbe& operator=(const PhaseProbe&) = delete;
+
+  ~PhaseProbe() { timer_.tock(); }
+
+private:
+  PhaseTimer& timer_;
+};
+
+#define CGMRES_PHASE_PROBE_CONCAT_IMPL(A, B) A##B
+#define CGMRES_PHASE_PROBE_CONCAT(A, B) CGMRES_PHASE_PROBE_CONCAT_IMPL(A, B)
+#define CGMRES_PHASE_PROBE(TIMER) \
+  ::cgmres::detail::PhaseProbe CGMRES_PHASE_PROBE_CONCAT(cgmres_phase_probe_, __LINE__)(TIMER)
+
+inline void append_phase(TimingProfile& profile, const char* name, const PhaseTimer& timer) {
+  PhaseTimingProfile phase;
+  phase.name = name;
+  phase.total_time_ms = timer.total_time_ms();
+  phase.average_time_ms = (timer.counts() > 0) ? timer.total_time_ms() / timer.counts() : 0;
+  phase.max_time_ms = timer.max_time_ms();
+  phase.counts = timer.counts();
+  profile.phases.push_back(phase);
+}
+
+#else
+
+class PhaseTimer {
+public:
+  void reset() {}
+};
+
+#define CGMRES_PHASE_PROBE(TIMER) static_cast<void>(0)
+
+inline void append_phase(TimingProfile&, const char*, const PhaseTimer&) {}
+
+#endif
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__PHASE_PROFILER_HPP_
@@ -0,0 +1,139 @@
+#ifndef CGMRES__RICCATI_RECURSION_HPP_
+#define CGMRES__RICCATI_RECURSION_HPP_
+
+#include <array>
+#include <algorithm>
+
+#include "cgmres/types.hpp"
+#include "cgmres/thirdparty/eigen/Eigen/LU"
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Linearized optimality conditions of a stage of the multiple-shooting NLP, i.e.,
+///   dx_{i+1} = A dx_i + B du_i - fonc_f_i,
+///   Hux dx_i + Huu du_i + Hul dlmd_{i+1} = - fonc_hu_i,
+///   dlmd_i = G dlmd_{i+1} + Hxx dx_i + Hxu du_i - fonc_hx_i,
+/// where du_i is the update of the concatenation of the control input and the Lagrange
+/// multiplier with respect to the equality constraints.
+///
+template <int nx, int nuc>
+struct RiccatiStage {
+  Matrix<nx, nx> A = Matrix<nx, nx>::Zero();
+  Matrix<nx, nuc> B = Matrix<nx, nuc>::Zero();
+  Matrix<nuc, nx> Hux = Matrix<nuc, nx>::Zero();
+  Matrix<nuc, nuc> Huu = Matrix<nuc, nuc>::Zero();
+  Matrix<nuc, nx> Hul = Matrix<nuc, nx>::Zero();
+  Matrix<nx, nx> G = Matrix<nx, nx>::Zero();
+  Matrix<nx, nx> Hxx = Matrix<nx, nx>::Zero();
+  Matrix<nx, nuc> Hxu = Matrix<nx, nuc>::Zero();
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+///
+/// @brief Solves the linearized optimality conditions of the multiple-shooting NLP
+/// by the backward Riccati recursion dlmd_i = P_i dx_i + s_i and du_i = K_i dx_i + k_i,
+/// and the forward recursion from dx_0 = 0. The cost is O(N nx^3).
+///
+template <int nx, int nuc, int N>
+class RiccatiRecursion {
+public:
+  static constexpr int dim = nuc * N;
+
+  RiccatiRecursion()
+    : terminal_hessian_(Matrix<nx, nx>::Zero()) {
+    std::fill(P_.begin(), P_.end(), Matrix<nx, nx>::Zero());
+    std::fill(s_.begin(), s_.end(), Vector<nx>::Zero());
+    std::fill(K_.begin(), K_.end(), Matrix<nuc, nx>::Zero());
+    std::fill(k_.begin(), k_.end(), Vector<nuc>::Zero());
+  }
+
+  ~RiccatiRecursion() = default;
+
+  RiccatiStage<nx, nuc>& stage(const int i) { return stages_[i]; }
+
+  const RiccatiStage<nx, nuc>& stage(const int i) const { return stages_[i]; }
+
+  // Linearized terminal condition dlmd_N = terminal_hessian dx_N - fonc_hx_N.
+  Matrix<nx, nx>& terminal_hessian() { return terminal_hessian_; }
+
+  void backward_recursion(const Vector<dim>& fonc_hu,
+                          const std::array<Vector<nx>, N+1>& fonc_f,
+                          const std::array<Vector<nx>, N+1>& fonc_hx) {
+    P_[N] = terminal_hessian_;
+    s_[N] = - fonc_hx[N];
+    for (int i=N-1; i>=0; --i) {
+      const auto& stage = stages_[i];
+      PA_.noalias() = P_[i+1] * stage.A;
+      PB_.noalias() = P_[i+1] * stage.B;
+      Ps_ = s_[i+1];
+      Ps_.noalias() -= P_[i+1] * fonc_f[i];
+      M_ = stage.Huu;
+      M_.noalias() += stage.Hul * PB_;
+      lu_.compute(M_);
+      ku_ = fonc_hu.template segment<nuc>(nuc*i);
+      ku_.noalias() += stage.Hul * Ps_;
+      k_[i] = - lu_.solve(ku_);
+      if (i > 0) {
+        Ku_ = stage.Hux;
+        Ku_.noalias() += stage.Hul * PA_;
+        K_[i] = - lu_.solve(Ku_);
+        PA_.noalias() += PB_ * K_[i];
+        P_[i] = stage.Hxx;
+        P_[i].noalias() += stage.G * PA_;
+        P_[i].noalias() += stage.Hxu * K_[i];
+        Ps_.noalias() += PB_ * k_[i];
+        s_[i] = - fonc_hx[i];
+        s_[i].noalias() += stage.G * Ps_;
+        s_[i].noalias() += stage.Hxu * k_[i];
+      }
+    }
+  }
+
+  void forward_recursion(const std::array<Vector<nx>, N+1>& fonc_f,
+                         Vector<dim>& solution_update,
+                         std::array<Vector<nx>, N+1>& x_update,
+                         std::array<Vector<nx>, N+1>& lmd_update) const {
+    x_update[0].setZero();
+    lmd_update[0].setZero();
+    for (int i=0; i<N; ++i) {
+      const auto& stage = stages_[i];
+      if (i > 0) {
+        solution_update.template segment<nuc>(nuc*i).noalias() = K_[i] * x_update[i] + k_[i];
+      }
+      else {
+        solution_update.template head<nuc>() = k_[0];
+      }
+      x_update[i+1] = - fonc_f[i];
+      x_update[i+1].noalias() += stage.A * x_update[i];
+      x_update[i+1].noalias() += stage.B * solution_update.template segment<nuc>(nuc*i);
+      lmd_update[i+1] = s_[i+1];
+      lmd_update[i+1].noalias() += P_[i+1] * x_update[i+1];
+    }
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  std::array<RiccatiStage<nx, nuc>, N> stages_;
+  Matrix<nx, nx> terminal_hessian_;
+  std::array<Matrix<nx, nx>, N+1> P_;
+  std::array<Vector<nx>, N+1> s_;
+  std::array<Matrix<nuc, nx>, N> K_;
+  std::array<Vector<nuc>, N> k_;
+  Matrix<nx, nx> PA_;
+  Matrix<nx, nuc> PB_;
+  Vector<nx> Ps_;
+  Matrix<nuc, nuc> M_;
+  Matrix<nuc, nx> Ku_;
+  Vector<nuc> ku_;
+  Eigen::PartialPivLU<Matrix<nuc, nuc>> lu_;
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__RICCATI_RECURSION_HPP_
@@ -8,6 +8,8 @@
 
 #include "cgmres/detail/control_input_bounds.hpp"
 #include "cgmres/detail/control_input_bounds_shooting.hpp"
+#include "cgmres/detail/ocp_synchronization.hpp"
+#include "cgmres/detail/ocp_derivatives.hpp"
 
 namespace cgmres {
 namespace detail {
@@ -21,6 +23,7 @@ public:
   static constexpr int nuc = nu + nc;
   static constexpr int nub = OCP::nub;
   static constexpr int dim = nuc * N + 2 * N * nub;
+  static constexpr bool has_jvp = detail::has_jvp<OCP>::value;
 
   SingleShootingNLP(const OCP& ocp, const Horizon& horizon) 
     : ocp_(ocp),
@@ -33,6 +36,8 @@ public:
     static_assert(N > 0);
     std::fill(x_.begin(), x_.end(), Vector<nx>::Zero());
     std::fill(lmd_.begin(), lmd_.end(), Vector<nx>::Zero());
+    std::fill(x_dir_.begin(), x_dir_.end(), Vector<nx>::Zero());
+    std::fill(lmd_dir_.begin(), lmd_dir_.end(), Vector<nx>::Zero());
   }
 
   SingleShootingNLP() = default;
@@ -86,6 +91,59 @@ public:
     }
   }
 
+  // Directional derivative of eval_fonc_hu() along solution_dir around the state and costate 
+  // trajectories of the last eval_fonc_hu(), which must be evaluated at (t, x, solution). 
+  // Requires the JVPs of the OCP, i.e., has_jvp.
+  template <typename VectorType1, typename VectorType2>
+  void eval_fonc_hu_jvp(const Scalar t, const MatrixBase<VectorType1>& x, const Vector<dim>& solution,
+                        const MatrixBase<VectorType2>& solution_dir, Vector<dim>& fonc_hu_jvp) {
+    static_assert(has_jvp, "OCP must provide eval_f_jvp(), eval_phix_jvp(), eval_hx_jvp(), and eval_hu_jvp()");
+    const Scalar T = horizon_.T(t);
+    const Scalar dt = T / N;
+    assert(T >= 0);
+    const auto& u_dir = solution_dir.derived();
+    // Forward sensitivity of the state.
+    x_dir_[0].setZero();
+    for (size_t i=0; i<N; ++i) {
+      const int inucb2 = i * (nuc + 2 * nub);
+      ocp_.eval_f_jvp(t+i*dt, x_[i].data(), solution.template segment<nuc>(inucb2).data(), 
+                      x_dir_[i].data(), u_dir.template segment<nuc>(inucb2).data(), dx_.data());
+      x_dir_[i+1] = x_dir_[i] + dt * dx_;
+    }
+    // Backward sensitivity of the costate.
+    ocp_.eval_phix_jvp(t+T, x_[N].data(), x_dir_[N].data(), lmd_dir_[N].data());
+    for (size_t i=N-1; i>=1; --i) {
+      const int inucb2 = i * (nuc + 2 * nub);
+      ocp_.eval_hx_jvp(t+i*dt, x_[i].data(), solution.template segment<nuc>(inucb2).data(),
+                       lmd_[i+1].data(), x_dir_[i].data(), u_dir.template segment<nuc>(inucb2).data(),
+                       lmd_dir_[i+1].data(), dx_.data());
+      lmd_dir_[i] = lmd_dir_[i+1] + dt * dx_;
+    }
+    for (size_t i=0; i<N; ++i) {
+      const int inucb2 = i * (nuc + 2 * nub);
+      ocp_.eval_hu_jvp(t+i*dt, x_[i].data(), solution.template segment<nuc>(inucb2).data(),
+                       lmd_[i+1].data(), x_dir_[i].data(), u_dir.template segment<nuc>(inucb2).data(),
+                       lmd_dir_[i+1].data(), fonc_hu_jvp.template segment<nuc>(inucb2).data());
+    }
+    if constexpr (nub > 0) {
+      for (size_t i=0; i<N; ++i) {
+        const int inucb2 = i * (nuc + 2 * nub);
+        const auto uc        = solution.template segment<nuc>(inucb2);
+        const auto dummy     = solution.template segment<nub>(inucb2+nuc);
+        const auto mu        = solution.template segment<nub>(inucb2+nuc+nub);
+        const auto uc_dir    = u_dir.template segment<nuc>(inucb2);
+        const auto dummy_dir = u_dir.template segment<nub>(inucb2+nuc);
+        const auto mu_dir    = u_dir.template segment<nub>(inucb2+nuc+nub);
+        auto fonc_huc_jvp    = fonc_hu_jvp.template segment<nuc>(inucb2);
+        auto fonc_hdummy_jvp = fonc_hu_jvp.template segment<nub>(inucb2+nuc);
+        auto fonc_hmu_jvp    = fonc_hu_jvp.template segment<nub>(inucb2+nuc+nub);
+        ubounds::eval_hu_jvp(ocp_, uc, mu, uc_dir, mu_dir, fonc_huc_jvp);
+        ubounds::eval_hdummy_jvp(dummy, mu, dummy_dir, mu_dir, fonc_hdummy_jvp);
+        ubounds::eval_hmu_jvp(ocp_, uc, dummy, uc_dir, dummy_dir, fonc_hmu_jvp);
+      }
+    }
+  }
+
   void retrieve_dummy(Vector<dim>& solution, Vector<dim>& fonc_hu, const Scalar min_dummy) {
     if constexpr (nub > 0) {
       for (size_t i=0; i<N; ++i) {
@@ -116,7 +174,7 @@ public:
     }
   }
 
-  void synchronize_ocp() { ocp_.synchronize(); }
+  void synchronize_ocp() { detail::synchronize_ocp(ocp_, ocp_epoch_); }
 
   const OCP& ocp() const { return ocp_; }
 
@@ -126,13 +184,28 @@ public:
 
   const std::array<Vector<nx>, N+1>& lmd() const { return lmd_; }
 
+  static constexpr int state_dim = 2 * (N+1) * nx;
+
+  template <typename StateWriter>
+  void save_state(StateWriter& writer) const {
+    writer.write(x_);
+    writer.write(lmd_);
+  }
+
+  template <typename StateReader>
+  void load_state(StateReader& reader) {
+    reader.read(x_);
+    reader.read(lmd_);
+  }
+
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 private:
   OCP ocp_;
+  unsigned long ocp_epoch_ = kUnsynchronizedEpoch;
   Horizon horizon_;
   Vector<nx> dx_;
-  std::array<Vector<nx>, N+1> x_, lmd_;
+  std::array<Vector<nx>, N+1> x_, lmd_, x_dir_, lmd_dir_;
 };
 
 } // namespace detail
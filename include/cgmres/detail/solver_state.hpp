@@ -0,0 +1,190 @@
+#ifndef CGMRES__SOLVER_STATE_HPP_
+#define CGMRES__SOLVER_STATE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "cgmres/types.hpp"
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @brief Kinds of the solvers whose states are saved by save_state().
+///
+enum class SolverStateKind : std::uint32_t {
+  MultipleShooting = 1,
+  SingleShooting = 2,
+  ZeroHorizon = 3,
+};
+
+///
+/// @struct SolverStateHeader
+/// @brief Header of the flat binary solver state. Followed by the Scalar entries.
+///
+struct SolverStateHeader {
+  static constexpr std::uint32_t kMagic = 0x53474d43; // "CMGS" in little endian
+  static constexpr std::uint32_t kVersion = 1;
+
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t kind;
+  std::uint32_t scalar_size;
+  std::int32_t nx;
+  std::int32_t nuc;
+  std::int32_t nub;
+  std::int32_t N;
+  std::int32_t dim;
+  std::int32_t kmax;
+  std::uint64_t size;
+};
+
+///
+/// @brief Size in bytes of the flat binary solver state.
+/// @param[in] num_scalars Number of the Scalar entries.
+///
+constexpr std::size_t solver_state_size(const std::size_t num_scalars) {
+  return sizeof(SolverStateHeader) + num_scalars * sizeof(Scalar);
+}
+
+///
+/// @brief Makes the header of the flat binary solver state.
+///
+inline SolverStateHeader make_solver_state_header(const SolverStateKind kind, const int nx,
+                                                  const int nuc, const int nub, const int N,
+                                                  const int dim, const int kmax,
+                                                  const std::size_t size) {
+  SolverStateHeader header;
+  std::memset(&header, 0, sizeof(SolverStateHeader));
+  header.magic = SolverStateHeader::kMagic;
+  header.version = SolverStateHeader::kVersion;
+  header.kind = static_cast<std::uint32_t>(kind);
+  header.scalar_size = sizeof(Scalar);
+  header.nx = nx;
+  header.nuc = nuc;
+  header.nub = nub;
+  header.N = N;
+  header.dim = dim;
+  header.kmax = kmax;
+  header.size = size;
+  return header;
+}
+
+///
+/// @brief Checks the header of a flat binary solver state.
+/// @param[in] data Pointer to the state.
+/// @param[in] size Size of the memory pointed by data in bytes.
+/// @param[in] expected Header expected for the solver loading the state.
+/// @param[in] caller Name of the caller used in the error messages.
+///
+inline void check_solver_state_header(const void* data, const std::size_t size,
+                                      const SolverStateHeader& expected,
+                                      const char* caller) {
+  if (data == nullptr) {
+    throw std::invalid_argument(std::string("[") + caller + "] data must not be null");
+  }
+  if (size < sizeof(SolverStateHeader)) {
+    throw std::invalid_argument(std::string("[") + caller + "] size must be at least " + std::to_string(expected.size));
+  }
+  SolverStateHeader header;
+  std::memcpy(&header, data, sizeof(SolverStateHeader));
+  if (header.magic != expected.magic) {
+    throw std::invalid_argument(std::string("[") + caller + "] data is not a solver state");
+  }
+  if (header.version != expected.version) {
+    throw std::invalid_argument(std::string("[") + caller + "] unsupported version " + std::to_string(header.version)
+                                + " (expected " + std::to_string(expected.version) + ")");
+  }
+  if (header.kind != expected.kind) {
+    throw std::invalid_argument(std::string("[") + caller + "] the state is saved by another kind of solver");
+  }
+  if (header.scalar_size != expected.scalar_size || header.nx != expected.nx || header.nuc != expected.nuc
+      || header.nub != expected.nub || header.N != expected.N || header.dim != expected.dim
+      || header.kmax != expected.kmax) {
+    throw std::invalid_argument(std::string("[") + caller + "] dimensions of the state do not match those of the solver");
+  }
+  if (header.size != expected.size || size < expected.size) {
+    throw std::invalid_argument(std::string("[") + caller + "] size must be at least " + std::to_string(expected.size));
+  }
+}
+
+///
+/// @class SolverStateWriter
+/// @brief Writes Scalar entries into a flat binary solver state by memcpy.
+///
+class SolverStateWriter {
+public:
+  explicit SolverStateWriter(void* data)
+    : data_(static_cast<unsigned char*>(data)) {}
+
+  void write(const SolverStateHeader& header) {
+    std::memcpy(data_, &header, sizeof(SolverStateHeader));
+    data_ += sizeof(SolverStateHeader);
+  }
+
+  void write(const Scalar value) {
+    std::memcpy(data_, &value, sizeof(Scalar));
+    data_ += sizeof(Scalar);
+  }
+
+  template <int n>
+  void write(const Vector<n>& vec) {
+    if constexpr (n > 0) {
+      std::memcpy(data_, vec.data(), n*sizeof(Scalar));
+      data_ += n*sizeof(Scalar);
+    }
+  }
+
+  template <int n, std::size_t M>
+  void write(const std::array<Vector<n>, M>& arr) {
+    for (const auto& e : arr) {
+      write(e);
+    }
+  }
+
+private:
+  unsigned char* data_;
+};
+
+///
+/// @class SolverStateReader
+/// @brief Reads Scalar entries from a flat binary solver state by memcpy.
+///
+class SolverStateReader {
+public:
+  explicit SolverStateReader(const void* data)
+    : data_(static_cast<const unsigned char*>(data) + sizeof(SolverStateHeader)) {}
+
+  void read(Scalar& value) {
+    std::memcpy(&value, data_, sizeof(Scalar));
+    data_ += sizeof(Scalar);
+  }
+
+  template <int n>
+  void read(Vector<n>& vec) {
+    if constexpr (n > 0) {
+      std::memcpy(vec.data(), data_, n*sizeof(Scalar));
+      data_ += n*sizeof(Scalar);
+    }
+  }
+
+  template <int n, std::size_t M>
+  void read(std::array<Vector<n>, M>& arr) {
+    for (auto& e : arr) {
+      read(e);
+    }
+  }
+
+private:
+  const unsigned char* data_;
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__SOLVER_STATE_HPP_
@@ -0,0 +1,95 @@
+#ifndef CGMRES__SPSC_QUEUE_HPP_
+#define CGMRES__SPSC_QUEUE_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @class SPSCQueue
+/// @brief Bounded lock-free single-producer single-consumer ring buffer.
+/// push() must be called from one thread and pop() from another one. 
+/// Neither blocks nor allocates.
+/// @tparam T Type of the elements. Must be copy-assignable.
+/// @tparam Capacity Capacity of the queue. Must be a power of two.
+///
+template <typename T, int Capacity>
+class SPSCQueue {
+public:
+  static_assert(Capacity >= 2);
+  static_assert((Capacity & (Capacity-1)) == 0, "Capacity must be a power of two");
+
+  SPSCQueue() = default;
+
+  SPSCQueue(const SPSCQueue&) = delete;
+
+  SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+  ///
+  /// @brief Pushes an element. Called only by the producer.
+  /// @return false if the queue is full. Then the element is discarded.
+  ///
+  bool push(const T& value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    buffer_[tail & kMask] = value;
+    tail_.store(tail+1, std::memory_order_release);
+    return true;
+  }
+
+  ///
+  /// @brief Pops the oldest element. Called only by the consumer.
+  /// @return false if the queue is empty. Then value is not modified.
+  ///
+  bool pop(T& value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = buffer_[head & kMask];
+    head_.store(head+1, std::memory_order_release);
+    return true;
+  }
+
+  ///
+  /// @brief Pops all the elements and keeps the newest one. Called only by the consumer.
+  /// @return false if the queue is empty. Then value is not modified.
+  ///
+  bool pop_latest(T& value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    const std::size_t tail = tail_.load(std::memory_order_acquire);
+    if (head == tail) {
+      return false;
+    }
+    value = buffer_[(tail-1) & kMask];
+    head_.store(tail, std::memory_order_release);
+    return true;
+  }
+
+  ///
+  /// @brief Checks if the queue is empty. Called only by the consumer.
+  ///
+  bool empty() const {
+    return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+  }
+
+  static constexpr int capacity() { return Capacity; }
+
+private:
+  static constexpr std::size_t kMask = Capacity - 1;
+
+  std::array<T, Capacity> buffer_;
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__SPSC_QUEUE_HPP_
@@ -0,0 +1,149 @@
+#ifndef CGMRES__THREAD_POOL_HPP_
+#define CGMRES__THREAD_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @class ThreadPool
+/// @brief Fixed-size worker pool for fork-join loops inside the solvers.
+/// The calling thread takes part in each loop, so a pool of num_threads
+/// owns num_threads-1 workers. Workers spin briefly before sleeping so that
+/// back-to-back loops within one sampling period do not pay a wake-up latency.
+///
+class ThreadPool {
+public:
+  explicit ThreadPool(const int num_threads)
+    : generation_(0),
+      stop_(false) {
+    if (num_threads <= 0) {
+      throw std::invalid_argument("[ThreadPool]: 'num_threads' must be positive!");
+    }
+    for (int i=0; i<num_threads-1; ++i) {
+      workers_.emplace_back([this]() { workerLoop(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_.store(true, std::memory_order_release);
+    }
+    cv_.notify_all();
+    for (auto& e : workers_) {
+      e.join();
+    }
+  }
+
+  int num_threads() const { return workers_.size() + 1; }
+
+  ///
+  /// @brief Calls func(i) for i = 0, ..., n-1 and returns after all calls finish.
+  /// Concurrent callers are serialized. If a call throws, the remaining calls are 
+  /// skipped and the first exception is rethrown on the calling thread after all 
+  /// the running calls have finished.
+  ///
+  template <typename Function>
+  void parallel_for(const int n, const Function& func) {
+    if (workers_.empty() || n <= 1) {
+      for (int i=0; i<n; ++i) {
+        func(i);
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> call_lock(call_mutex_);
+    func_ = static_cast<const void*>(&func);
+    invoke_ = [](const void* f, const int i) { (*static_cast<const Function*>(f))(i); };
+    n_ = n;
+    exception_ = nullptr;
+    next_.store(0, std::memory_order_relaxed);
+    pending_.store(workers_.size(), std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      generation_.fetch_add(1, std::memory_order_release);
+    }
+    cv_.notify_all();
+    runTasks();
+    while (pending_.load(std::memory_order_acquire) > 0) {
+      std::this_thread::yield();
+    }
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+private:
+  static constexpr int kSpinCount = 2000;
+
+  std::vector<std::thread> workers_;
+  std::mutex call_mutex_, mutex_, exception_mutex_;
+  std::condition_variable cv_;
+  std::atomic<unsigned long> generation_;
+  std::atomic<bool> stop_;
+  std::atomic<int> next_{0};
+  std::atomic<int> pending_{0};
+  const void* func_ = nullptr;
+  void (*invoke_)(const void*, const int) = nullptr;
+  int n_ = 0;
+  std::exception_ptr exception_;
+
+  void runTasks() {
+    for (int i=next_.fetch_add(1, std::memory_order_relaxed); i<n_;
+         i=next_.fetch_add(1, std::memory_order_relaxed)) {
+      try {
+        invoke_(func_, i);
+      }
+      catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(exception_mutex_);
+          if (!exception_) exception_ = std::current_exception();
+        }
+        // Skips the remaining calls.
+        next_.store(n_, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void workerLoop() {
+    unsigned long seen = 0;
+    while (true) {
+      int spin = 0;
+      while (generation_.load(std::memory_order_acquire) == seen
+              && !stop_.load(std::memory_order_acquire) && spin < kSpinCount) {
+        ++spin;
+        std::this_thread::yield();
+      }
+      if (generation_.load(std::memory_order_acquire) == seen) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&]() {
+          return stop_.load(std::memory_order_acquire)
+                  || generation_.load(std::memory_order_acquire) != seen;
+        });
+      }
+      if (stop_.load(std::memory_order_acquire)) {
+        return;
+      }
+      seen = generation_.load(std::memory_order_acquire);
+      runTasks();
+      pending_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__THREAD_POOL_HPP_
@@ -0,0 +1,78 @@
+#ifndef CGMRES__TRIPLE_BUFFER_HPP_
+#define CGMRES__TRIPLE_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+
+
+namespace cgmres {
+namespace detail {
+
+///
+/// @class TripleBuffer
+/// @brief Wait-free single-writer single-reader triple buffer.
+/// The writer fills back() and publishes it by publish(). The reader takes 
+/// the latest published buffer by update() and reads it by front(). 
+/// Each side owns one buffer at any time and the third one is exchanged 
+/// through an atomic index, so neither side blocks the other.
+/// @tparam T Type of the buffer. 
+///
+template <typename T>
+class TripleBuffer {
+public:
+  TripleBuffer() = default;
+
+  ///
+  /// @brief Initializes all the buffers with value.
+  ///
+  explicit TripleBuffer(const T& value) {
+    buffers_.fill(value);
+  }
+
+  TripleBuffer(const TripleBuffer&) = delete;
+
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  ///
+  /// @brief Buffer owned by the writer.
+  ///
+  T& back() { return buffers_[back_]; }
+
+  ///
+  /// @brief Publishes the back buffer. Called only by the writer.
+  ///
+  void publish() {
+    back_ = middle_.exchange(back_ | kDirty, std::memory_order_acq_rel) & kIndexMask;
+  }
+
+  ///
+  /// @brief Takes the latest published buffer if any. Called only by the reader.
+  /// @return true if a new buffer has been published since the last call.
+  ///
+  bool update() {
+    if ((middle_.load(std::memory_order_relaxed) & kDirty) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+  ///
+  /// @brief Buffer owned by the reader.
+  ///
+  const T& front() const { return buffers_[front_]; }
+
+private:
+  static constexpr unsigned kIndexMask = 3;
+  static constexpr unsigned kDirty = 4;
+
+  std::array<T, 3> buffers_;
+  alignas(64) unsigned front_ = 0;
+  alignas(64) std::atomic<unsigned> middle_{1};
+  alignas(64) unsigned back_ = 2;
+};
+
+} // namespace detail
+} // namespace cgmres
+
+#endif // CGMRES__TRIPLE_BUFFER_HPP_
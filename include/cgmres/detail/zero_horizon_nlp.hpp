@@ -7,6 +7,8 @@
 #include "cgmres/horizon.hpp"
 
 #include "cgmres/detail/control_input_bounds.hpp"
+#include "cgmres/detail/ocp_synchronization.hpp"
+#include "cgmres/detail/ocp_derivatives.hpp"
 
 namespace cgmres {
 namespace detail {
@@ -23,7 +25,8 @@ public:
 
   ZeroHorizonNLP(const OCP& ocp) 
     : ocp_(ocp),
-      lmd_(Vector<nx>::Zero()) {
+      lmd_(Vector<nx>::Zero()),
+      huu_(Matrix<nuc, nuc>::Zero()) {
     static_assert(OCP::nx > 0);
     static_assert(OCP::nu > 0);
     static_assert(OCP::nc >= 0);
@@ -54,6 +57,23 @@ public:
     }
   }
 
+  // Exact Jacobian of eval_fonc_hu() with respect to the solution. Requires eval_huu() of the OCP.
+  template <typename VectorType>
+  void eval_fonc_hu_jacobian(const Scalar t, const MatrixBase<VectorType>& x, const Vector<dim>& solution,
+                             Matrix<dim, dim>& jac) {
+    static_assert(has_eval_huu<OCP>::value, "OCP must provide eval_huu()");
+    ocp_.eval_phix(t, x.derived().data(), lmd_.data());
+    ocp_.eval_huu(t, x.derived().data(), solution.data(), lmd_.data(), huu_.data());
+    jac.setZero();
+    jac.template topLeftCorner<nuc, nuc>() = huu_;
+    if constexpr (nub > 0) {
+      const auto uc    = solution.template head<nuc>();
+      const auto dummy = solution.template segment<nub>(nuc);
+      const auto mu    = solution.template segment<nub>(nuc+nub);
+      ubounds::add_fonc_jacobian(ocp_, uc, dummy, mu, jac);
+    }
+  }
+
   void retrieve_dummy(Vector<dim>& solution, Vector<dim>& fonc_hu, const Scalar min_dummy) {
     if constexpr (nub > 0) {
       const auto uc    = solution.template head<nuc>();
@@ -79,17 +99,31 @@ public:
     }
   }
 
-  void synchronize_ocp() { ocp_.synchronize(); }
+  void synchronize_ocp() { detail::synchronize_ocp(ocp_, ocp_epoch_); }
 
   const OCP& ocp() const { return ocp_; }
 
   const Vector<nx>& lmd() const { return lmd_; }
 
+  static constexpr int state_dim = nx;
+
+  template <typename StateWriter>
+  void save_state(StateWriter& writer) const {
+    writer.write(lmd_);
+  }
+
+  template <typename StateReader>
+  void load_state(StateReader& reader) {
+    reader.read(lmd_);
+  }
+
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 private:
   OCP ocp_;
+  unsigned long ocp_epoch_ = kUnsynchronizedEpoch;
   Vector<nx> lmd_;
+  Matrix<nuc, nuc> huu_;
 };
 
 } // namespace detail
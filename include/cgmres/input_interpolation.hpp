@@ -0,0 +1,24 @@
+#ifndef CGMRES__INPUT_INTERPOLATION_HPP_
+#define CGMRES__INPUT_INTERPOLATION_HPP_
+
+namespace cgmres {
+
+///
+/// @enum InputInterpolation
+/// @brief Interpolation of the control input trajectory between the grids of
+/// the horizon, used to query the control input in continuous time between
+/// the solver updates.
+///
+enum class InputInterpolation {
+  /// Holds the control input of the grid at or before the query time.
+  ZeroOrderHold,
+  /// Linearly interpolates the control inputs of the neighbouring grids.
+  Linear,
+  /// Cubic Hermite interpolation with the finite-difference (Catmull-Rom)
+  /// tangents, which is C1-continuous over the horizon.
+  CubicHermite
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__INPUT_INTERPOLATION_HPP_
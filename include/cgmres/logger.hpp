@@ -56,13 +56,22 @@ public:
   }
 
   ///
-  /// @brief Save the timing profile.
+  /// @brief Save the timing profile. The non-empty buckets of the latency histogram
+  /// are also saved as the pairs of the upper bound in milliseconds and the count.
   /// @param[in] timing_profile Timing profile.
   ///
   void save(const TimingProfile& timing_profile) const {
     std::ofstream timing_log(log_name_ + "_timing_profile.log");
     timing_log << timing_profile;
     timing_log.close();
+    std::ofstream histogram_log(log_name_ + "_latency_histogram.log");
+    const auto& histogram = timing_profile.histogram;
+    for (std::size_t i=0; i<histogram.num_buckets; ++i) {
+      if (histogram.count(i) > 0) {
+        histogram_log << 1.0e-06 * histogram.bucketUpperBound(i) << ' ' << histogram.count(i) << '\n';
+      }
+    }
+    histogram_log.close();
   }
 
 private:
@@ -0,0 +1,344 @@
+#ifndef CGMRES__MOVING_HORIZON_ESTIMATOR_HPP_
+#define CGMRES__MOVING_HORIZON_ESTIMATOR_HPP_
+
+#include <array>
+#include <chrono>
+#include <stdexcept>
+#include <iostream>
+
+#include "cgmres/types.hpp"
+#include "cgmres/solver_settings.hpp"
+#include "cgmres/timer.hpp"
+
+#include "cgmres/detail/matrixfree_gmres.hpp"
+#include "cgmres/detail/moving_horizon_estimation_nlp.hpp"
+#include "cgmres/detail/continuation_mhe.hpp"
+
+namespace cgmres {
+
+///
+/// @class MovingHorizonEstimator
+/// @brief Moving horizon estimator (MHE) of the state and model parameters of the OCP
+/// by the continuation method with the matrix-free GMRES, e.g., for online fault
+/// identification. The estimator keeps a window of the last N+1 measurements of
+/// the state and the control inputs and minimizes the weighted least squares of the
+/// deviations of the predicted state from the measurements, of the oldest state from
+/// the arrival state, and of the parameters from their previous estimate, with the
+/// state equation of the OCP. Each update() appends a measurement and performs one
+/// continuation step with the Gauss-Newton Hessian, as the update() of the MPC solvers,
+/// so that the estimator can share the sampling period with them. The estimated
+/// parameters can be passed to the MPC by apply_parameters() and
+/// MultipleShootingCGMRESSolver::update_ocp().
+/// @tparam OCP A definition of the optimal control problem (OCP).
+/// @tparam N Number of the intervals of the window. Must be positive.
+/// @tparam kmax Maximum number of the GMRES iterations. Must be positive.
+/// @tparam np Number of the estimated parameters, i.e., the data members of the OCP
+/// of type Scalar. Default is 0 (state estimation only).
+///
+template <class OCP, int N, int kmax, int np=0>
+class MovingHorizonEstimator {
+public:
+  ///
+  /// @brief Dimension of the state.
+  ///
+  static constexpr int nx = OCP::nx;
+
+  ///
+  /// @brief Dimension of the control input.
+  ///
+  static constexpr int nu = OCP::nu;
+
+  ///
+  /// @brief Dimension of the linear problem solved by the GMRES solver, i.e.,
+  /// that of the state and the parameters.
+  ///
+  static constexpr int dim = nx + np;
+
+  using MovingHorizonEstimationNLP_ = detail::MovingHorizonEstimationNLP<OCP, N, np>;
+  using ContinuationMHE_ = detail::ContinuationMHE<MovingHorizonEstimationNLP_>;
+  using MatrixFreeGMRES_ = detail::MatrixFreeGMRES<ContinuationMHE_, kmax>;
+
+  ///
+  /// @brief Pointers to the data members of the OCP estimated as the parameters,
+  /// e.g., `{&OCP_QuadrotorFTC::c1}`.
+  ///
+  using ParameterMembers = typename MovingHorizonEstimationNLP_::ParameterMembers;
+
+  ///
+  /// @brief Constructs the moving horizon estimator. The state equation is that of
+  /// the OCP with the parameters given by the data members. The time derivative of
+  /// the continuation is scaled by SolverSettings::sampling_time, i.e., zeta *
+  /// sampling_time = 1 gives the full Gauss-Newton step in each update.
+  /// @param[in] ocp A definition of the optimal control problem (OCP).
+  /// @param[in] parameters Pointers to the data members of the OCP estimated as the parameters.
+  /// @param[in] settings Solver settings.
+  ///
+  MovingHorizonEstimator(const OCP& ocp, const ParameterMembers& parameters,
+                         const SolverSettings& settings)
+    : continuation_mhe_(MovingHorizonEstimationNLP_(ocp, parameters),
+                        settings.finite_difference_epsilon, settings.zeta),
+      gmres_(),
+      settings_(settings),
+      z_(Vector<dim>::Zero()),
+      z_update_(Vector<dim>::Zero()),
+      x_estimate_(Vector<nx>::Zero()) {
+    if (settings.finite_difference_epsilon <= 0.0) {
+      throw std::invalid_argument("[MovingHorizonEstimator]: 'settings.finite_difference_epsilon' must be positive!");
+    }
+    if (settings.sampling_time <= 0.0) {
+      throw std::invalid_argument("[MovingHorizonEstimator]: 'settings.sampling_time' must be positive!");
+    }
+    if (settings.zeta <= 0.0) {
+      throw std::invalid_argument("[MovingHorizonEstimator]: 'settings.zeta' must be positive!");
+    }
+    continuation_mhe_.get_nlp().set_parameter_epsilon(settings.finite_difference_epsilon);
+    if constexpr (np > 0) {
+      Vector<np> p;
+      continuation_mhe_.get_nlp().get_parameters(ocp, p);
+      z_.template tail<np>() = p;
+      continuation_mhe_.get_nlp().parameter_prior() = p;
+    }
+  }
+
+  ///
+  /// @brief Default constructor.
+  ///
+  MovingHorizonEstimator() = default;
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~MovingHorizonEstimator() = default;
+
+  ///
+  /// @brief Sets the diagonal weights of the residuals.
+  /// @param[in] arrival_weight Weight on the deviation of the oldest state of the window
+  /// from the arrival state. Size must be MovingHorizonEstimator::nx.
+  /// @param[in] measurement_weight Weight on the deviation of the predicted state from
+  /// the measurements. Zero for the entries that are not measured. Size must be
+  /// MovingHorizonEstimator::nx.
+  ///
+  template <typename VectorType1, typename VectorType2>
+  void set_weights(const MatrixBase<VectorType1>& arrival_weight,
+                   const MatrixBase<VectorType2>& measurement_weight) {
+    if (arrival_weight.size() != nx) {
+      throw std::invalid_argument("[MovingHorizonEstimator::set_weights] arrival_weight.size() must be " + std::to_string(nx));
+    }
+    if (measurement_weight.size() != nx) {
+      throw std::invalid_argument("[MovingHorizonEstimator::set_weights] measurement_weight.size() must be " + std::to_string(nx));
+    }
+    if ((arrival_weight.array() < 0.0).any() || (measurement_weight.array() < 0.0).any()) {
+      throw std::invalid_argument("[MovingHorizonEstimator::set_weights] weights must be non-negative");
+    }
+    continuation_mhe_.get_nlp().arrival_weight() = arrival_weight;
+    continuation_mhe_.get_nlp().measurement_weight() = measurement_weight;
+  }
+
+  ///
+  /// @brief Sets the diagonal weight on the change of the parameters from the previous
+  /// estimate. A smaller weight makes the estimate follow a sudden change, e.g., a fault,
+  /// faster but more sensitive to the noise.
+  /// @param[in] parameter_weight Weight. Size must be MovingHorizonEstimator::np.
+  ///
+  template <typename VectorType>
+  void set_parameter_weight(const MatrixBase<VectorType>& parameter_weight) {
+    if (parameter_weight.size() != np) {
+      throw std::invalid_argument("[MovingHorizonEstimator::set_parameter_weight] parameter_weight.size() must be " + std::to_string(np));
+    }
+    if ((parameter_weight.array() < 0.0).any()) {
+      throw std::invalid_argument("[MovingHorizonEstimator::set_parameter_weight] parameter_weight must be non-negative");
+    }
+    continuation_mhe_.get_nlp().parameter_weight() = parameter_weight;
+  }
+
+  ///
+  /// @brief Initializes the estimate and clears the window of the measurements.
+  /// @param[in] x Initial guess of the state at the first measurement. Size must be MovingHorizonEstimator::nx.
+  ///
+  template <typename VectorType>
+  void init(const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[MovingHorizonEstimator::init] x.size() must be " + std::to_string(nx));
+    }
+    z_.template head<nx>() = x;
+    z_update_.setZero();
+    x_estimate_ = x;
+    continuation_mhe_.get_nlp().arrival_state() = x;
+    continuation_mhe_.get_nlp().clear_measurements();
+  }
+
+  ///
+  /// @brief Initializes the estimate and clears the window of the measurements.
+  /// @param[in] x Initial guess of the state at the first measurement. Size must be MovingHorizonEstimator::nx.
+  /// @param[in] p Initial guess of the parameters. Size must be MovingHorizonEstimator::np.
+  ///
+  template <typename VectorType1, typename VectorType2>
+  void init(const MatrixBase<VectorType1>& x, const MatrixBase<VectorType2>& p) {
+    if (p.size() != np) {
+      throw std::invalid_argument("[MovingHorizonEstimator::init] p.size() must be " + std::to_string(np));
+    }
+    init(x);
+    z_.template tail<np>() = p;
+    continuation_mhe_.get_nlp().parameter_prior() = p;
+  }
+
+  ///
+  /// @brief Updates the estimate with a new measurement by a continuation step.
+  /// @param[in] t Time of the measurement.
+  /// @param[in] y Measurement of the state. Size must be MovingHorizonEstimator::nx.
+  /// @param[in] u Control input applied from t. Size must be MovingHorizonEstimator::nu.
+  ///
+  template <typename VectorType1, typename VectorType2>
+  void update(const Scalar t, const MatrixBase<VectorType1>& y, const MatrixBase<VectorType2>& u) {
+    checkMeasurement(y, u, "update");
+    updateImpl(t, y, u, nullptr);
+  }
+
+  ///
+  /// @brief Same as update() but stops the GMRES iterations once the deadline has passed
+  /// (see MultipleShootingCGMRESSolver::update()), e.g., to budget the estimator and the MPC
+  /// in the same sampling period.
+  /// @param[in] t Time of the measurement.
+  /// @param[in] y Measurement of the state. Size must be MovingHorizonEstimator::nx.
+  /// @param[in] u Control input applied from t. Size must be MovingHorizonEstimator::nu.
+  /// @param[in] deadline Deadline of the GMRES iterations.
+  /// @return true if the GMRES iterations are truncated by the deadline.
+  ///
+  template <typename VectorType1, typename VectorType2>
+  bool update(const Scalar t, const MatrixBase<VectorType1>& y, const MatrixBase<VectorType2>& u,
+              const std::chrono::steady_clock::time_point& deadline) {
+    checkMeasurement(y, u, "update");
+    updateImpl(t, y, u, &deadline);
+    return gmres_.truncated();
+  }
+
+  ///
+  /// @brief Gets the estimate of the state at the time of the latest measurement.
+  /// @return const reference to the estimate of the state.
+  ///
+  const Vector<nx>& x_estimate() const { return x_estimate_; }
+
+  ///
+  /// @brief Gets the estimate of the parameters.
+  /// @return The estimate of the parameters.
+  ///
+  Vector<np> p_estimate() const { return z_.template tail<np>(); }
+
+  ///
+  /// @brief Writes the estimate of the parameters into the data members of an OCP,
+  /// e.g., to reconfigure the MPC by MultipleShootingCGMRESSolver::update_ocp().
+  /// @param[in, out] ocp The OCP.
+  ///
+  void apply_parameters(OCP& ocp) const {
+    continuation_mhe_.get_nlp().set_parameters(ocp, z_.template tail<np>());
+  }
+
+  ///
+  /// @brief Gets the predicted state over the window from the oldest measurement.
+  /// The first MovingHorizonEstimator::window_size() + 1 entries are valid.
+  /// @return const reference to the predicted state over the window.
+  ///
+  const std::array<Vector<nx>, N+1>& x_window() const { return continuation_mhe_.get_nlp().x(); }
+
+  ///
+  /// @brief Gets the number of the intervals of the current window, which is N once
+  /// N+1 measurements have been given.
+  /// @return The number of the intervals of the window.
+  ///
+  int window_size() const { return std::max(continuation_mhe_.get_nlp().num_measurements() - 1, 0); }
+
+  ///
+  /// @brief Gets the l2-norm of the gradient of the least-squares cost before the last update.
+  /// @return The l2-norm of the gradient.
+  ///
+  Scalar optError() const { return continuation_mhe_.optError(); }
+
+  ///
+  /// @brief Get timing result as TimingProfile.
+  /// @return Timing profile.
+  ///
+  TimingProfile getProfile() const {
+    return timer_.getProfile();
+  }
+
+  void disp(std::ostream& os) const {
+    os << "Moving horizon estimator: " << std::endl;
+    os << "  N:    " << N << std::endl;
+    os << "  np:   " << np << std::endl;
+    os << "  kmax: " << kmax << "\n" << std::endl;
+    os << settings_ << std::endl;
+    os << timer_.getProfile() << std::endl;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const MovingHorizonEstimator& estimator) {
+    estimator.disp(os);
+    return os;
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  ContinuationMHE_ continuation_mhe_;
+  MatrixFreeGMRES_ gmres_;
+  SolverSettings settings_;
+  Timer timer_;
+
+  Vector<dim> z_, z_update_;
+  Vector<nx> x_estimate_;
+
+  template <typename VectorType1, typename VectorType2>
+  void checkMeasurement(const MatrixBase<VectorType1>& y, const MatrixBase<VectorType2>& u,
+                        const std::string& name) const {
+    if (y.size() != nx) {
+      throw std::invalid_argument("[MovingHorizonEstimator::" + name + "] y.size() must be " + std::to_string(nx));
+    }
+    if (u.size() != nu) {
+      throw std::invalid_argument("[MovingHorizonEstimator::" + name + "] u.size() must be " + std::to_string(nu));
+    }
+  }
+
+  template <typename VectorType1, typename VectorType2>
+  void updateImpl(const Scalar t, const MatrixBase<VectorType1>& y, const MatrixBase<VectorType2>& u,
+                  const std::chrono::steady_clock::time_point* deadline) {
+    if (settings_.verbose_level >= 1) {
+      std::cout << "\n======================= update estimate with MHE =======================" << std::endl;
+    }
+    if (settings_.profile_solver) timer_.tick();
+    auto& nlp = continuation_mhe_.get_nlp();
+    if (nlp.full()) {
+      // Shifts the window: the predicted state at the second measurement is the new
+      // oldest state and the arrival state.
+      z_.template head<nx>() = nlp.x()[1];
+      nlp.arrival_state() = nlp.x()[1];
+    }
+    nlp.push_measurement(t, y, u);
+    // The previous estimate of the parameters is the prior of the parameters.
+    nlp.parameter_prior() = z_.template tail<np>();
+    z_update_.setZero();
+    const auto gmres_iter
+        = deadline ?
+            gmres_.template solve_until<const Vector<dim>&>(*deadline, continuation_mhe_, z_, z_update_)
+          : gmres_.template solve<const Vector<dim>&>(continuation_mhe_, z_, z_update_);
+    const auto opt_error = continuation_mhe_.optError();
+    z_.noalias() += settings_.sampling_time * z_update_;
+    nlp.rollout(z_);
+    x_estimate_ = nlp.x()[window_size()];
+    if (settings_.profile_solver) timer_.tock();
+
+    // verbose
+    if (settings_.verbose_level >= 1) {
+      std::cout << "opt error: " << opt_error << std::endl;
+    }
+    if (settings_.verbose_level >= 2) {
+      std::cout << "number of GMRES iter: " << gmres_iter << " (kmax: " << kmax << ")" << std::endl;
+      if (deadline && gmres_.truncated()) {
+        std::cout << "GMRES iterations are truncated by the deadline" << std::endl;
+      }
+    }
+  }
+
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__MOVING_HORIZON_ESTIMATOR_HPP_
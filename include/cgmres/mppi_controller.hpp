@@ -0,0 +1,390 @@
+#ifndef CGMRES__MPPI_CONTROLLER_HPP_
+#define CGMRES__MPPI_CONTROLLER_HPP_
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+
+#include "cgmres/types.hpp"
+#include "cgmres/horizon.hpp"
+#include "cgmres/solver_settings.hpp"
+#include "cgmres/timer.hpp"
+
+#include "cgmres/detail/horizon_shift.hpp"
+#include "cgmres/detail/thread_pool.hpp"
+
+namespace cgmres {
+
+///
+/// @class MPPIController
+/// @brief Sampling-based model predictive path integral (MPPI) controller with the
+/// state equation f and the costs L and phi of the OCP, e.g., as a fallback of the
+/// C/GMRES solvers after a large disturbance or a fault. Each update() rolls out
+/// SolverSettings::mppi_num_samples perturbed control input sequences by the
+/// forward Euler method on the thread pool and averages the perturbations with the
+/// exponential weights of the costs. The control input sequence is clamped into the
+/// bounds of the OCP and is warm-started by the shift of the previous one. uopt() can
+/// be passed to MultipleShootingCGMRESSolver::set_u_array() to warm-start the solver.
+/// @tparam OCP A definition of the optimal control problem (OCP).
+/// @tparam N Number of discretizationn grids of the horizon. Must be positive.
+///
+template <class OCP, int N>
+class MPPIController {
+public:
+  ///
+  /// @brief Dimension of the state.
+  ///
+  static constexpr int nx = OCP::nx;
+
+  ///
+  /// @brief Dimension of the control input.
+  ///
+  static constexpr int nu = OCP::nu;
+
+  ///
+  /// @brief Dimension of the equality constraints.
+  ///
+  static constexpr int nc = OCP::nc;
+
+  ///
+  /// @brief Dimension of the concatenation of the control input and equality constraints.
+  ///
+  static constexpr int nuc = nu + nc;
+
+  ///
+  /// @brief Dimension of the bound constraints on the control input.
+  ///
+  static constexpr int nub = OCP::nub;
+
+  ///
+  /// @brief Number of the samples rolled out in one task of the thread pool.
+  /// Each batch has its own random number stream.
+  ///
+  static constexpr int batch_size = 32;
+
+  ///
+  /// @brief Constructs the MPPI controller.
+  /// @param[in] ocp A definition of the optimal control problem (OCP).
+  /// @param[in] horizon Prediction horizon of MPC.
+  /// @param[in] settings Solver settings.
+  /// @param[in] num_threads Number of threads used to roll out the samples. Default is 1.
+  ///
+  MPPIController(const OCP& ocp, const Horizon& horizon,
+                 const SolverSettings& settings, const int num_threads=1)
+    : ocp_(ocp),
+      horizon_(horizon),
+      settings_(settings),
+      thread_pool_(),
+      timer_(),
+      uopt_(),
+      perturbations_(),
+      costs_() {
+    static_assert(OCP::nx > 0);
+    static_assert(OCP::nu > 0);
+    static_assert(N > 0);
+    if (settings.mppi_num_samples <= 0) {
+      throw std::invalid_argument("[MPPIController]: 'settings.mppi_num_samples' must be positive!");
+    }
+    if (settings.mppi_temperature <= 0.0) {
+      throw std::invalid_argument("[MPPIController]: 'settings.mppi_temperature' must be positive!");
+    }
+    if (settings.mppi_noise_std <= 0.0) {
+      throw std::invalid_argument("[MPPIController]: 'settings.mppi_noise_std' must be positive!");
+    }
+    if (num_threads <= 0) {
+      throw std::invalid_argument("[MPPIController]: 'num_threads' must be positive!");
+    }
+    std::fill(uopt_.begin(), uopt_.end(), Vector<nu>::Zero());
+    perturbations_.resize(settings.mppi_num_samples * N * nu, 0.0);
+    costs_.resize(settings.mppi_num_samples, 0.0);
+    thread_pool_ = std::make_unique<detail::ThreadPool>(num_threads);
+  }
+
+  MPPIController(const MPPIController&) = delete;
+
+  MPPIController& operator=(const MPPIController&) = delete;
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~MPPIController() = default;
+
+  ///
+  /// @brief Sets the control input sequence by a constant control input.
+  /// @param[in] u The control input. Size must be MPPIController::nu.
+  ///
+  template <typename VectorType>
+  void set_u(const VectorType& u) {
+    if (u.size() != nu) {
+      throw std::invalid_argument("[MPPIController::set_u] u.size() must be " + std::to_string(nu));
+    }
+    for (auto& e : uopt_) {
+      e = u;
+    }
+    solution_time_ = std::numeric_limits<Scalar>::quiet_NaN();
+  }
+
+  ///
+  /// @brief Sets the control input sequence, e.g., by MultipleShootingCGMRESSolver::uopt().
+  /// @param[in] u_array The control input sequence. Size must be N and the size of
+  /// each entry must be MPPIController::nu.
+  ///
+  template <typename T>
+  void set_u_array(const T& u_array) {
+    if (u_array.size() != N) {
+      throw std::invalid_argument("[MPPIController::set_u_array] u_array.size() must be " + std::to_string(N));
+    }
+    for (size_t i=0; i<N; ++i) {
+      if (u_array[i].size() != nu) {
+        throw std::invalid_argument("[MPPIController::set_u_array] u_array[i].size() must be " + std::to_string(nu));
+      }
+      uopt_[i] = u_array[i];
+    }
+    solution_time_ = std::numeric_limits<Scalar>::quiet_NaN();
+  }
+
+  ///
+  /// @brief Gets the control input sequence.
+  /// @return const reference to the control input sequence.
+  ///
+  const std::array<Vector<nu>, N>& uopt() const { return uopt_; }
+
+  ///
+  /// @brief Gets the control input applied at the initial time of the horizon.
+  /// @return const reference to the control input.
+  ///
+  const Vector<nu>& uopt0() const { return uopt_[0]; }
+
+  ///
+  /// @brief Gets the lowest cost of the samples in the last update.
+  /// @return The lowest cost.
+  ///
+  Scalar min_cost() const { return min_cost_; }
+
+  ///
+  /// @brief Gets the cost of the control input sequence before the last update,
+  /// i.e., that of the noise-free sample.
+  /// @return The cost of the nominal control input sequence.
+  ///
+  Scalar nominal_cost() const { return nominal_cost_; }
+
+  ///
+  /// @brief Gets the effective number of the samples, i.e., (sum w)^2 / sum w^2 with
+  /// the weights w of the samples in the last update. A value close to 1 indicates
+  /// that SolverSettings::mppi_temperature is too small.
+  /// @return The effective number of the samples.
+  ///
+  Scalar effective_samples() const { return effective_samples_; }
+
+  ///
+  /// @brief Gets the number of the samples rolled out in the last update.
+  /// @return The number of the samples.
+  ///
+  size_t num_rollouts() const { return num_rollouts_; }
+
+  ///
+  /// @brief Updates the control input sequence by the MPPI.
+  /// @param[in] t Initial time of the horizon.
+  /// @param[in] x Initial state of the horizon. Size must be MPPIController::nx.
+  ///
+  template <typename VectorType>
+  void update(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[MPPIController::update] x.size() must be " + std::to_string(nx));
+    }
+    updateImpl(t, x, nullptr);
+  }
+
+  ///
+  /// @brief Same as update() but skips the batches of the samples that have not
+  /// started by the deadline. The first batch, which contains the nominal control
+  /// input sequence, is always rolled out.
+  /// @param[in] t Initial time of the horizon.
+  /// @param[in] x Initial state of the horizon. Size must be MPPIController::nx.
+  /// @param[in] deadline Deadline of the rollouts.
+  /// @return true if some samples are skipped by the deadline.
+  ///
+  template <typename VectorType>
+  bool update(const Scalar t, const MatrixBase<VectorType>& x,
+              const std::chrono::steady_clock::time_point& deadline) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[MPPIController::update] x.size() must be " + std::to_string(nx));
+    }
+    updateImpl(t, x, &deadline);
+    return num_rollouts_ < settings_.mppi_num_samples;
+  }
+
+  ///
+  /// @brief Get timing result as TimingProfile.
+  /// @return Timing profile.
+  ///
+  TimingProfile getProfile() const {
+    return timer_.getProfile();
+  }
+
+  void disp(std::ostream& os) const {
+    os << "MPPI controller: " << std::endl;
+    os << "  N:                 " << N << std::endl;
+    os << "  number of threads: " << thread_pool_->num_threads() << "\n" << std::endl;
+    os << settings_ << std::endl;
+    os << timer_.getProfile() << std::endl;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const MPPIController& controller) {
+    controller.disp(os);
+    return os;
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  OCP ocp_;
+  Horizon horizon_;
+  SolverSettings settings_;
+  std::unique_ptr<detail::ThreadPool> thread_pool_;
+  Timer timer_;
+
+  std::array<Vector<nu>, N> uopt_;
+  // Perturbations of the samples after clamping, sample-major.
+  std::vector<Scalar> perturbations_;
+  std::vector<Scalar> costs_;
+  Vector<nx> x0_;
+  Scalar solution_time_ = std::numeric_limits<Scalar>::quiet_NaN();
+  Scalar min_cost_ = std::numeric_limits<Scalar>::quiet_NaN();
+  Scalar nominal_cost_ = std::numeric_limits<Scalar>::quiet_NaN();
+  Scalar effective_samples_ = 0.0;
+  size_t num_rollouts_ = 0;
+  std::uint64_t num_updates_ = 0;
+
+  static std::uint64_t splitmix64(std::uint64_t z) {
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // The stream of a batch depends only on the seed, the update, and the batch so
+  // that the samples do not depend on the number of the threads and the scheduling.
+  std::uint64_t streamSeed(const int batch) const {
+    return splitmix64(splitmix64(splitmix64(settings_.mppi_seed) ^ num_updates_)
+                      ^ static_cast<std::uint64_t>(batch));
+  }
+
+  void shiftSolution(const Scalar t) {
+    if (std::isnan(solution_time_)) return;
+    const Scalar elapsed = t - solution_time_;
+    const Scalar T = horizon_.T(solution_time_);
+    if (!(elapsed > 0.0) || T <= 0.0) return;
+    detail::shift_trajectory(uopt_, N * elapsed / T, horizon_.T(t) / T);
+  }
+
+  void rolloutBatch(const int batch, const Scalar t, const Scalar dt,
+                    const std::chrono::steady_clock::time_point* deadline) {
+    const size_t begin = static_cast<size_t>(batch) * batch_size;
+    const size_t end = std::min(begin + batch_size, settings_.mppi_num_samples);
+    if (deadline && batch > 0 && std::chrono::steady_clock::now() >= *deadline) {
+      std::fill(costs_.begin()+begin, costs_.begin()+end, std::numeric_limits<Scalar>::infinity());
+      return;
+    }
+    std::mt19937_64 rng(streamSeed(batch));
+    std::normal_distribution<Scalar> noise(0.0, settings_.mppi_noise_std);
+    Vector<nx> x, dx;
+    // The Lagrange multipliers of the equality constraints are zero.
+    Vector<nuc> u = Vector<nuc>::Zero();
+    for (size_t k=begin; k<end; ++k) {
+      Scalar* eps = perturbations_.data() + k * N * nu;
+      x = x0_;
+      Scalar cost = 0.0;
+      for (int i=0; i<N; ++i) {
+        for (int j=0; j<nu; ++j) {
+          // The first sample is the nominal control input sequence.
+          u.coeffRef(j) = uopt_[i].coeff(j) + ((k == 0) ? 0.0 : noise(rng));
+        }
+        if constexpr (nub > 0) {
+          for (int j=0; j<nub; ++j) {
+            const auto uj = OCP::ubound_indices[j];
+            u.coeffRef(uj) = std::min(std::max(u.coeff(uj), ocp_.umin[j]), ocp_.umax[j]);
+          }
+        }
+        for (int j=0; j<nu; ++j) {
+          eps[i*nu+j] = u.coeff(j) - uopt_[i].coeff(j);
+        }
+        const Scalar ti = t + i * dt;
+        cost += dt * ocp_.eval_L(ti, x.data(), u.data());
+        ocp_.eval_f(ti, x.data(), u.data(), dx.data());
+        x.noalias() += dt * dx;
+      }
+      cost += ocp_.eval_phi(t + N * dt, x.data());
+      costs_[k] = std::isfinite(cost) ? cost : std::numeric_limits<Scalar>::infinity();
+    }
+  }
+
+  template <typename VectorType>
+  void updateImpl(const Scalar t, const MatrixBase<VectorType>& x,
+                  const std::chrono::steady_clock::time_point* deadline) {
+    if (settings_.verbose_level >= 1) {
+      std::cout << "\n======================= update control input by MPPI =======================" << std::endl;
+    }
+    if (settings_.profile_solver) timer_.tick();
+    shiftSolution(t);
+    solution_time_ = t;
+    x0_ = x;
+    const Scalar dt = horizon_.T(t) / N;
+    const size_t K = settings_.mppi_num_samples;
+    const int num_batches = (K + batch_size - 1) / batch_size;
+    thread_pool_->parallel_for(num_batches, [&](const int batch) {
+      rolloutBatch(batch, t, dt, deadline);
+    });
+    ++num_updates_;
+
+    nominal_cost_ = costs_[0];
+    min_cost_ = *std::min_element(costs_.begin(), costs_.end());
+    num_rollouts_ = std::count_if(costs_.begin(), costs_.end(),
+                                  [](const Scalar c) { return c < std::numeric_limits<Scalar>::infinity(); });
+    if (std::isfinite(min_cost_)) {
+      // costs_ holds the weights from here.
+      Scalar sum = 0.0, sum_sq = 0.0;
+      for (auto& e : costs_) {
+        e = std::exp(- (e - min_cost_) / settings_.mppi_temperature);
+        sum += e;
+        sum_sq += e * e;
+      }
+      effective_samples_ = sum * sum / sum_sq;
+      thread_pool_->parallel_for(N, [&](const int i) {
+        Vector<nu> du = Vector<nu>::Zero();
+        for (size_t k=0; k<K; ++k) {
+          if (costs_[k] > 0.0) {
+            du.noalias() += costs_[k] * Map<const Vector<nu>>(perturbations_.data() + (k*N+i)*nu);
+          }
+        }
+        uopt_[i].noalias() += du / sum;
+      });
+    }
+    else {
+      effective_samples_ = 0.0;
+    }
+    if (settings_.profile_solver) timer_.tock();
+
+    // verbose
+    if (settings_.verbose_level >= 1) {
+      std::cout << "min cost: " << min_cost_ << std::endl;
+    }
+    if (settings_.verbose_level >= 2) {
+      std::cout << "number of rollouts: " << num_rollouts_ << " (samples: " << K << ")" << std::endl;
+      std::cout << "effective samples: " << effective_samples_ << std::endl;
+    }
+  }
+
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__MPPI_CONTROLLER_HPP_
@@ -2,16 +2,30 @@
 #define CGMRES__MULTIPLE_SHOOTING_CGMRES_SOLVER_HPP_
 
 #include <array>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <optional>
 #include <stdexcept>
 #include <iostream>
 
 #include "cgmres/types.hpp"
 #include "cgmres/solver_settings.hpp"
 #include "cgmres/timer.hpp"
+#include "cgmres/input_interpolation.hpp"
+#include "cgmres/solver_health.hpp"
+#include "cgmres/zero_horizon_ocp_solver.hpp"
 
 #include "cgmres/detail/matrixfree_gmres.hpp"
+#include "cgmres/detail/broyden_jacobian.hpp"
 #include "cgmres/detail/multiple_shooting_nlp.hpp"
+#include "cgmres/detail/multiple_shooting_scenario_nlp.hpp"
 #include "cgmres/detail/continuation_gmres_condensing.hpp"
+#include "cgmres/detail/horizon_shift.hpp"
+#include "cgmres/detail/solver_state.hpp"
+#include "cgmres/detail/phase_profiler.hpp"
 
 namespace cgmres {
 
@@ -20,6 +34,8 @@ namespace cgmres {
 /// @brief Multiple-shooting C/GMRES solver for nonlinear MPC. 
 /// @tparam OCP A definition of the optimal control problem (OCP).
 /// @tparam N Number of discretizationn grids of the horizon. Must be positive.
+/// This is the maximum number: the number of the grids actually used can be 
+/// reduced at runtime by set_active_N() without reallocation.
 /// @tparam kmax Maximum number of the GMRES iterations. Must be positive.
 ///
 template <class OCP, int N, int kmax>
@@ -58,6 +74,8 @@ public:
   using MultipleShootingNLP_ = detail::MultipleShootingNLP<OCP, N>;
   using ContinuationGMRES_ = detail::ContinuationGMRESCondensing<MultipleShootingNLP_>;
   using MatrixFreeGMRES_ = detail::MatrixFreeGMRES<ContinuationGMRES_, kmax>;
+  using FixedTimeLinearProblem_ = detail::FixedTimeLinearProblem<ContinuationGMRES_>;
+  using BroydenJacobian_ = detail::BroydenJacobian<ContinuationGMRES_>;
 
   ///
   /// @brief Constructs the multiple-shooting C/GMRES solver.
@@ -67,11 +85,14 @@ public:
   ///
   MultipleShootingCGMRESSolver(const OCP& ocp, const Horizon& horizon, 
                                const SolverSettings& settings) 
-    : continuation_gmres_(MultipleShootingNLP_(ocp, horizon), settings.finite_difference_epsilon, settings.zeta),
+    : continuation_gmres_(MultipleShootingNLP_(ocp, horizon), settings.finite_difference_epsilon, settings.zeta, 
+                          settings.use_jvp),
       gmres_(),
       settings_(settings),
+      zero_horizon_solver_(),
       solution_(Vector<dim>::Zero()),
-      solution_update_(Vector<dim>::Zero()) {
+      solution_update_(Vector<dim>::Zero()),
+      fixed_time_update_(Vector<dim>::Zero()) {
     std::fill(uopt_.begin(), uopt_.end(), Vector<nu>::Zero());
     std::fill(ucopt_.begin(), ucopt_.end(), Vector<nuc>::Zero());
     std::fill(xopt_.begin(), xopt_.end(), Vector<nx>::Zero());
@@ -90,6 +111,40 @@ public:
     if (settings.zeta <= 0.0) {
       throw std::invalid_argument("[ContinuationGMRESCondensing]: 'settings.zeta' must be positive!");
     }
+    if (settings.sensitivity_steps == 0) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver]: 'settings.sensitivity_steps' must be positive!");
+    }
+    if (settings.parameter_sensitivity) {
+      sensitivity_buffer_.resize(2 * state_size);
+    }
+    if (settings.homotopy_stages == 0) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver]: 'settings.homotopy_stages' must be positive!");
+    }
+    if (settings.health_check) {
+      if (settings.health_opterr_growth <= 1.0) {
+        throw std::invalid_argument("[MultipleShootingCGMRESSolver]: 'settings.health_opterr_growth' must be larger than 1!");
+      }
+      if (settings.health_opterr_floor < 0.0) {
+        throw std::invalid_argument("[MultipleShootingCGMRESSolver]: 'settings.health_opterr_floor' must be non-negative!");
+      }
+      if (settings.rollback_depth == 0) {
+        throw std::invalid_argument("[MultipleShootingCGMRESSolver]: 'settings.rollback_depth' must be positive!");
+      }
+      // One more slot for the state before the step of the current update.
+      rollback_buffer_.resize((settings.rollback_depth + 1) * state_size);
+    }
+    if (settings.jacobian_reuse) {
+      if (settings.jacobian_refresh_period == 0) {
+        throw std::invalid_argument("[MultipleShootingCGMRESSolver]: 'settings.jacobian_refresh_period' must be positive!");
+      }
+      if (settings.quasi_newton_tol <= 0.0) {
+        throw std::invalid_argument("[MultipleShootingCGMRESSolver]: 'settings.quasi_newton_tol' must be positive!");
+      }
+      if (settings.jacobian_assembly_time <= 0.0) {
+        throw std::invalid_argument("[MultipleShootingCGMRESSolver]: 'settings.jacobian_assembly_time' must be positive!");
+      }
+      broyden_jacobian_ = BroydenJacobian_(settings.jacobian_refresh_period, settings.quasi_newton_tol);
+    }
   }
 
   ///
@@ -151,6 +206,7 @@ public:
     for (size_t i=1; i<=N; ++i) {
       xopt_[i] = x;
     }
+    clearInactiveSolution();
   }
 
   ///
@@ -165,6 +221,7 @@ public:
     for (size_t i=1; i<=N; ++i) {
       lmdopt_[i] = lmd;
     }
+    clearInactiveSolution();
   }
 
   ///
@@ -179,6 +236,7 @@ public:
     for (size_t i=0; i<N; ++i) {
       dummyopt_[i] = dummy;
     }
+    clearInactiveSolution();
   }
 
   ///
@@ -193,6 +251,7 @@ public:
     for (size_t i=0; i<N; ++i) {
       muopt_[i] = mu;
     }
+    clearInactiveSolution();
   }
 
   ///
@@ -249,6 +308,7 @@ public:
       }
       xopt_[i] = x_array[i];
     }
+    clearInactiveSolution();
   }
 
   ///
@@ -266,6 +326,7 @@ public:
       }
       lmdopt_[i] = lmd_array[i];
     }
+    clearInactiveSolution();
   }
 
   ///
@@ -284,6 +345,7 @@ public:
       }
       dummyopt_[i] = dummy_array[i];
     }
+    clearInactiveSolution();
   }
 
   ///
@@ -302,6 +364,7 @@ public:
       }
       muopt_[i] = mu_array[i];
     }
+    clearInactiveSolution();
   }
 
   ///
@@ -315,6 +378,9 @@ public:
       throw std::invalid_argument("[MultipleShootingCGMRESSolver::init_x] x.size() must be " + std::to_string(nx));
     }
     continuation_gmres_.retrieve_x(t, x, solution_, xopt_);
+    solution_time_ = t;
+    event_t_ = std::numeric_limits<Scalar>::quiet_NaN();
+    broyden_jacobian_.invalidate();
   }
 
   ///
@@ -328,6 +394,7 @@ public:
       throw std::invalid_argument("[MultipleShootingCGMRESSolver::init_lmd] x.size() must be " + std::to_string(nx));
     }
     continuation_gmres_.retrieve_lmd(t, x, solution_, xopt_, lmdopt_);
+    broyden_jacobian_.invalidate();
   }
 
   ///
@@ -342,6 +409,9 @@ public:
     }
     continuation_gmres_.retrieve_x(t, x, solution_, xopt_);
     continuation_gmres_.retrieve_lmd(t, x, solution_, xopt_, lmdopt_);
+    solution_time_ = t;
+    event_t_ = std::numeric_limits<Scalar>::quiet_NaN();
+    broyden_jacobian_.invalidate();
   }
 
   ///
@@ -350,8 +420,46 @@ public:
   void init_dummy_mu() {
     continuation_gmres_.retrieve_dummy(solution_, dummyopt_, muopt_, settings_.min_dummy);
     continuation_gmres_.retrieve_mu(solution_, dummyopt_, muopt_);
+    broyden_jacobian_.invalidate();
   }
 
+  ///
+  /// @brief Sets the number of the discretization grids used over the horizon. 
+  /// The current trajectories are resampled onto the new grids by linear interpolation 
+  /// so that the solver continues from them without re-initialization. The entries 
+  /// of the solution from the active number of the grids are zero.
+  /// @param[in] active_N Number of the grids. Must be in [1, N].
+  ///
+  void set_active_N(const int active_N) {
+    if (active_N <= 0 || active_N > N) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver::set_active_N] active_N must be in [1, " + std::to_string(N) + "]");
+    }
+    const int prev_active_N = continuation_gmres_.get_nlp().active_N();
+    if (active_N == prev_active_N) return;
+    // The i-th grid of the new horizon is at the grid position i * prev_active_N / active_N.
+    const Scalar scale = static_cast<Scalar>(prev_active_N) / static_cast<Scalar>(active_N);
+    detail::resample_trajectory(ucopt_, prev_active_N, active_N, scale);
+    detail::resample_trajectory(xopt_, prev_active_N+1, active_N+1, scale);
+    detail::resample_trajectory(lmdopt_, prev_active_N+1, active_N+1, scale);
+    if constexpr (nub > 0) {
+      detail::resample_trajectory(dummyopt_, prev_active_N, active_N, scale);
+      detail::resample_trajectory(muopt_, prev_active_N, active_N, scale);
+    }
+    continuation_gmres_.get_nlp().set_active_N(active_N);
+    for (size_t i=0; i<N; ++i) {
+      solution_.template segment<nuc>(i*nuc) = ucopt_[i];
+    }
+    solution_update_.setZero();
+    clearInactiveSolution();
+    retrieveSolution();
+  }
+
+  ///
+  /// @brief Gets the number of the discretization grids used over the horizon.
+  /// @return The number of the grids. 
+  ///
+  int active_N() const { return continuation_gmres_.get_nlp().active_N(); }
+
   ///
   /// @brief Getter of the optimal solution.
   /// @return const reference to the optimal control input vectors over the horizon.
@@ -388,6 +496,82 @@ public:
   ///
   const std::array<Vector<nub>, N>& muopt() const { return muopt_; }
 
+  ///
+  /// @brief Gets the time that the current solution is computed for, i.e., the 
+  /// time of the last update plus SolverSettings::sampling_time, or the time 
+  /// given to init_x() or init_x_lmd(). NaN if it is unknown.
+  /// @return The time of the current solution.
+  ///
+  Scalar solution_time() const { return solution_time_; }
+
+  ///
+  /// @brief Queries the control input at a time in continuous time by interpolating
+  /// the optimal control input over the grids of the current solution, e.g., to run
+  /// the actuator loop at a higher rate than update(). The result is valid until
+  /// the next update. The control input is held before solution_time() and after
+  /// the last grid of the horizon.
+  /// @param[in] t Time of the query.
+  /// @param[in] method Interpolation method. Default is InputInterpolation::ZeroOrderHold.
+  /// @return The control input at t.
+  ///
+  Vector<nu> u_at(const Scalar t,
+                  const InputInterpolation method=InputInterpolation::ZeroOrderHold) const {
+    if (std::isnan(solution_time_)) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver::u_at] the time of the solution is unknown! Call init_x(), init_x_lmd(), or update() first.");
+    }
+    const Scalar T = continuation_gmres_.get_nlp().horizon().T(solution_time_);
+    const int active_N = continuation_gmres_.get_nlp().active_N();
+    const Scalar pos = (T > 0.0) ? active_N * (t - solution_time_) / T : 0.0;
+    return detail::interpolate_trajectory(uopt_, pos, active_N, method);
+  }
+
+  ///
+  /// @brief Gets the number of the updates in which the C/GMRES step is performed.
+  /// @return The number of the executed updates.
+  ///
+  std::size_t num_executed_updates() const { return num_executed_updates_; }
+
+  ///
+  /// @brief Gets the number of the updates skipped by the event trigger 
+  /// (see SolverSettings::event_triggered).
+  /// @return The number of the skipped updates.
+  ///
+  std::size_t num_skipped_updates() const { return num_skipped_updates_; }
+
+  ///
+  /// @brief Gets the result of the health check of the last update 
+  /// (see SolverSettings::health_check).
+  /// @return The result of the health check.
+  ///
+  SolverHealth health() const { return health_; }
+
+  ///
+  /// @brief Gets the number of the rollbacks to the snapshots of the healthy solutions.
+  /// @return The number of the rollbacks.
+  ///
+  std::size_t num_rollbacks() const { return num_rollbacks_; }
+
+  ///
+  /// @brief Gets the number of the re-initializations by ZeroHorizonOCPSolver 
+  /// after unhealthy updates.
+  /// @return The number of the re-initializations.
+  ///
+  std::size_t num_reinits() const { return num_reinits_; }
+
+  ///
+  /// @brief Gets the number of the assemblies of the condensed Jacobian 
+  /// (see SolverSettings::jacobian_reuse).
+  /// @return The number of the assemblies of the Jacobian.
+  ///
+  std::size_t num_jacobian_refreshes() const { return broyden_jacobian_.num_refreshes(); }
+
+  ///
+  /// @brief Gets the number of the updates that fall back to the matrix-free GMRES 
+  /// since the quasi-Newton step fails the residual test (see SolverSettings::jacobian_reuse).
+  /// @return The number of the fallbacks to the matrix-free GMRES.
+  ///
+  std::size_t num_quasi_newton_fallbacks() const { return broyden_jacobian_.num_fallbacks(); }
+
   ///
   /// @brief Gets the l2-norm of the current optimality errors.
   /// @return The l2-norm of the current optimality errors.
@@ -410,6 +594,74 @@ public:
     return optError();
   }
 
+  ///
+  /// @brief Replaces the OCP, e.g., by that with the model parameters after a fault 
+  /// onset or a new reference, and corrects the solution by the first-order parametric 
+  /// sensitivity: the directional derivative of the optimality conditions along the 
+  /// change of the OCP is solved by GMRES with the condensed operator of the C/GMRES 
+  /// method and the solution and the trajectories are corrected accordingly. 
+  /// A correction step is kept only if it decreases the optimality error of the new 
+  /// OCP. The linear predictor is accurate for small changes, e.g., of the references 
+  /// and weights, but is often rejected for large changes of the dynamics, e.g., 
+  /// a complete loss of a rotor. Then the solution is the same as that of a plain 
+  /// replacement of the OCP (see also homotopy_reinit()). 
+  /// Call it at the time of the current solution, e.g., right before update().
+  /// @param[in] t Initial time of the horizon. 
+  /// @param[in] x Initial state of the horizon. Size must be MultipleShootingCGMRESSolver::nx.
+  /// @param[in] ocp The new OCP.
+  /// @return The number of the GMRES iterations.
+  ///
+  template <typename VectorType>
+  int update_ocp(const Scalar t, const MatrixBase<VectorType>& x, const OCP& ocp) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver::update_ocp] x.size() must be " + std::to_string(nx));
+    }
+    continuation_gmres_.synchronize_ocp(); 
+    continuation_gmres_.eval_fonc(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_);
+    continuation_gmres_.get_nlp().set_ocp(ocp);
+    continuation_gmres_.synchronize_ocp(); 
+    // The re-initializer is constructed again with the new OCP when it is needed.
+    zero_horizon_solver_.reset();
+    broyden_jacobian_.invalidate();
+    return parametricCorrection(t, x);
+  }
+
+  ///
+  /// @brief Re-initializes the solution for a changed OCP, e.g., from the nominal 
+  /// model to the faulted one, by a homotopy from the current solution. The OCP is 
+  /// deformed over SolverSettings::homotopy_stages stages. At each stage, the solution 
+  /// is predicted by the parametric sensitivity (see update_ocp()) and corrected by 
+  /// at most SolverSettings::homotopy_corrector_iter Newton-GMRES steps at the fixed 
+  /// time until the optimality error is below SolverSettings::opterr_tol. The number 
+  /// of the GMRES iterations is therefore bounded by 
+  /// homotopy_stages * (sensitivity_steps + homotopy_corrector_iter) * kmax. 
+  /// The optimality error after the re-initialization is given by optError().
+  /// @param[in] t Initial time of the horizon, i.e., the time of the current solution. 
+  /// @param[in] x Initial state of the horizon. Size must be MultipleShootingCGMRESSolver::nx.
+  /// @param[in] ocp_at Homotopy of the OCP, a callable that returns the OCP at 
+  /// the homotopy parameter s in (0, 1]. ocp_at(1) is the target OCP and 
+  /// ocp_at(s) should tend to the current OCP as s tends to 0.
+  /// @return The number of the GMRES iterations.
+  ///
+  template <typename VectorType, typename OCPHomotopy>
+  int homotopy_reinit(const Scalar t, const MatrixBase<VectorType>& x, const OCPHomotopy& ocp_at) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver::homotopy_reinit] x.size() must be " + std::to_string(nx));
+    }
+    int gmres_iter = 0;
+    for (size_t stage=1; stage<=settings_.homotopy_stages; ++stage) {
+      const Scalar s = static_cast<Scalar>(stage) / static_cast<Scalar>(settings_.homotopy_stages);
+      gmres_iter += update_ocp(t, x, ocp_at(s));
+      for (size_t i=0; i<settings_.homotopy_corrector_iter; ++i) {
+        continuation_gmres_.eval_fonc(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_);
+        if (continuation_gmres_.optError() < settings_.opterr_tol) break;
+        gmres_iter += fixedTimeStep(t, x, false);
+      }
+    }
+    continuation_gmres_.eval_fonc(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_);
+    return gmres_iter;
+  }
+
   ///
   /// @brief Updates the solution by performing C/GMRES method.
   /// @param[in] t Initial time of the horizon. 
@@ -420,49 +672,116 @@ public:
     if (x.size() != nx) {
       throw std::invalid_argument("[MultipleShootingCGMRESSolver::update] x.size() must be " + std::to_string(nx));
     }
-    if (settings_.verbose_level >= 1) {
-      std::cout << "\n======================= update solution with C/GMRES =======================" << std::endl;
+    updateImpl(t, x, nullptr);
+  }
+
+  ///
+  /// @brief Updates the solution by performing C/GMRES method within a deadline. 
+  /// The deadline is checked on a monotonic clock between the Arnoldi steps of the GMRES. 
+  /// If it has passed, the GMRES stops and the solution is updated with the best 
+  /// available update direction, i.e., that of the Krylov subspace built so far 
+  /// (the previous direction if no Arnoldi step has been performed). If 
+  /// SolverSettings::jacobian_reuse is true, the assembly of the Jacobian in this 
+  /// update is also stopped so that the update ends before the deadline.
+  /// @param[in] t Initial time of the horizon. 
+  /// @param[in] x Initial state of the horizon. Size must be MultipleShootingCGMRESSolver::nx.
+  /// @param[in] deadline Deadline of the GMRES iterations.
+  /// @return true if the GMRES iterations are truncated by the deadline. false if 
+  /// the update is skipped by the event trigger. 
+  ///
+  template <typename VectorType>
+  bool update(const Scalar t, const MatrixBase<VectorType>& x, 
+              const std::chrono::steady_clock::time_point& deadline) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver::update] x.size() must be " + std::to_string(nx));
     }
+    return updateImpl(t, x, &deadline) && !quasi_newton_step_ && gmres_.truncated();
+  }
 
-    if (settings_.profile_solver) timer_.tick();
-    continuation_gmres_.synchronize_ocp(); 
-    const auto gmres_iter 
-        = gmres_.template solve<const Scalar, const MatrixBase<VectorType>&, const Vector<dim>&,
-                                const std::array<Vector<nx>, N+1>&, const std::array<Vector<nx>, N+1>&,
-                                const std::array<Vector<nub>, N>&, const std::array<Vector<nub>, N>&>(
-              continuation_gmres_, t, x.derived(), solution_, xopt_, lmdopt_, dummyopt_, muopt_, solution_update_);
-    const auto opt_error = continuation_gmres_.optError();
-    continuation_gmres_.expansion(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_, 
-                                  solution_update_, settings_.sampling_time, settings_.min_dummy);
-    solution_.noalias() += settings_.sampling_time * solution_update_;
-    retrieveSolution();
-    if (settings_.profile_solver) timer_.tock();
+  ///
+  /// @brief Size in bytes of the solver state written by save_state().
+  ///
+  static constexpr std::size_t state_size = detail::solver_state_size(2*dim + 2*(N+1)*nx + 2*N*nub + 2 + ContinuationGMRES_::state_dim);
 
-    // verbose
-    if (settings_.verbose_level >= 1) {
-      std::cout << "opt error: " << opt_error << std::endl;
+  ///
+  /// @brief Saves the solver state, i.e., the active number of the grids, the solution, its update, the trajectories of the state, costate, dummy input and 
+  /// Lagrange multiplier and the residuals of the 
+  /// continuation, as a flat versioned binary blob. The blob can be copied by memcpy 
+  /// and restored by load_state() of a solver of the same type. Does not allocate memory.
+  /// @param[out] data Pointer to preallocated memory. 
+  /// @param[in] size Size of the memory in bytes. Must be no less than MultipleShootingCGMRESSolver::state_size.
+  ///
+  void save_state(void* data, const std::size_t size) const {
+    if (data == nullptr || size < state_size) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver::save_state] size must be at least " + std::to_string(state_size));
     }
-    if (settings_.verbose_level >= 2) {
-      std::cout << "number of GMRES iter: " << gmres_iter << " (kmax: " << kmax << ")" << std::endl;
+    detail::SolverStateWriter writer(data);
+    writer.write(stateHeader());
+    writer.write(static_cast<Scalar>(active_N()));
+    writer.write(solution_);
+    writer.write(solution_update_);
+    writer.write(xopt_);
+    writer.write(lmdopt_);
+    writer.write(dummyopt_);
+    writer.write(muopt_);
+    writer.write(solution_time_);
+    continuation_gmres_.save_state(writer);
+  }
+
+  ///
+  /// @brief Restores the solver state saved by save_state(). Does not allocate memory.
+  /// @param[in] data Pointer to the state. 
+  /// @param[in] size Size of the memory in bytes. Must be no less than MultipleShootingCGMRESSolver::state_size.
+  ///
+  void load_state(const void* data, const std::size_t size) {
+    detail::check_solver_state_header(data, size, stateHeader(), "MultipleShootingCGMRESSolver::load_state");
+    detail::SolverStateReader reader(data);
+    Scalar active_N;
+    reader.read(active_N);
+    if (!(active_N >= 1 && active_N <= N)) {
+      throw std::invalid_argument("[MultipleShootingCGMRESSolver::load_state] active N of the state is out of range");
     }
+    continuation_gmres_.get_nlp().set_active_N(static_cast<int>(active_N));
+    reader.read(solution_);
+    reader.read(solution_update_);
+    reader.read(xopt_);
+    reader.read(lmdopt_);
+    reader.read(dummyopt_);
+    reader.read(muopt_);
+    reader.read(solution_time_);
+    continuation_gmres_.load_state(reader);
+    retrieveSolution();
+    broyden_jacobian_.invalidate();
   }
 
   ///
-  /// @brief Get timing result as TimingProfile.
+  /// @brief Get timing result as TimingProfile. If CGMRES_ENABLE_PHASE_PROFILING is 
+  /// defined, TimingProfile::phases breaks the time down into the OCP synchronization, 
+  /// the right-hand side, the operator, the Arnoldi process, the Givens rotations and 
+  /// back substitution, the expansion, and the retrieval of the solution.
   /// @return Timing profile.
   ///
   TimingProfile getProfile() const {
-    return timer_.getProfile();
+    auto profile = timer_.getProfile();
+    detail::append_phase(profile, "ocp sync", ocp_sync_timer_);
+    detail::append_phase(profile, "rhs", continuation_gmres_.rhs_timer());
+    detail::append_phase(profile, "operator", continuation_gmres_.operator_timer());
+    detail::append_phase(profile, "arnoldi", gmres_.arnoldi_timer());
+    detail::append_phase(profile, "givens", gmres_.givens_timer());
+    detail::append_phase(profile, "expansion", continuation_gmres_.expansion_timer());
+    detail::append_phase(profile, "retrieval", retrieval_timer_);
+    return profile;
   }
 
   void disp(std::ostream& os) const {
     os << "Multiple shooting CGMRES solver: " << std::endl;
     os << "  N:    " << N << std::endl;
+    os << "  active N: " << active_N() << std::endl;
     os << "  kmax: " << kmax << "\n" << std::endl;
     os << continuation_gmres_.get_nlp().ocp() << std::endl;
     os << continuation_gmres_.get_nlp().horizon() << std::endl;
     os << settings_ << std::endl;
-    os << timer_.getProfile() << std::endl;
+    os << getProfile() << std::endl;
   }
 
   friend std::ostream& operator<<(std::ostream& os, const MultipleShootingCGMRESSolver& solver) {
@@ -475,8 +794,11 @@ public:
 private:
   ContinuationGMRES_ continuation_gmres_;
   MatrixFreeGMRES_ gmres_;
+  BroydenJacobian_ broyden_jacobian_;
   SolverSettings settings_;
   Timer timer_;
+  detail::PhaseTimer ocp_sync_timer_, retrieval_timer_;
+  std::optional<ZeroHorizonOCPSolver<OCP, kmax>> zero_horizon_solver_;
 
   std::array<Vector<nu>, N> uopt_;
   std::array<Vector<nuc>, N> ucopt_;
@@ -485,12 +807,364 @@ private:
   std::array<Vector<nub>, N> dummyopt_;
   std::array<Vector<nub>, N> muopt_;
 
-  Vector<dim> solution_, solution_update_; 
+  Vector<dim> solution_, solution_update_, fixed_time_update_; 
+  Scalar solution_time_ = std::numeric_limits<Scalar>::quiet_NaN();
+
+  Vector<nx> event_x_;
+  Scalar event_t_ = std::numeric_limits<Scalar>::quiet_NaN();
+  std::size_t num_executed_updates_ = 0;
+  std::size_t num_skipped_updates_ = 0;
+  std::size_t consecutive_skips_ = 0;
+
+  std::vector<char> rollback_buffer_, sensitivity_buffer_;
+  std::size_t rollback_head_ = 0;
+  std::size_t rollback_count_ = 0;
+  std::size_t consecutive_rollbacks_ = 0;
+  std::size_t num_rollbacks_ = 0;
+  std::size_t num_reinits_ = 0;
+  Scalar last_healthy_opt_error_ = std::numeric_limits<Scalar>::quiet_NaN();
+  SolverHealth health_ = SolverHealth::Healthy;
+  bool quasi_newton_step_ = false;
+  std::chrono::steady_clock::time_point assembly_end_;
+  std::chrono::steady_clock::duration update_tail_time_ = std::chrono::steady_clock::duration::zero();
+
+  // Checks the trigger of the event-triggered update. The state is predicted by the 
+  // linear interpolation between the state of the last executed update and xopt_[1].
+  // The update is never skipped if the parameters of the OCP have been changed.
+  template <typename VectorType>
+  bool skipUpdate(const Scalar t, const MatrixBase<VectorType>& x) const {
+    if (consecutive_skips_ >= settings_.event_max_skips) return false;
+    if (continuation_gmres_.get_nlp().ocp_parameters_changed()) return false;
+    if (std::isnan(solution_time_) || std::isnan(event_t_)) return false;
+    if (!(continuation_gmres_.optError() < settings_.event_opterr_tol)) return false;
+    const auto& horizon = continuation_gmres_.get_nlp().horizon();
+    const Scalar t1 = solution_time_ + horizon.T(solution_time_) / continuation_gmres_.get_nlp().active_N();
+    const Scalar w = (t1 > event_t_) ? std::min(std::max((t - event_t_) / (t1 - event_t_), 0.0), 1.0) : 1.0;
+    const Scalar prediction_error = (x - event_x_ - w * (xopt_[1] - event_x_)).template lpNorm<2>();
+    return (prediction_error < settings_.event_state_tol);
+  }
+
+  // Returns false if the update is skipped by the event trigger.
+  template <typename VectorType>
+  bool updateImpl(const Scalar t, const MatrixBase<VectorType>& x, 
+                  const std::chrono::steady_clock::time_point* deadline) {
+    if (settings_.verbose_level >= 1) {
+      std::cout << "\n======================= update solution with C/GMRES =======================" << std::endl;
+    }
+
+    if (settings_.event_triggered && skipUpdate(t, x)) {
+      // Reuses the previous solution shifted to the time of the next update.
+      shiftSolution(t + settings_.sampling_time);
+      solution_time_ = t + settings_.sampling_time;
+      ++num_skipped_updates_;
+      ++consecutive_skips_;
+      if (settings_.verbose_level >= 1) {
+        std::cout << "update skipped (event-triggered)" << std::endl;
+      }
+      return false;
+    }
+
+    if (settings_.profile_solver) timer_.tick();
+    // The state before the step is kept as a snapshot only if this update is healthy, 
+    // since the optimality error of this update is that of the state before the step.
+    const bool initial_snapshot = settings_.health_check && (rollback_count_ == 0);
+    if (settings_.health_check) {
+      save_state(rollback_buffer_.data() + rollback_head_ * state_size, state_size);
+      // The initial guess is the snapshot of the first update to roll back to.
+      if (initial_snapshot) commitSnapshot();
+    }
+    if (settings_.shift_warm_start) {
+      shiftSolution(t);
+    }
+    if (settings_.parameter_sensitivity && !std::isnan(solution_time_)
+          && continuation_gmres_.get_nlp().ocp_parameters_changed()) {
+      // Optimality conditions before and after the synchronization.
+      continuation_gmres_.eval_fonc(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_);
+      continuation_gmres_.synchronize_ocp(); 
+      parametricCorrection(t, x);
+    }
+    {
+      CGMRES_PHASE_PROBE(ocp_sync_timer_);
+      if (settings_.jacobian_reuse && continuation_gmres_.get_nlp().ocp_parameters_changed()) {
+        broyden_jacobian_.invalidate();
+      }
+      continuation_gmres_.synchronize_ocp(); 
+    }
+    quasi_newton_step_ 
+        = settings_.jacobian_reuse 
+            && broyden_jacobian_.template solve<const Scalar, const MatrixBase<VectorType>&, const Vector<dim>&,
+                                                const std::array<Vector<nx>, N+1>&, const std::array<Vector<nx>, N+1>&,
+                                                const std::array<Vector<nub>, N>&, const std::array<Vector<nub>, N>&>(
+                continuation_gmres_, t, x.derived(), solution_, xopt_, lmdopt_, dummyopt_, muopt_, solution_update_);
+    const auto gmres_iter 
+        = quasi_newton_step_ ? 0 
+        : deadline ? 
+            gmres_.template solve_until<const Scalar, const MatrixBase<VectorType>&, const Vector<dim>&,
+                                        const std::array<Vector<nx>, N+1>&, const std::array<Vector<nx>, N+1>&,
+                                        const std::array<Vector<nub>, N>&, const std::array<Vector<nub>, N>&>(
+                *deadline, continuation_gmres_, t, x.derived(), solution_, xopt_, lmdopt_, dummyopt_, muopt_, solution_update_)
+          : gmres_.template solve<const Scalar, const MatrixBase<VectorType>&, const Vector<dim>&,
+                                  const std::array<Vector<nx>, N+1>&, const std::array<Vector<nx>, N+1>&,
+                                  const std::array<Vector<nub>, N>&, const std::array<Vector<nub>, N>&>(
+                continuation_gmres_, t, x.derived(), solution_, xopt_, lmdopt_, dummyopt_, muopt_, solution_update_);
+    if (settings_.jacobian_reuse) {
+      // The assembly of the next Jacobian proceeds within SolverSettings::jacobian_assembly_time. 
+      // It also leaves the rest of this update, which takes about as long as that of the 
+      // previous update, before the deadline.
+      const auto until = std::chrono::steady_clock::now() 
+                          + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<Scalar>(settings_.jacobian_assembly_time));
+      broyden_jacobian_.template assemble<const Scalar, const MatrixBase<VectorType>&, const Vector<dim>&,
+                                          const std::array<Vector<nx>, N+1>&, const std::array<Vector<nx>, N+1>&,
+                                          const std::array<Vector<nub>, N>&, const std::array<Vector<nub>, N>&>(
+          until, deadline ? *deadline - update_tail_time_ : std::chrono::steady_clock::time_point::max(), 
+          continuation_gmres_, t, x.derived(), solution_, xopt_, lmdopt_, dummyopt_, muopt_);
+      assembly_end_ = std::chrono::steady_clock::now();
+    }
+    const auto opt_error = continuation_gmres_.optError();
+    continuation_gmres_.expansion(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_, 
+                                  solution_update_, settings_.sampling_time, settings_.min_dummy);
+    {
+      CGMRES_PHASE_PROBE(retrieval_timer_);
+      solution_.noalias() += settings_.sampling_time * solution_update_;
+      retrieveSolution();
+    }
+    solution_time_ = t + settings_.sampling_time;
+    if (settings_.health_check) {
+      health_ = checkHealth(opt_error);
+      if (health_ == SolverHealth::Healthy) {
+        if (!initial_snapshot) commitSnapshot();
+        last_healthy_opt_error_ = opt_error;
+        consecutive_rollbacks_ = 0;
+      }
+      else {
+        rollback(t, x);
+      }
+    }
+    if (settings_.jacobian_reuse) {
+      update_tail_time_ = std::chrono::steady_clock::now() - assembly_end_;
+    }
+    if (settings_.profile_solver) timer_.tock();
+    ++num_executed_updates_;
+    consecutive_skips_ = 0;
+    event_t_ = t;
+    event_x_ = x;
+
+    // verbose
+    if (settings_.verbose_level >= 1) {
+      std::cout << "opt error: " << opt_error << std::endl;
+    }
+    if (settings_.verbose_level >= 2) {
+      if (quasi_newton_step_) {
+        std::cout << "quasi-Newton step with the reused Jacobian (residual: " << broyden_jacobian_.residual() 
+                  << (broyden_jacobian_.refreshed() ? ", refreshed)" : ")") << std::endl;
+      }
+      else {
+        std::cout << "number of GMRES iter: " << gmres_iter << " (kmax: " << kmax << ")" << std::endl;
+      }
+      if (deadline && !quasi_newton_step_ && gmres_.truncated()) {
+        std::cout << "GMRES iterations are truncated by the deadline" << std::endl;
+      }
+      if (settings_.health_check && health_ != SolverHealth::Healthy) {
+        std::cout << "unhealthy update (" << health_ << ") is rolled back" << std::endl;
+      }
+    }
+    return true;
+  }
+
+  // Newton-type step at the fixed time t. If parametric is true, the first-order correction 
+  // of the change of the OCP after the last eval_fonc(). Otherwise, the Newton step of the 
+  // optimality conditions.
+  template <typename VectorType>
+  int fixedTimeStep(const Scalar t, const MatrixBase<VectorType>& x, const bool parametric) {
+    FixedTimeLinearProblem_ linear_problem(continuation_gmres_, 
+                                           parametric ? &continuation_gmres_.fonc_hu() : nullptr);
+    fixed_time_update_.setZero();
+    const auto gmres_iter 
+        = gmres_.template solve_other<FixedTimeLinearProblem_, const Scalar, const MatrixBase<VectorType>&, const Vector<dim>&,
+                                      const std::array<Vector<nx>, N+1>&, const std::array<Vector<nx>, N+1>&,
+                                      const std::array<Vector<nub>, N>&, const std::array<Vector<nub>, N>&>(
+              linear_problem, t, x.derived(), solution_, xopt_, lmdopt_, dummyopt_, muopt_, fixed_time_update_);
+    continuation_gmres_.expansion_fixed_time(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_, 
+                                             fixed_time_update_, settings_.min_dummy);
+    clearInactiveSolution();
+    retrieveSolution();
+    return gmres_iter;
+  }
+
+  // Parametric sensitivity correction after the change of the OCP. The residuals of the 
+  // last eval_fonc() are the reference of the correction, and the states saved after each 
+  // step keep them while the optimality error of the new OCP is evaluated. The solution 
+  // with the smallest error is kept, i.e., the uncorrected one if no step decreases it.
+  template <typename VectorType>
+  int parametricCorrection(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (sensitivity_buffer_.size() < 2 * state_size) {
+      sensitivity_buffer_.resize(2 * state_size);
+    }
+    char* best = sensitivity_buffer_.data();
+    char* trial = sensitivity_buffer_.data() + state_size;
+    save_state(best, state_size);
+    continuation_gmres_.eval_fonc(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_);
+    Scalar best_opt_error = continuation_gmres_.optError();
+    load_state(best, state_size);
+    int gmres_iter = 0;
+    for (size_t i=0; i<settings_.sensitivity_steps; ++i) {
+      gmres_iter += fixedTimeStep(t, x, true);
+      save_state(trial, state_size);
+      continuation_gmres_.eval_fonc(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_);
+      const Scalar opt_error = continuation_gmres_.optError();
+      if (!std::isfinite(opt_error)) break;
+      // The next step continues from this step with the reference residuals.
+      if (opt_error < best_opt_error) {
+        best_opt_error = opt_error;
+        std::swap(best, trial);
+        load_state(best, state_size);
+      }
+      else {
+        load_state(trial, state_size);
+      }
+    }
+    load_state(best, state_size);
+    solution_update_.setZero();
+    continuation_gmres_.eval_fonc(t, x, solution_, xopt_, lmdopt_, dummyopt_, muopt_);
+    return gmres_iter;
+  }
+
+  void shiftSolution(const Scalar t) {
+    const auto& horizon = continuation_gmres_.get_nlp().horizon();
+    const Scalar elapsed = t - solution_time_;
+    const Scalar T = horizon.T(solution_time_);
+    // Skips if the updates are performed every sampling period since the continuation 
+    // already advances the solution by SolverSettings::sampling_time.
+    if (!(elapsed > 1.0e-06 * settings_.sampling_time) || T <= 0.0) return;
+    // The i-th grid of the horizon at t is at t + i * T(t) / N, i.e., at the grid position 
+    // (N * elapsed + i * T(t)) / T(solution_time_) of the horizon of the current solution.
+    const int active_N = continuation_gmres_.get_nlp().active_N();
+    const Scalar offset = active_N * elapsed / T;
+    const Scalar scale = horizon.T(t) / T;
+    detail::shift_trajectory(ucopt_, offset, scale, active_N);
+    detail::shift_trajectory(xopt_, offset, scale, active_N+1);
+    detail::shift_trajectory(lmdopt_, offset, scale, active_N+1);
+    if constexpr (nub > 0) {
+      detail::shift_trajectory(dummyopt_, offset, scale, active_N);
+      detail::shift_trajectory(muopt_, offset, scale, active_N);
+    }
+    // The first entries of the state and costate are not the decision variables 
+    // and must be kept zero for the condensing.
+    xopt_[0].setZero();
+    lmdopt_[0].setZero();
+    for (size_t i=0; i<N; ++i) {
+      solution_.template segment<nuc>(i*nuc) = ucopt_[i];
+    }
+    retrieveSolution();
+  }
+
+  detail::SolverStateHeader stateHeader() const {
+    return detail::make_solver_state_header(detail::SolverStateKind::MultipleShooting, 
+                                            nx, nuc, nub, N, dim, kmax, state_size);
+  }
 
   void setInnerSolution() {
+    solution_time_ = std::numeric_limits<Scalar>::quiet_NaN();
+    event_t_ = std::numeric_limits<Scalar>::quiet_NaN();
     for (size_t i=0; i<N; ++i) {
       solution_.template segment<nuc>(i*nuc) = ucopt_[i];
     }
+    clearInactiveSolution();
+  }
+
+  // Keeps the entries of the inactive grids zero: the NLP does not evaluate them 
+  // and the continuation would otherwise drive the inactive state and costate apart. 
+  // Called whenever the solution is replaced, which also discards the reused Jacobian.
+  void clearInactiveSolution() {
+    broyden_jacobian_.invalidate();
+    const int active_N = continuation_gmres_.get_nlp().active_N();
+    for (int i=active_N; i<N; ++i) {
+      uopt_[i].setZero();
+      ucopt_[i].setZero();
+      solution_.template segment<nuc>(i*nuc).setZero();
+      solution_update_.template segment<nuc>(i*nuc).setZero();
+      xopt_[i+1].setZero();
+      lmdopt_[i+1].setZero();
+      if constexpr (nub > 0) {
+        dummyopt_[i].setZero();
+        muopt_[i].setZero();
+      }
+    }
+  }
+
+  SolverHealth checkHealth(const Scalar opt_error) const {
+    if (!quasi_newton_step_ && gmres_.breakdown()) return SolverHealth::GMRESBreakdown;
+    if (!std::isfinite(opt_error) || !solution_.allFinite()) return SolverHealth::NonFinite;
+    for (size_t i=0; i<=N; ++i) {
+      if (!xopt_[i].allFinite() || !lmdopt_[i].allFinite()) return SolverHealth::NonFinite;
+    }
+    if constexpr (nub > 0) {
+      for (size_t i=0; i<N; ++i) {
+        if (!dummyopt_[i].allFinite() || !muopt_[i].allFinite()) return SolverHealth::NonFinite;
+      }
+    }
+    if (opt_error > settings_.health_opterr_floor && !std::isnan(last_healthy_opt_error_)
+        && opt_error > settings_.health_opterr_growth * last_healthy_opt_error_) {
+      return SolverHealth::OptErrorGrowth;
+    }
+    return SolverHealth::Healthy;
+  }
+
+  // Keeps the state saved in the head slot before the step. The ring has one more slot 
+  // than the snapshots so that the saving never overwrites a kept snapshot.
+  void commitSnapshot() {
+    rollback_head_ = (rollback_head_ + 1) % (settings_.rollback_depth + 1);
+    rollback_count_ = std::min(rollback_count_ + 1, settings_.rollback_depth);
+  }
+
+  // Restores the latest snapshot, i.e., the state before the step of the last healthy 
+  // update, which is older than the state judged by this update. Consecutive rollbacks 
+  // go back to older snapshots. The restored solution is the one at the next update.
+  template <typename VectorType>
+  void rollback(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (rollback_count_ > 0) {
+      const std::size_t back = std::min(consecutive_rollbacks_, rollback_count_-1);
+      const std::size_t slot = (rollback_head_ + settings_.rollback_depth - back) % (settings_.rollback_depth + 1);
+      load_state(rollback_buffer_.data() + slot * state_size, state_size);
+      event_t_ = std::numeric_limits<Scalar>::quiet_NaN();
+      ++num_rollbacks_;
+    }
+    ++consecutive_rollbacks_;
+    if (settings_.health_reinit_zero_horizon) {
+      reinitZeroHorizon(t, x);
+    }
+    solution_time_ = t + settings_.sampling_time;
+  }
+
+  // Keeps the rolled-back solution unless the zero-horizon OCP converges within 
+  // SolverSettings::health_reinit_max_iter iterations. The zero-horizon solver is 
+  // constructed at the first re-initialization.
+  template <typename VectorType>
+  void reinitZeroHorizon(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (!x.allFinite()) return;
+    if (!zero_horizon_solver_) {
+      SolverSettings reinit_settings = settings_;
+      reinit_settings.max_iter = settings_.health_reinit_max_iter;
+      zero_horizon_solver_.emplace(continuation_gmres_.get_nlp().ocp(), reinit_settings);
+    }
+    auto& zero_horizon_solver = *zero_horizon_solver_;
+    Vector<nuc> uc = ucopt_[0];
+    if (!uc.allFinite()) uc.setZero();
+    zero_horizon_solver.set_uc(uc);
+    zero_horizon_solver.init_dummy_mu();
+    zero_horizon_solver.solve(t, x);
+    if (!zero_horizon_solver.statistics().converged) return;
+    set_uc(zero_horizon_solver.ucopt());
+    solution_update_.setZero();
+    init_x_lmd(t, x);
+    if constexpr (nub > 0) {
+      set_dummy(zero_horizon_solver.dummyopt());
+      set_mu(zero_horizon_solver.muopt());
+    }
+    // The optimality error of the re-initialized solution is the new baseline.
+    last_healthy_opt_error_ = std::numeric_limits<Scalar>::quiet_NaN();
+    ++num_reinits_;
   }
 
   void retrieveSolution() {
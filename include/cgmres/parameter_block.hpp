@@ -0,0 +1,94 @@
+#ifndef CGMRES__PARAMETER_BLOCK_HPP_
+#define CGMRES__PARAMETER_BLOCK_HPP_
+
+#include <atomic>
+#include <mutex>
+
+#include "cgmres/detail/triple_buffer.hpp"
+
+
+namespace cgmres {
+
+///
+/// @class ParameterBlock
+/// @brief Block of OCP parameters (e.g., model parameters, weights, references, 
+/// and bounds) with an epoch counter. A writer fills the back buffer of a triple 
+/// buffer, publishes it, and then increments the epoch atomically. The reader takes 
+/// the latest published buffer without any lock, so that it always obtains a 
+/// consistent value and is never blocked by the writers. Concurrent writers are 
+/// serialized by a mutex that the reader does not take. The parameters must be read 
+/// only from one thread, i.e., the thread of the solvers. An OCP holding a 
+/// ParameterBlock can expose its epoch by `unsigned long parameter_epoch() const`. 
+/// Then the solvers call the `synchronize()` of the OCP, and thus read the 
+/// parameters, only when the epoch has changed.
+/// @tparam T Type of the parameters. Must be default-constructible and copy-assignable.
+///
+template <typename T>
+class ParameterBlock {
+public:
+  ///
+  /// @brief Constructs the parameter block. The epoch is 0.
+  /// @param[in] value Initial value of the parameters.
+  ///
+  explicit ParameterBlock(const T& value=T()) 
+    : buffer_(value) {
+  }
+
+  ParameterBlock(const ParameterBlock&) = delete;
+
+  ParameterBlock& operator=(const ParameterBlock&) = delete;
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~ParameterBlock() = default;
+
+  ///
+  /// @brief Publishes new parameters and increments the epoch. Concurrent writers are serialized.
+  /// @param[in] value The parameters.
+  ///
+  void publish(const T& value) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    buffer_.back() = value;
+    buffer_.publish();
+    epoch_.fetch_add(1, std::memory_order_release);
+  }
+
+  ///
+  /// @brief Gets the epoch, i.e., the number of the publications. Does not lock.
+  /// @return The epoch.
+  ///
+  unsigned long epoch() const { return epoch_.load(std::memory_order_acquire); }
+
+  ///
+  /// @brief Reads a consistent copy of the latest parameters. Does not lock. 
+  /// Called only from the reader thread.
+  /// @param[out] value The parameters.
+  /// @return The epoch of the parameters. The parameters are at least as new as it.
+  ///
+  unsigned long read(T& value) const {
+    const unsigned long epoch = epoch_.load(std::memory_order_acquire);
+    buffer_.update();
+    value = buffer_.front();
+    return epoch;
+  }
+
+  ///
+  /// @brief Reads a consistent copy of the latest parameters. Does not lock. 
+  /// Called only from the reader thread.
+  /// @return The parameters.
+  ///
+  T read() const {
+    buffer_.update();
+    return buffer_.front();
+  }
+
+private:
+  mutable detail::TripleBuffer<T> buffer_;
+  std::mutex writer_mutex_;
+  alignas(64) std::atomic<unsigned long> epoch_{0};
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__PARAMETER_BLOCK_HPP_
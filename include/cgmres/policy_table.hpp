@@ -0,0 +1,516 @@
+#ifndef CGMRES__POLICY_TABLE_HPP_
+#define CGMRES__POLICY_TABLE_HPP_
+
+#include <array>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "cgmres/types.hpp"
+
+#include "cgmres/detail/macros.hpp"
+
+
+namespace cgmres {
+
+///
+/// @class PolicyTable
+/// @brief Table of the control input sampled offline on a regular grid of a subset
+/// of the state around a reference state, e.g., the first-stage control input
+/// uopt()[0] of an MPC solver. The other elements of the state are fixed to the
+/// reference in sampling and ignored in lookup. The control input is looked up by
+/// the multilinear interpolation of the 2^nd neighbouring grid points, i.e., in
+/// constant time without allocation, and the state is clamped to the grid.
+/// @tparam nx Dimension of the state.
+/// @tparam nu Dimension of the control input.
+/// @tparam nd Number of the state elements spanning the grid. Must be positive.
+///
+template <int nx, int nu, int nd>
+class PolicyTable {
+public:
+  static_assert(nd > 0 && nd <= nx);
+
+  ///
+  /// @brief Number of the grid points neighbouring a state.
+  ///
+  static constexpr int num_corners = (1 << nd);
+
+  ///
+  /// @brief Constructs the table with the control inputs set to zero.
+  /// @param[in] x_ref Reference state around which the table is sampled.
+  /// @param[in] state_indices Indices of the state elements spanning the grid.
+  /// Must be in [0, nx).
+  /// @param[in] lb Lower bounds of the grid.
+  /// @param[in] ub Upper bounds of the grid. Must be larger than lb.
+  /// @param[in] num_points Numbers of the grid points along each state element.
+  /// Must be no less than 2.
+  ///
+  PolicyTable(const Vector<nx>& x_ref, const std::array<int, nd>& state_indices,
+              const Vector<nd>& lb, const Vector<nd>& ub,
+              const std::array<int, nd>& num_points)
+    : x_ref_(x_ref),
+      state_indices_(state_indices),
+      lb_(lb),
+      ub_(ub),
+      num_points_(num_points) {
+    std::size_t size = 1;
+    for (int d=nd-1; d>=0; --d) {
+      if (state_indices[d] < 0 || state_indices[d] >= nx) {
+        throw std::invalid_argument("[PolicyTable]: 'state_indices' must be in [0, " + std::to_string(nx) + ")!");
+      }
+      if (!(ub.coeff(d) > lb.coeff(d))) {
+        throw std::invalid_argument("[PolicyTable]: 'ub' must be larger than 'lb'!");
+      }
+      if (num_points[d] < 2) {
+        throw std::invalid_argument("[PolicyTable]: 'num_points' must be no less than 2!");
+      }
+      strides_[d] = size;
+      size *= num_points[d];
+      step_.coeffRef(d) = (ub.coeff(d) - lb.coeff(d)) / (num_points[d] - 1);
+    }
+    values_.assign(size, Vector<nu>::Zero());
+  }
+
+  ///
+  /// @brief Constructs the table from a file saved by save().
+  /// @param[in] path Path to the file.
+  ///
+  explicit PolicyTable(const std::string& path) {
+    load(path);
+  }
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~PolicyTable() = default;
+
+  ///
+  /// @brief Gets the number of the grid points.
+  /// @return The number of the grid points.
+  ///
+  std::size_t size() const { return values_.size(); }
+
+  ///
+  /// @brief Gets the state at a grid point, i.e., the reference state with
+  /// the elements spanning the grid replaced by the grid values.
+  /// @param[in] i Index of the grid point.
+  /// @return The state at the grid point.
+  ///
+  Vector<nx> point(const std::size_t i) const {
+    checkIndex(i, "point");
+    Vector<nx> x = x_ref_;
+    for (int d=0; d<nd; ++d) {
+      const int k = (i / strides_[d]) % num_points_[d];
+      x.coeffRef(state_indices_[d]) = lb_.coeff(d) + k * step_.coeff(d);
+    }
+    return x;
+  }
+
+  ///
+  /// @brief Gets the control input at a grid point.
+  /// @param[in] i Index of the grid point.
+  /// @return const reference to the control input.
+  ///
+  const Vector<nu>& value(const std::size_t i) const {
+    checkIndex(i, "value");
+    return values_[i];
+  }
+
+  ///
+  /// @brief Sets the control input at a grid point.
+  /// @param[in] i Index of the grid point.
+  /// @param[in] u The control input. Size must be nu.
+  ///
+  template <typename VectorType>
+  void set_value(const std::size_t i, const MatrixBase<VectorType>& u) {
+    checkIndex(i, "set_value");
+    if (u.size() != nu) {
+      throw std::invalid_argument("[PolicyTable::set_value] u.size() must be " + std::to_string(nu));
+    }
+    values_[i] = u;
+  }
+
+  ///
+  /// @brief Samples the table. The grid points are visited in order so that
+  /// the sampler can warm-start from the previous point. The grid points where
+  /// the sampler fails take the value of the nearest successful grid point.
+  /// @param[in] sampler Computes the control input at a state. Returns false if fails.
+  /// @return The number of the grid points where the sampler fails.
+  ///
+  std::size_t build(const std::function<bool(const Vector<nx>&, Vector<nu>&)>& sampler) {
+    std::vector<bool> succeeded(values_.size(), false);
+    std::size_t num_failed = 0;
+    Vector<nu> u;
+    for (std::size_t i=0; i<values_.size(); ++i) {
+      u = values_[i];
+      succeeded[i] = sampler(point(i), u) && u.allFinite();
+      if (succeeded[i]) {
+        values_[i] = u;
+      }
+      else {
+        ++num_failed;
+      }
+    }
+    if (num_failed == values_.size()) {
+      throw std::runtime_error("[PolicyTable::build] the sampler fails at all the grid points");
+    }
+    if (num_failed > 0) {
+      for (std::size_t i=0; i<values_.size(); ++i) {
+        if (!succeeded[i]) {
+          values_[i] = values_[nearestSucceeded(i, succeeded)];
+        }
+      }
+    }
+    return num_failed;
+  }
+
+  ///
+  /// @brief Samples the table by the first-stage control input of an MPC solver.
+  /// At each grid point, the solver is updated with the state of the grid point
+  /// at a fixed time until the optimality error becomes less than the tolerance,
+  /// warm-starting from the solution at the previous grid point.
+  /// @param[in] solver MPC solver providing update(), optError(), and uopt(),
+  /// e.g., MultipleShootingCGMRESSolver. Must be initialized around the reference state.
+  /// @param[in] t Time of the samples.
+  /// @param[in] max_updates Maximum number of the updates per grid point. Must be positive.
+  /// @param[in] opterr_tol Tolerance of the optimality error. Must be positive.
+  /// @return The number of the grid points where the optimality error does not
+  /// reach the tolerance.
+  ///
+  template <class MPCSolver>
+  std::size_t build(MPCSolver& solver, const Scalar t, const int max_updates,
+                    const Scalar opterr_tol) {
+    if (max_updates <= 0) {
+      throw std::invalid_argument("[PolicyTable::build] 'max_updates' must be positive!");
+    }
+    if (opterr_tol <= 0.0) {
+      throw std::invalid_argument("[PolicyTable::build] 'opterr_tol' must be positive!");
+    }
+    return build([&](const Vector<nx>& x, Vector<nu>& u) {
+      for (int k=0; k<max_updates; ++k) {
+        solver.update(t, x);
+        // The optimality error at (t, x) evaluated in the update.
+        const Scalar opt_error = solver.optError();
+        if (!std::isfinite(opt_error)) return false;
+        if (opt_error < opterr_tol) {
+          u = solver.uopt()[0];
+          return true;
+        }
+      }
+      return false;
+    });
+  }
+
+  ///
+  /// @brief Looks up the control input by the multilinear interpolation.
+  /// @param[in] x State. Size must be nx.
+  /// @param[out] u The control input. Size must be nu.
+  ///
+  template <typename VectorType1, typename VectorType2>
+  void lookup(const MatrixBase<VectorType1>& x, const MatrixBase<VectorType2>& u) const {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[PolicyTable::lookup] x.size() must be " + std::to_string(nx));
+    }
+    if (u.size() != nu) {
+      throw std::invalid_argument("[PolicyTable::lookup] u.size() must be " + std::to_string(nu));
+    }
+    std::size_t base = 0;
+    std::array<Scalar, nd> w;
+    for (int d=0; d<nd; ++d) {
+      Scalar pos = (x.coeff(state_indices_[d]) - lb_.coeff(d)) / step_.coeff(d);
+      if (!(pos > 0.0)) pos = 0.0;
+      if (pos > num_points_[d] - 1) pos = num_points_[d] - 1;
+      const int k = std::min(static_cast<int>(pos), num_points_[d] - 2);
+      w[d] = pos - k;
+      base += k * strides_[d];
+    }
+    auto& u_ = CGMRES_EIGEN_CONST_CAST(VectorType2, u);
+    u_.setZero();
+    for (int c=0; c<num_corners; ++c) {
+      Scalar weight = 1.0;
+      std::size_t index = base;
+      for (int d=0; d<nd; ++d) {
+        if (c & (1 << d)) {
+          weight *= w[d];
+          index += strides_[d];
+        }
+        else {
+          weight *= (1.0 - w[d]);
+        }
+      }
+      u_.noalias() += weight * values_[index];
+    }
+  }
+
+  ///
+  /// @brief Looks up the control input by the multilinear interpolation.
+  /// @param[in] x State. Size must be nx.
+  /// @return The control input.
+  ///
+  template <typename VectorType>
+  Vector<nu> lookup(const MatrixBase<VectorType>& x) const {
+    Vector<nu> u;
+    lookup(x, u);
+    return u;
+  }
+
+  ///
+  /// @brief Saves the table to a binary file.
+  /// @param[in] path Path to the file.
+  ///
+  void save(const std::string& path) const {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+      throw std::invalid_argument("[PolicyTable::save] cannot open " + path);
+    }
+    const Header header = makeHeader(values_.size());
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    ofs.write(reinterpret_cast<const char*>(state_indices_.data()), nd * sizeof(int));
+    ofs.write(reinterpret_cast<const char*>(num_points_.data()), nd * sizeof(int));
+    ofs.write(reinterpret_cast<const char*>(x_ref_.data()), nx * sizeof(Scalar));
+    ofs.write(reinterpret_cast<const char*>(lb_.data()), nd * sizeof(Scalar));
+    ofs.write(reinterpret_cast<const char*>(ub_.data()), nd * sizeof(Scalar));
+    for (const auto& e : values_) {
+      ofs.write(reinterpret_cast<const char*>(e.data()), nu * sizeof(Scalar));
+    }
+    if (!ofs) {
+      throw std::invalid_argument("[PolicyTable::save] failed to write " + path);
+    }
+  }
+
+  ///
+  /// @brief Replaces the table by that of a file saved by save().
+  /// @param[in] path Path to the file.
+  ///
+  void load(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+      throw std::invalid_argument("[PolicyTable::load] cannot open " + path);
+    }
+    Header header;
+    ifs.read(reinterpret_cast<char*>(&header), sizeof(Header));
+    const Header expected = makeHeader(header.num_points);
+    if (!ifs || header.magic != expected.magic || header.version != expected.version) {
+      throw std::invalid_argument("[PolicyTable::load] " + path + " is not a policy table");
+    }
+    if (header.state_dim != expected.state_dim || header.input_dim != expected.input_dim || header.grid_dim != expected.grid_dim) {
+      throw std::invalid_argument("[PolicyTable::load] the dimensions of " + path + " do not match the table");
+    }
+    std::array<int, nd> state_indices, num_points;
+    Vector<nx> x_ref;
+    Vector<nd> lb, ub;
+    ifs.read(reinterpret_cast<char*>(state_indices.data()), nd * sizeof(int));
+    ifs.read(reinterpret_cast<char*>(num_points.data()), nd * sizeof(int));
+    ifs.read(reinterpret_cast<char*>(x_ref.data()), nx * sizeof(Scalar));
+    ifs.read(reinterpret_cast<char*>(lb.data()), nd * sizeof(Scalar));
+    ifs.read(reinterpret_cast<char*>(ub.data()), nd * sizeof(Scalar));
+    if (!ifs) {
+      throw std::invalid_argument("[PolicyTable::load] " + path + " is truncated");
+    }
+    *this = PolicyTable(x_ref, state_indices, lb, ub, num_points);
+    if (values_.size() != header.num_points) {
+      throw std::invalid_argument("[PolicyTable::load] " + path + " is corrupted");
+    }
+    for (auto& e : values_) {
+      ifs.read(reinterpret_cast<char*>(e.data()), nu * sizeof(Scalar));
+    }
+    if (!ifs) {
+      throw std::invalid_argument("[PolicyTable::load] " + path + " is truncated");
+    }
+  }
+
+  void disp(std::ostream& os) const {
+    os << "Policy table: " << std::endl;
+    os << "  nx:                " << nx << std::endl;
+    os << "  nu:                " << nu << std::endl;
+    os << "  state indices:    ";
+    for (int d=0; d<nd; ++d) os << " " << state_indices_[d];
+    os << std::endl;
+    os << "  number of points: ";
+    for (int d=0; d<nd; ++d) os << " " << num_points_[d];
+    os << std::endl;
+    os << "  lb:                " << lb_.transpose() << std::endl;
+    os << "  ub:                " << ub_.transpose() << std::flush;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const PolicyTable& table) {
+    table.disp(os);
+    return os;
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  struct Header {
+    static constexpr std::uint32_t kMagic = 0x54504743; // "CGPT"
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t state_dim;
+    std::uint32_t input_dim;
+    std::uint32_t grid_dim;
+    std::uint32_t reserved;
+    std::uint64_t num_points;
+  };
+
+  Vector<nx> x_ref_;
+  std::array<int, nd> state_indices_;
+  Vector<nd> lb_, ub_, step_;
+  std::array<int, nd> num_points_;
+  std::array<std::size_t, nd> strides_;
+  std::vector<Vector<nu>> values_;
+
+  static Header makeHeader(const std::size_t num_points) {
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    header.magic = Header::kMagic;
+    header.version = Header::kVersion;
+    header.state_dim = nx;
+    header.input_dim = nu;
+    header.grid_dim = nd;
+    header.num_points = num_points;
+    return header;
+  }
+
+  // Nearest successful grid point in the grid distance, searched by brute force
+  // since the table is built offline.
+  std::size_t nearestSucceeded(const std::size_t i, const std::vector<bool>& succeeded) const {
+    std::size_t nearest = i;
+    long best = std::numeric_limits<long>::max();
+    for (std::size_t j=0; j<values_.size(); ++j) {
+      if (!succeeded[j]) continue;
+      long dist = 0;
+      for (int d=0; d<nd; ++d) {
+        const long diff = static_cast<long>((i / strides_[d]) % num_points_[d])
+                            - static_cast<long>((j / strides_[d]) % num_points_[d]);
+        dist += diff * diff;
+      }
+      if (dist < best) {
+        best = dist;
+        nearest = j;
+      }
+    }
+    return nearest;
+  }
+
+  void checkIndex(const std::size_t i, const char* method) const {
+    if (i >= values_.size()) {
+      throw std::invalid_argument(std::string("[PolicyTable::") + method + "] i must be less than "
+                                  + std::to_string(values_.size()));
+    }
+  }
+};
+
+
+///
+/// @class PolicyTableFallback
+/// @brief Runs an MPC solver with a deadline and serves the control input from a
+/// PolicyTable instead of the solver when the update misses the deadline, i.e., the
+/// deadline has already passed before the update or the GMRES iterations are truncated
+/// by the deadline, or when the update produces non-finite values.
+/// @tparam MPCSolver MPC solver providing the deadline-bounded update(), optError(),
+/// and uopt(), e.g., MultipleShootingCGMRESSolver.
+/// @tparam nd Number of the state elements spanning the grid of the table.
+///
+template <class MPCSolver, int nd>
+class PolicyTableFallback {
+public:
+  ///
+  /// @brief Dimension of the state.
+  ///
+  static constexpr int nx = MPCSolver::nx;
+
+  ///
+  /// @brief Dimension of the control input.
+  ///
+  static constexpr int nu = MPCSolver::nu;
+
+  using PolicyTable_ = PolicyTable<nx, nu, nd>;
+
+  ///
+  /// @brief Constructs the fallback. The solver and table are referenced and
+  /// must outlive this object.
+  /// @param[in] solver MPC solver.
+  /// @param[in] table Policy table.
+  ///
+  PolicyTableFallback(MPCSolver& solver, const PolicyTable_& table)
+    : solver_(&solver),
+      table_(&table),
+      u_(Vector<nu>::Zero()) {
+  }
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~PolicyTableFallback() = default;
+
+  ///
+  /// @brief Updates the solver within the deadline and selects the control input.
+  /// @param[in] t Initial time of the horizon.
+  /// @param[in] x Initial state of the horizon. Size must be nx.
+  /// @param[in] deadline Deadline of the update.
+  /// @return true if the control input is served from the table.
+  ///
+  template <typename VectorType>
+  bool update(const Scalar t, const MatrixBase<VectorType>& x,
+              const std::chrono::steady_clock::time_point& deadline) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[PolicyTableFallback::update] x.size() must be " + std::to_string(nx));
+    }
+    fallback_active_ = true;
+    if (std::chrono::steady_clock::now() < deadline) {
+      const bool truncated = solver_->update(t, x, deadline);
+      const auto& u = solver_->uopt()[0];
+      fallback_active_ = truncated || !u.allFinite() || !std::isfinite(solver_->optError());
+      if (!fallback_active_) {
+        u_ = u;
+      }
+    }
+    if (fallback_active_) {
+      table_->lookup(x, u_);
+      ++num_fallbacks_;
+    }
+    return fallback_active_;
+  }
+
+  ///
+  /// @brief Gets the control input selected by the last update().
+  /// @return const reference to the control input.
+  ///
+  const Vector<nu>& u() const { return u_; }
+
+  ///
+  /// @brief Checks if the control input of the last update() is served from the table.
+  /// @return true if the control input is served from the table.
+  ///
+  bool fallback_active() const { return fallback_active_; }
+
+  ///
+  /// @brief Gets the number of the updates served from the table.
+  /// @return The number of the updates served from the table.
+  ///
+  std::size_t num_fallbacks() const { return num_fallbacks_; }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  MPCSolver* solver_;
+  const PolicyTable_* table_;
+  Vector<nu> u_;
+  bool fallback_active_ = false;
+  std::size_t num_fallbacks_ = 0;
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__POLICY_TABLE_HPP_
@@ -1,6 +1,15 @@
 #define DEFINE_PYBIND11_MODULE_MULTIPLE_SHOOTING_CGMRES_SOLVER(OCP, N, KMAX) \
 using MultipleShootingCGMRESSolver_ = MultipleShootingCGMRESSolver<OCP, N, KMAX>; \
 PYBIND11_MODULE(multiple_shooting_cgmres_solver, m) { \
+  py::enum_<InputInterpolation>(m, "InputInterpolation", py::module_local()) \
+    .value("ZeroOrderHold", InputInterpolation::ZeroOrderHold) \
+    .value("Linear", InputInterpolation::Linear) \
+    .value("CubicHermite", InputInterpolation::CubicHermite); \
+  py::enum_<SolverHealth>(m, "SolverHealth", py::module_local()) \
+    .value("Healthy", SolverHealth::Healthy) \
+    .value("NonFinite", SolverHealth::NonFinite) \
+    .value("OptErrorGrowth", SolverHealth::OptErrorGrowth) \
+    .value("GMRESBreakdown", SolverHealth::GMRESBreakdown); \
   py::class_<MultipleShootingCGMRESSolver_>(m, "MultipleShootingCGMRESSolver") \
     .def(py::init<OCP, Horizon, SolverSettings>(), \ 
           py::arg("ocp"), py::arg("horizon"), py::arg("settings")) \
@@ -52,6 +61,12 @@ PYBIND11_MODULE(multiple_shooting_cgmres_solver, m) { \
     .def("update", [](MultipleShootingCGMRESSolver_& self, const Scalar t, const VectorX& x) { \
         self.update(t, x); \
     }, py::arg("t"), py::arg("x")) \
+    .def("update_ocp", [](MultipleShootingCGMRESSolver_& self, const Scalar t, const VectorX& x, const OCP& ocp) { \
+        return self.update_ocp(t, x, ocp); \
+    }, py::arg("t"), py::arg("x"), py::arg("ocp")) \
+    .def("homotopy_reinit", [](MultipleShootingCGMRESSolver_& self, const Scalar t, const VectorX& x, const py::function& ocp_at) { \
+        return self.homotopy_reinit(t, x, [&](const Scalar s) { return ocp_at(s).cast<OCP>(); }); \
+    }, py::arg("t"), py::arg("x"), py::arg("ocp_at")) \
     .def("init_x", [](MultipleShootingCGMRESSolver_& self, const Scalar t, const VectorX& x) { \
         self.init_x(t, x); \
     }, py::arg("t"), py::arg("x")) \
@@ -62,6 +77,27 @@ PYBIND11_MODULE(multiple_shooting_cgmres_solver, m) { \
         self.init_x_lmd(t, x); \
     }, py::arg("t"), py::arg("x")) \
     .def("init_dummy_mu", &MultipleShootingCGMRESSolver_::init_dummy_mu) \
+    .def("num_executed_updates", &MultipleShootingCGMRESSolver_::num_executed_updates) \
+    .def("num_skipped_updates", &MultipleShootingCGMRESSolver_::num_skipped_updates) \
+    .def("health", &MultipleShootingCGMRESSolver_::health) \
+    .def("num_rollbacks", &MultipleShootingCGMRESSolver_::num_rollbacks) \
+    .def("num_reinits", &MultipleShootingCGMRESSolver_::num_reinits) \
+    .def("num_jacobian_refreshes", &MultipleShootingCGMRESSolver_::num_jacobian_refreshes) \
+    .def("num_quasi_newton_fallbacks", &MultipleShootingCGMRESSolver_::num_quasi_newton_fallbacks) \
+    .def("set_active_N", &MultipleShootingCGMRESSolver_::set_active_N, py::arg("active_N")) \
+    .def("active_N", &MultipleShootingCGMRESSolver_::active_N) \
+    .def("solution_time", &MultipleShootingCGMRESSolver_::solution_time) \
+    .def("u_at", &MultipleShootingCGMRESSolver_::u_at, \
+         py::arg("t"), py::arg("method")=InputInterpolation::ZeroOrderHold) \
+    .def("save_state", [](const MultipleShootingCGMRESSolver_& self) { \
+        std::string data(MultipleShootingCGMRESSolver_::state_size, '\0'); \
+        self.save_state(data.data(), data.size()); \
+        return py::bytes(data); \
+    }) \
+    .def("load_state", [](MultipleShootingCGMRESSolver_& self, const py::bytes& data) { \
+        const std::string buffer = data; \
+        self.load_state(buffer.data(), buffer.size()); \
+    }, py::arg("data")) \
     .def("get_profile", &MultipleShootingCGMRESSolver_::getProfile) \
     .def("__str__", [](const MultipleShootingCGMRESSolver_& self) { \
         std::stringstream ss; \
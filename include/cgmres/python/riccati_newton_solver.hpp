@@ -0,0 +1,56 @@
+#define DEFINE_PYBIND11_MODULE_RICCATI_NEWTON_SOLVER(OCP, N) \
+using RiccatiNewtonSolver_ = RiccatiNewtonSolver<OCP, N>; \
+PYBIND11_MODULE(riccati_newton_solver, m) { \
+  py::class_<RiccatiNewtonSolver_>(m, "RiccatiNewtonSolver") \
+    .def(py::init<OCP, Horizon, SolverSettings>(), \
+          py::arg("ocp"), py::arg("horizon"), py::arg("settings")) \
+    .def(py::init<>()) \
+    .def("clone", [](const RiccatiNewtonSolver_& self) { \
+       auto copy = self; \
+       return copy; \
+     }) \
+    .def("set_u", [](RiccatiNewtonSolver_& self, const VectorX& u) { \
+        self.set_u(u); \
+     }, py::arg("u")) \
+    .def("set_uc", [](RiccatiNewtonSolver_& self, const VectorX& uc) { \
+        self.set_uc(uc); \
+     }, py::arg("uc")) \
+    .def("set_x", [](RiccatiNewtonSolver_& self, const VectorX& x) { \
+        self.set_x(x); \
+     }, py::arg("x")) \
+    .def("set_lmd", [](RiccatiNewtonSolver_& self, const VectorX& lmd) { \
+        self.set_lmd(lmd); \
+     }, py::arg("lmd")) \
+    .def("set_dummy", [](RiccatiNewtonSolver_& self, const VectorX& dummy) { \
+        self.set_dummy(dummy); \
+     }, py::arg("dummy")) \
+    .def("set_mu", [](RiccatiNewtonSolver_& self, const VectorX& mu) { \
+        self.set_mu(mu); \
+     }, py::arg("mu")) \
+    .def("init_x_lmd", [](RiccatiNewtonSolver_& self, const Scalar t, const VectorX& x) { \
+        self.init_x_lmd(t, x); \
+    }, py::arg("t"), py::arg("x")) \
+    .def("init_dummy_mu", &RiccatiNewtonSolver_::init_dummy_mu) \
+    .def_property_readonly("uopt", &RiccatiNewtonSolver_::uopt) \
+    .def_property_readonly("ucopt", &RiccatiNewtonSolver_::ucopt) \
+    .def_property_readonly("xopt", &RiccatiNewtonSolver_::xopt) \
+    .def_property_readonly("lmdopt", &RiccatiNewtonSolver_::lmdopt) \
+    .def_property_readonly("dummyopt", &RiccatiNewtonSolver_::dummyopt) \
+    .def_property_readonly("muopt", &RiccatiNewtonSolver_::muopt) \
+    .def("opt_error", [](RiccatiNewtonSolver_& self, const Scalar t, const VectorX& x) { \
+        return self.optError(t, x); \
+    }, py::arg("t"), py::arg("x")) \
+    .def("opt_error", static_cast<Scalar (RiccatiNewtonSolver_::*)() const>(&RiccatiNewtonSolver_::optError)) \
+    .def("update", [](RiccatiNewtonSolver_& self, const Scalar t, const VectorX& x) { \
+        self.update(t, x); \
+    }, py::arg("t"), py::arg("x")) \
+    .def("solve", [](RiccatiNewtonSolver_& self, const Scalar t, const VectorX& x) { \
+        return self.solve(t, x); \
+    }, py::arg("t"), py::arg("x")) \
+    .def("get_profile", &RiccatiNewtonSolver_::getProfile) \
+    .def("__str__", [](const RiccatiNewtonSolver_& self) { \
+        std::stringstream ss; \
+        ss << self; \
+        return ss.str(); \
+      }); \
+}
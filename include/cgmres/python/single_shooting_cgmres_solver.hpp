@@ -38,6 +38,15 @@ PYBIND11_MODULE(single_shooting_cgmres_solver, m) { \
     .def("update", [](SingleShootingCGMRESSolver_& self, const Scalar t, const VectorX& x) { \
         self.update(t, x); \
     }, py::arg("t"), py::arg("x")) \
+    .def("save_state", [](const SingleShootingCGMRESSolver_& self) { \
+        std::string data(SingleShootingCGMRESSolver_::state_size, '\0'); \
+        self.save_state(data.data(), data.size()); \
+        return py::bytes(data); \
+    }) \
+    .def("load_state", [](SingleShootingCGMRESSolver_& self, const py::bytes& data) { \
+        const std::string buffer = data; \
+        self.load_state(buffer.data(), buffer.size()); \
+    }, py::arg("data")) \
     .def("get_profile", &SingleShootingCGMRESSolver_::getProfile) \
     .def("__str__", [](const SingleShootingCGMRESSolver_& self) { \
         std::stringstream ss; \
@@ -9,9 +9,38 @@ PYBIND11_MODULE(solver_settings, m) { \
     .def_readwrite("max_iter", &SolverSettings::max_iter) \
     .def_readwrite("opterr_tol", &SolverSettings::opterr_tol) \
     .def_readwrite("finite_difference_epsilon", &SolverSettings::finite_difference_epsilon) \
+    .def_readwrite("use_jvp", &SolverSettings::use_jvp) \
     .def_readwrite("sampling_time", &SolverSettings::sampling_time) \
     .def_readwrite("zeta", &SolverSettings::zeta) \
     .def_readwrite("min_dummy", &SolverSettings::min_dummy) \
+    .def_readwrite("shift_warm_start", &SolverSettings::shift_warm_start) \
+    .def_readwrite("event_triggered", &SolverSettings::event_triggered) \
+    .def_readwrite("event_state_tol", &SolverSettings::event_state_tol) \
+    .def_readwrite("event_opterr_tol", &SolverSettings::event_opterr_tol) \
+    .def_readwrite("event_max_skips", &SolverSettings::event_max_skips) \
+    .def_readwrite("parameter_sensitivity", &SolverSettings::parameter_sensitivity) \
+    .def_readwrite("sensitivity_steps", &SolverSettings::sensitivity_steps) \
+    .def_readwrite("homotopy_stages", &SolverSettings::homotopy_stages) \
+    .def_readwrite("homotopy_corrector_iter", &SolverSettings::homotopy_corrector_iter) \
+    .def_readwrite("health_check", &SolverSettings::health_check) \
+    .def_readwrite("health_opterr_growth", &SolverSettings::health_opterr_growth) \
+    .def_readwrite("health_opterr_floor", &SolverSettings::health_opterr_floor) \
+    .def_readwrite("rollback_depth", &SolverSettings::rollback_depth) \
+    .def_readwrite("health_reinit_zero_horizon", &SolverSettings::health_reinit_zero_horizon) \
+    .def_readwrite("health_reinit_max_iter", &SolverSettings::health_reinit_max_iter) \
+    .def_readwrite("line_search", &SolverSettings::line_search) \
+    .def_readwrite("max_line_search_iter", &SolverSettings::max_line_search_iter) \
+    .def_readwrite("line_search_reduction", &SolverSettings::line_search_reduction) \
+    .def_readwrite("max_step_norm", &SolverSettings::max_step_norm) \
+    .def_readwrite("exact_jacobian", &SolverSettings::exact_jacobian) \
+    .def_readwrite("jacobian_reuse", &SolverSettings::jacobian_reuse) \
+    .def_readwrite("jacobian_refresh_period", &SolverSettings::jacobian_refresh_period) \
+    .def_readwrite("quasi_newton_tol", &SolverSettings::quasi_newton_tol) \
+    .def_readwrite("jacobian_assembly_time", &SolverSettings::jacobian_assembly_time) \
+    .def_readwrite("mppi_num_samples", &SolverSettings::mppi_num_samples) \
+    .def_readwrite("mppi_temperature", &SolverSettings::mppi_temperature) \
+    .def_readwrite("mppi_noise_std", &SolverSettings::mppi_noise_std) \
+    .def_readwrite("mppi_seed", &SolverSettings::mppi_seed) \
     .def_readwrite("verbose_level", &SolverSettings::verbose_level) \
     .def("__str__", [](const SolverSettings& self) { \
         std::stringstream ss; \
@@ -1,5 +1,12 @@
 #define DEFINE_PYBIND11_MODULE_TIMER() \
 PYBIND11_MODULE(timer, m) { \
+  py::class_<PhaseTimingProfile>(m, "PhaseTimingProfile") \
+    .def(py::init<>()) \
+    .def_readwrite("name", &PhaseTimingProfile::name) \
+    .def_readwrite("total_time_ms", &PhaseTimingProfile::total_time_ms) \
+    .def_readwrite("average_time_ms", &PhaseTimingProfile::average_time_ms) \
+    .def_readwrite("max_time_ms", &PhaseTimingProfile::max_time_ms) \
+    .def_readwrite("counts", &PhaseTimingProfile::counts); \
   py::class_<TimingProfile>(m, "TimingProfile") \
     .def(py::init<>()) \ 
     .def("clone", [](const TimingProfile& self) { \
@@ -9,6 +16,23 @@ PYBIND11_MODULE(timer, m) { \
     .def_readwrite("average_time_ms", &TimingProfile::average_time_ms) \
     .def_readwrite("max_time_ms", &TimingProfile::max_time_ms) \
     .def_readwrite("counts", &TimingProfile::counts) \
+    .def_readwrite("p50_time_ms", &TimingProfile::p50_time_ms) \
+    .def_readwrite("p90_time_ms", &TimingProfile::p90_time_ms) \
+    .def_readwrite("p99_time_ms", &TimingProfile::p99_time_ms) \
+    .def_readwrite("p999_time_ms", &TimingProfile::p999_time_ms) \
+    .def_readwrite("p9999_time_ms", &TimingProfile::p9999_time_ms) \
+    .def_readwrite("phases", &TimingProfile::phases) \
+    .def("percentile_time_ms", &TimingProfile::percentile_time_ms) \
+    .def("merge", &TimingProfile::merge) \
+    .def("latency_histogram", [](const TimingProfile& self) { \
+        std::vector<std::pair<double, unsigned long>> histogram; \
+        for (std::size_t i=0; i<self.histogram.num_buckets; ++i) { \
+          if (self.histogram.count(i) > 0) { \
+            histogram.emplace_back(1.0e-06 * self.histogram.bucketUpperBound(i), self.histogram.count(i)); \
+          } \
+        } \
+        return histogram; \
+      }) \
     .def("__str__", [](const TimingProfile& self) { \
         std::stringstream ss; \
         ss << self; \ 
@@ -23,5 +47,6 @@ PYBIND11_MODULE(timer, m) { \
     .def("reset", &Timer::reset) \
     .def("tick", &Timer::tick) \
     .def("tock", &Timer::tock) \
+    .def("merge", &Timer::merge) \
     .def("get_profile", &Timer::getProfile); \
 }
\ No newline at end of file
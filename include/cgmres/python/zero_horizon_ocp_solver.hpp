@@ -1,6 +1,13 @@
 #define DEFINE_PYBIND11_MODULE_ZERO_HORIZON_OCP_SOLVER(OCP, KMAX) \
 using ZeroHorizonOCPSolver_ = ZeroHorizonOCPSolver<OCP, KMAX>; \
 PYBIND11_MODULE(zero_horizon_ocp_solver, m) { \
+  py::class_<ZeroHorizonOCPSolver_::Statistics>(m, "ZeroHorizonOCPSolverStatistics") \
+    .def_readonly("converged", &ZeroHorizonOCPSolver_::Statistics::converged) \
+    .def_readonly("iter", &ZeroHorizonOCPSolver_::Statistics::iter) \
+    .def_readonly("gmres_iter", &ZeroHorizonOCPSolver_::Statistics::gmres_iter) \
+    .def_readonly("line_search_iter", &ZeroHorizonOCPSolver_::Statistics::line_search_iter) \
+    .def_readonly("step_cap_fallbacks", &ZeroHorizonOCPSolver_::Statistics::step_cap_fallbacks) \
+    .def_readonly("opt_error", &ZeroHorizonOCPSolver_::Statistics::opt_error); \
   py::class_<ZeroHorizonOCPSolver_>(m, "ZeroHorizonOCPSolver") \
     .def(py::init<OCP, SolverSettings>(), \ 
           py::arg("ocp"), py::arg("settings")) \
@@ -33,6 +40,16 @@ PYBIND11_MODULE(zero_horizon_ocp_solver, m) { \
     .def("solve", [](ZeroHorizonOCPSolver_& self, const Scalar t, const VectorX& x) { \
         self.solve(t, x); \
     }, py::arg("t"), py::arg("x")) \
+    .def_property_readonly("statistics", &ZeroHorizonOCPSolver_::statistics) \
+    .def("save_state", [](const ZeroHorizonOCPSolver_& self) { \
+        std::string data(ZeroHorizonOCPSolver_::state_size, '\0'); \
+        self.save_state(data.data(), data.size()); \
+        return py::bytes(data); \
+    }) \
+    .def("load_state", [](ZeroHorizonOCPSolver_& self, const py::bytes& data) { \
+        const std::string buffer = data; \
+        self.load_state(buffer.data(), buffer.size()); \
+    }, py::arg("data")) \
     .def("get_profile", &ZeroHorizonOCPSolver_::getProfile) \
     .def("__str__", [](const ZeroHorizonOCPSolver_& self) { \
         std::stringstream ss; \
@@ -0,0 +1,661 @@
+#ifndef CGMRES__RICCATI_NEWTON_SOLVER_HPP_
+#define CGMRES__RICCATI_NEWTON_SOLVER_HPP_
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <iostream>
+
+#include "cgmres/types.hpp"
+#include "cgmres/horizon.hpp"
+#include "cgmres/solver_settings.hpp"
+#include "cgmres/timer.hpp"
+
+#include "cgmres/detail/multiple_shooting_nlp.hpp"
+#include "cgmres/detail/ocp_derivatives.hpp"
+#include "cgmres/detail/riccati_recursion.hpp"
+
+namespace cgmres {
+
+///
+/// @class RiccatiNewtonSolver
+/// @brief Multiple-shooting Newton-type solver for nonlinear MPC that solves each step
+/// exactly by the Riccati recursion instead of the GMRES, an alternative backend of
+/// MultipleShootingCGMRESSolver. The optimality conditions are the same as those of
+/// MultipleShootingCGMRESSolver. Their stage Jacobians are computed by the directional
+/// derivatives, eval_huu(), and eval_hux() of the OCP generated by AutoGenU (by the central 
+/// finite differences if the OCP does not provide them) and the step is solved by the backward and forward
+/// Riccati recursions in O(N nx^3), so that the cost of an update is deterministic.
+/// @tparam OCP A definition of the optimal control problem (OCP).
+/// @tparam N Number of discretizationn grids of the horizon. Must be positive.
+///
+template <class OCP, int N>
+class RiccatiNewtonSolver {
+public:
+  ///
+  /// @brief Dimension of the state.
+  ///
+  static constexpr int nx = OCP::nx;
+
+  ///
+  /// @brief Dimension of the control input.
+  ///
+  static constexpr int nu = OCP::nu;
+
+  ///
+  /// @brief Dimension of the equality constraints.
+  ///
+  static constexpr int nc = OCP::nc;
+
+  ///
+  /// @brief Dimension of the concatenation of the control input and equality constraints.
+  ///
+  static constexpr int nuc = nu + nc;
+
+  ///
+  /// @brief Dimension of the bound constraints on the control input.
+  ///
+  static constexpr int nub = OCP::nub;
+
+  ///
+  /// @brief Dimension of the concatenation of the control inputs and equality constraints over the horizon.
+  ///
+  static constexpr int dim = nuc * N;
+
+  using MultipleShootingNLP_ = detail::MultipleShootingNLP<OCP, N>;
+  using RiccatiRecursion_ = detail::RiccatiRecursion<nx, nuc, N>;
+
+  ///
+  /// @brief Constructs the Riccati-recursion Newton solver.
+  /// @param[in] ocp A definition of the optimal control problem (OCP).
+  /// @param[in] horizon Prediction horizon.
+  /// @param[in] settings Solver settings. SolverSettings::sampling_time and SolverSettings::zeta
+  /// define the continuation of update() as in MultipleShootingCGMRESSolver, and
+  /// SolverSettings::max_iter and SolverSettings::opterr_tol define the Newton iterations of solve().
+  ///
+  RiccatiNewtonSolver(const OCP& ocp, const Horizon& horizon,
+                      const SolverSettings& settings=SolverSettings())
+    : nlp_(ocp, horizon),
+      riccati_(),
+      settings_(settings),
+      timer_(),
+      solution_(Vector<dim>::Zero()),
+      solution_update_(Vector<dim>::Zero()),
+      fonc_hu_(Vector<dim>::Zero()),
+      fonc_hu_0_(Vector<dim>::Zero()) {
+    std::fill(uopt_.begin(), uopt_.end(), Vector<nu>::Zero());
+    std::fill(ucopt_.begin(), ucopt_.end(), Vector<nuc>::Zero());
+    std::fill(xopt_.begin(), xopt_.end(), Vector<nx>::Zero());
+    std::fill(lmdopt_.begin(), lmdopt_.end(), Vector<nx>::Zero());
+    std::fill(dummyopt_.begin(), dummyopt_.end(), Vector<nub>::Zero());
+    std::fill(muopt_.begin(), muopt_.end(), Vector<nub>::Zero());
+    std::fill(x_update_.begin(), x_update_.end(), Vector<nx>::Zero());
+    std::fill(lmd_update_.begin(), lmd_update_.end(), Vector<nx>::Zero());
+    std::fill(fonc_f_.begin(), fonc_f_.end(), Vector<nx>::Zero());
+    std::fill(fonc_hx_.begin(), fonc_hx_.end(), Vector<nx>::Zero());
+    std::fill(fonc_hdummy_.begin(), fonc_hdummy_.end(), Vector<nub>::Zero());
+    std::fill(fonc_hmu_.begin(), fonc_hmu_.end(), Vector<nub>::Zero());
+    std::fill(fonc_f_0_.begin(), fonc_f_0_.end(), Vector<nx>::Zero());
+    std::fill(fonc_hx_0_.begin(), fonc_hx_0_.end(), Vector<nx>::Zero());
+    std::fill(fonc_hdummy_0_.begin(), fonc_hdummy_0_.end(), Vector<nub>::Zero());
+    std::fill(fonc_hmu_0_.begin(), fonc_hmu_0_.end(), Vector<nub>::Zero());
+
+    if (settings.sampling_time <= 0.0) {
+      throw std::invalid_argument("[RiccatiNewtonSolver]: 'settings.sampling_time' must be positive!");
+    }
+    if (settings.zeta <= 0.0) {
+      throw std::invalid_argument("[RiccatiNewtonSolver]: 'settings.zeta' must be positive!");
+    }
+  }
+
+  ///
+  /// @brief Default constructor.
+  ///
+  RiccatiNewtonSolver() = default;
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~RiccatiNewtonSolver() = default;
+
+  ///
+  /// @brief Sets the control input vector.
+  /// @param[in] u The control input vector. Size must be RiccatiNewtonSolver::nu.
+  ///
+  template <typename VectorType>
+  void set_u(const MatrixBase<VectorType>& u) {
+    if (u.size() != nu) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::set_u] u.size() must be " + std::to_string(nu));
+    }
+    for (size_t i=0; i<N; ++i) {
+      solution_.template segment<nu>(i*nuc) = u;
+    }
+    retrieveSolution();
+  }
+
+  ///
+  /// @brief Sets the control input vector and Lagrange multiplier with respect to the equality constraints.
+  /// @param[in] uc Concatenatin of the control input vector and Lagrange multiplier with respect to the equality constraints.
+  /// Size must be RiccatiNewtonSolver::nuc.
+  ///
+  template <typename VectorType>
+  void set_uc(const MatrixBase<VectorType>& uc) {
+    if (uc.size() != nuc) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::set_uc] uc.size() must be " + std::to_string(nuc));
+    }
+    for (size_t i=0; i<N; ++i) {
+      solution_.template segment<nuc>(i*nuc) = uc;
+    }
+    retrieveSolution();
+  }
+
+  ///
+  /// @brief Sets the state vector.
+  /// @param[in] x The state vector. Size must be RiccatiNewtonSolver::nx.
+  ///
+  template <typename VectorType>
+  void set_x(const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::set_x] x.size() must be " + std::to_string(nx));
+    }
+    for (size_t i=1; i<=N; ++i) {
+      xopt_[i] = x;
+    }
+  }
+
+  ///
+  /// @brief Sets the costate vector.
+  /// @param[in] lmd The costate vector. Size must be RiccatiNewtonSolver::nx.
+  ///
+  template <typename VectorType>
+  void set_lmd(const MatrixBase<VectorType>& lmd) {
+    if (lmd.size() != nx) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::set_lmd] lmd.size() must be " + std::to_string(nx));
+    }
+    for (size_t i=1; i<=N; ++i) {
+      lmdopt_[i] = lmd;
+    }
+  }
+
+  ///
+  /// @brief Sets the dummy input vector with respect to the control input bounds constraint.
+  /// @param[in] dummy The dummy input vector. Size must be RiccatiNewtonSolver::nub.
+  ///
+  template <typename VectorType>
+  void set_dummy(const MatrixBase<VectorType>& dummy) {
+    if (dummy.size() != nub) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::set_dummy] dummy.size() must be " + std::to_string(nub));
+    }
+    std::fill(dummyopt_.begin(), dummyopt_.end(), dummy);
+  }
+
+  ///
+  /// @brief Sets the Lagrange multiplier with respect to the control input bounds constraint.
+  /// @param[in] mu The Lagrange multiplier. Size must be RiccatiNewtonSolver::nub.
+  ///
+  template <typename VectorType>
+  void set_mu(const MatrixBase<VectorType>& mu) {
+    if (mu.size() != nub) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::set_mu] mu.size() must be " + std::to_string(nub));
+    }
+    std::fill(muopt_.begin(), muopt_.end(), mu);
+  }
+
+  ///
+  /// @brief Initializes the state vectors and costate vectors by simulating the system dynamics and system costate dynamcis over the horizon.
+  /// @param[in] t Initial time of the horizon.
+  /// @param[in] x Initial state of the horizon. Size must be RiccatiNewtonSolver::nx.
+  ///
+  template <typename VectorType>
+  void init_x_lmd(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::init_x_lmd] x.size() must be " + std::to_string(nx));
+    }
+    nlp_.synchronize_ocp();
+    std::fill(fonc_f_.begin(), fonc_f_.end(), Vector<nx>::Zero());
+    std::fill(fonc_hx_.begin(), fonc_hx_.end(), Vector<nx>::Zero());
+    nlp_.retrieve_x(t, x, solution_, xopt_, fonc_f_);
+    nlp_.retrieve_lmd(t, x, solution_, xopt_, lmdopt_, fonc_hx_);
+  }
+
+  ///
+  /// @brief Initializes the dummy input vectors and Lagrange multipliers with respect to the control input bounds constraint.
+  ///
+  void init_dummy_mu() {
+    if constexpr (nub > 0) {
+      std::fill(dummyopt_.begin(), dummyopt_.end(), Vector<nub>::Zero());
+      std::fill(muopt_.begin(), muopt_.end(), Vector<nub>::Zero());
+      nlp_.eval_fonc_hmu(solution_, dummyopt_, muopt_, fonc_hmu_);
+      for (size_t i=0; i<N; ++i) {
+        dummyopt_[i].array() = fonc_hmu_[i].array().abs().sqrt();
+      }
+      nlp_.clip_dummy(dummyopt_, settings_.min_dummy);
+      nlp_.eval_fonc_hdummy(solution_, dummyopt_, muopt_, fonc_hdummy_);
+      for (size_t i=0; i<N; ++i) {
+        muopt_[i].array() = - fonc_hdummy_[i].array() / (2.0 * dummyopt_[i].array());
+      }
+    }
+  }
+
+  ///
+  /// @brief Getter of the optimal solution.
+  /// @return const reference to the optimal control input vectors over the horizon.
+  ///
+  const std::array<Vector<nu>, N>& uopt() const { return uopt_; }
+
+  ///
+  /// @brief Getter of the optimal solution.
+  /// @return const reference to the optimal concatenatins of the control input vector and Lagrange multiplier with respect to the equality constraints.
+  ///
+  const std::array<Vector<nuc>, N>& ucopt() const { return ucopt_; }
+
+  ///
+  /// @brief Getter of the optimal solution.
+  /// @return const reference to the optimal state vectors over the horizon.
+  ///
+  const std::array<Vector<nx>, N+1>& xopt() const { return xopt_; }
+
+  ///
+  /// @brief Getter of the optimal solution.
+  /// @return const reference to the optimal costate vectors over the horizon.
+  ///
+  const std::array<Vector<nx>, N+1>& lmdopt() const { return lmdopt_; }
+
+  ///
+  /// @brief Getter of the optimal solution.
+  /// @return const reference to the optimal dummy input vectors with respect to the control input bounds constraint over the horizon.
+  ///
+  const std::array<Vector<nub>, N>& dummyopt() const { return dummyopt_; }
+
+  ///
+  /// @brief Getter of the optimal solution.
+  /// @return const reference to the Lagrange multipliers with respect to the control input bounds constraint over the horizon.
+  ///
+  const std::array<Vector<nub>, N>& muopt() const { return muopt_; }
+
+  ///
+  /// @brief Gets the l2-norm of the optimality errors evaluated in the last update() or solve().
+  /// @return The l2-norm of the optimality errors.
+  ///
+  Scalar optError() const { return opt_error_; }
+
+  ///
+  /// @brief Computes and gets the l2-norm of the current optimality errors.
+  /// @param[in] t Initial time of the horizon.
+  /// @param[in] x Initial state of the horizon. Size must be RiccatiNewtonSolver::nx.
+  /// @return The l2-norm of the current optimality errors.
+  ///
+  template <typename VectorType>
+  Scalar optError(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::optError] x.size() must be " + std::to_string(nx));
+    }
+    nlp_.synchronize_ocp();
+    evalFONC(t, x);
+    opt_error_ = normFONC();
+    return opt_error_;
+  }
+
+  ///
+  /// @brief Updates the solution by a Newton-type step of the continuation. As
+  /// MultipleShootingCGMRESSolver::update(), the optimality conditions are traced
+  /// from t to t + SolverSettings::sampling_time with the stabilization SolverSettings::zeta,
+  /// i.e., the step is the exact Newton step at the predicted state if
+  /// zeta * sampling_time is 1. The step is solved by the Riccati recursion.
+  /// @param[in] t Initial time of the horizon.
+  /// @param[in] x Initial state of the horizon. Size must be RiccatiNewtonSolver::nx.
+  ///
+  template <typename VectorType>
+  void update(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::update] x.size() must be " + std::to_string(nx));
+    }
+    if (settings_.profile_solver) timer_.tick();
+    nlp_.synchronize_ocp();
+    const Scalar dt = settings_.sampling_time;
+    const Scalar t1 = t + dt;
+    // The residual of the continuation is F(t1, x1) - (1 - zeta * dt) * F(t, x).
+    const Scalar c = 1.0 - settings_.zeta * dt;
+    if (c != 0.0) {
+      evalFONC(t, x);
+      fonc_hu_0_ = fonc_hu_;
+      fonc_f_0_ = fonc_f_;
+      fonc_hx_0_ = fonc_hx_;
+      fonc_hdummy_0_ = fonc_hdummy_;
+      fonc_hmu_0_ = fonc_hmu_;
+    }
+    nlp_.ocp().eval_f(t, x.derived().data(), solution_.template head<nuc>().data(), dx_.data());
+    x1_ = x + dt * dx_;
+    evalFONC(t1, x1_);
+    opt_error_ = normFONC();
+    if (c != 0.0) {
+      fonc_hu_.noalias() -= c * fonc_hu_0_;
+      for (size_t i=0; i<=N; ++i) {
+        fonc_f_[i].noalias() -= c * fonc_f_0_[i];
+        fonc_hx_[i].noalias() -= c * fonc_hx_0_[i];
+      }
+      if constexpr (nub > 0) {
+        for (size_t i=0; i<N; ++i) {
+          fonc_hdummy_[i].noalias() -= c * fonc_hdummy_0_[i];
+          fonc_hmu_[i].noalias() -= c * fonc_hmu_0_[i];
+        }
+      }
+    }
+    newtonStep(t1, x1_);
+    if (settings_.profile_solver) timer_.tock();
+  }
+
+  ///
+  /// @brief Solves the OCP at a fixed time by the Newton iterations, e.g., to
+  /// initialize the solution. The iterations stop if the optimality error is below
+  /// SolverSettings::opterr_tol or the number of the iterations reaches SolverSettings::max_iter.
+  /// @param[in] t Initial time of the horizon.
+  /// @param[in] x Initial state of the horizon. Size must be RiccatiNewtonSolver::nx.
+  /// @return The number of the Newton iterations.
+  ///
+  template <typename VectorType>
+  size_t solve(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[RiccatiNewtonSolver::solve] x.size() must be " + std::to_string(nx));
+    }
+    nlp_.synchronize_ocp();
+    size_t iter = 0;
+    for (; iter<settings_.max_iter; ++iter) {
+      evalFONC(t, x);
+      opt_error_ = normFONC();
+      if (opt_error_ < settings_.opterr_tol) break;
+      newtonStep(t, x);
+    }
+    if (iter == settings_.max_iter) {
+      evalFONC(t, x);
+      opt_error_ = normFONC();
+    }
+    return iter;
+  }
+
+  ///
+  /// @brief Get timing result as TimingProfile.
+  /// @return Timing profile.
+  ///
+  TimingProfile getProfile() const {
+    return timer_.getProfile();
+  }
+
+  void disp(std::ostream& os) const {
+    os << "Riccati Newton solver: " << std::endl;
+    os << "  N:    " << N << "\n" << std::endl;
+    os << nlp_.ocp() << std::endl;
+    os << nlp_.horizon() << std::endl;
+    os << settings_ << std::endl;
+    os << timer_.getProfile() << std::endl;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const RiccatiNewtonSolver& solver) {
+    solver.disp(os);
+    return os;
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  MultipleShootingNLP_ nlp_;
+  RiccatiRecursion_ riccati_;
+  SolverSettings settings_;
+  Timer timer_;
+
+  std::array<Vector<nu>, N> uopt_;
+  std::array<Vector<nuc>, N> ucopt_;
+  std::array<Vector<nx>, N+1> xopt_;
+  std::array<Vector<nx>, N+1> lmdopt_;
+  std::array<Vector<nub>, N> dummyopt_;
+  std::array<Vector<nub>, N> muopt_;
+
+  Vector<dim> solution_, solution_update_;
+  std::array<Vector<nx>, N+1> x_update_, lmd_update_;
+
+  Vector<dim> fonc_hu_, fonc_hu_0_;
+  std::array<Vector<nx>, N+1> fonc_f_, fonc_hx_, fonc_f_0_, fonc_hx_0_;
+  std::array<Vector<nub>, N> fonc_hdummy_, fonc_hmu_, fonc_hdummy_0_, fonc_hmu_0_;
+  Scalar opt_error_ = 0.0;
+
+  Vector<nx> x0_, x1_, dx_, xp_, xm_, lmdp_, lmdm_, fp_, fm_, hxp_, hxm_;
+  Vector<nuc> ucp_, ucm_, hup_, hum_;
+
+  template <typename VectorType>
+  void evalFONC(const Scalar t, const MatrixBase<VectorType>& x) {
+    nlp_.eval_fonc_hu(t, x, solution_, xopt_, lmdopt_, fonc_hu_);
+    nlp_.eval_fonc_f(t, x, solution_, xopt_, fonc_f_);
+    nlp_.eval_fonc_hx(t, x, solution_, xopt_, lmdopt_, fonc_hx_);
+    if constexpr (nub > 0) {
+      nlp_.eval_fonc_hu(solution_, dummyopt_, muopt_, fonc_hu_);
+      nlp_.eval_fonc_hdummy(solution_, dummyopt_, muopt_, fonc_hdummy_);
+      nlp_.eval_fonc_hmu(solution_, dummyopt_, muopt_, fonc_hmu_);
+    }
+  }
+
+  Scalar normFONC() const {
+    Scalar squared_error = fonc_hu_.squaredNorm();
+    for (size_t i=0; i<=N; ++i) {
+      squared_error += fonc_f_[i].squaredNorm() + fonc_hx_[i].squaredNorm();
+    }
+    if constexpr (nub > 0) {
+      for (size_t i=0; i<N; ++i) {
+        squared_error += fonc_hdummy_[i].squaredNorm() + fonc_hmu_[i].squaredNorm();
+      }
+    }
+    return std::sqrt(squared_error);
+  }
+
+  // Newton step around the current solution at (t, x) with the residuals fonc_*.
+  template <typename VectorType>
+  void newtonStep(const Scalar t, const MatrixBase<VectorType>& x) {
+    linearize(t, x);
+    riccati_.backward_recursion(fonc_hu_, fonc_f_, fonc_hx_);
+    riccati_.forward_recursion(fonc_f_, solution_update_, x_update_, lmd_update_);
+    if constexpr (nub > 0) {
+      // The updates of dummy and mu eliminated in linearize().
+      const auto& ocp = nlp_.ocp();
+      for (size_t i=0; i<N; ++i) {
+        for (int j=0; j<nub; ++j) {
+          const auto uj = OCP::ubound_indices[j];
+          const Scalar u = solution_.coeff(i*nuc+uj);
+          const Scalar du = solution_update_.coeff(i*nuc+uj);
+          const Scalar g = 2.0 * u - ocp.umin[j] - ocp.umax[j];
+          const Scalar dummy = dummyopt_[i].coeff(j);
+          const Scalar mu = muopt_[i].coeff(j);
+          const Scalar ddummy = - (fonc_hmu_[i].coeff(j) + g * du) / (2.0 * dummy);
+          const Scalar dmu = - (fonc_hdummy_[i].coeff(j) + 2.0 * mu * ddummy) / (2.0 * dummy);
+          dummyopt_[i].coeffRef(j) += ddummy;
+          muopt_[i].coeffRef(j) += dmu;
+        }
+      }
+      nlp_.clip_dummy(dummyopt_, settings_.min_dummy);
+    }
+    solution_.noalias() += solution_update_;
+    for (size_t i=1; i<=N; ++i) {
+      xopt_[i].noalias() += x_update_[i];
+      lmdopt_[i].noalias() += lmd_update_[i];
+    }
+    retrieveSolution();
+  }
+
+  // Stage Jacobians of the optimality conditions. They are exact if the OCP provides the 
+  // directional derivatives generated by AutoGenU. Huu and Hux are given by eval_huu() and 
+  // eval_hux() if the OCP provides them. Otherwise, they are computed by the central 
+  // finite differences with the step of the cube root of the machine epsilon, which balances 
+  // the truncation and rounding errors. The updates of dummy and mu are eliminated from the 
+  // conditions with respect to the control input, which modifies Huu and fonc_hu_.
+  template <typename VectorType>
+  void linearize(const Scalar t, const MatrixBase<VectorType>& x) {
+    const auto& ocp = nlp_.ocp();
+    const Scalar T = nlp_.horizon().T(t);
+    const Scalar dt = T / N;
+    x0_ = x;
+    for (int i=0; i<N; ++i) {
+      auto& stage = riccati_.stage(i);
+      const Scalar ti = t + i * dt;
+      const Vector<nx>& xi = (i == 0) ? x0_ : xopt_[i];
+      const Vector<nuc>& uci = solution_.template segment<nuc>(nuc*i);
+      const Vector<nx>& lmdi = lmdopt_[i+1];
+      if constexpr (detail::has_jvp<OCP>::value) {
+        linearizeStageExact(i, ti, dt, xi, uci, lmdi);
+      }
+      else {
+        linearizeStageFiniteDifference(i, ti, dt, xi, uci, lmdi);
+      }
+      if constexpr (detail::has_eval_huu<OCP>::value) {
+        ocp.eval_huu(ti, xi.data(), uci.data(), lmdi.data(), stage.Huu.data());
+      }
+      if constexpr (detail::has_eval_hux<OCP>::value) {
+        if (i > 0) {
+          ocp.eval_hux(ti, xi.data(), uci.data(), lmdi.data(), stage.Hux.data());
+        }
+      }
+      if constexpr (nub > 0) {
+        for (int j=0; j<nub; ++j) {
+          const auto uj = OCP::ubound_indices[j];
+          const Scalar g = 2.0 * uci.coeff(uj) - ocp.umin[j] - ocp.umax[j];
+          const Scalar dummy = dummyopt_[i].coeff(j);
+          const Scalar mu = muopt_[i].coeff(j);
+          stage.Huu.coeffRef(uj, uj) += 2.0 * mu + mu * g * g / (2.0 * dummy * dummy);
+          fonc_hu_.coeffRef(nuc*i+uj)
+              += g * (- fonc_hdummy_[i].coeff(j) + mu * fonc_hmu_[i].coeff(j) / dummy) / (2.0 * dummy);
+        }
+      }
+    }
+    auto& terminal_hessian = riccati_.terminal_hessian();
+    if constexpr (detail::has_jvp<OCP>::value) {
+      for (int j=0; j<nx; ++j) {
+        dx_.setZero(); dx_.coeffRef(j) = 1.0;
+        ocp.eval_phix_jvp(t+T, xopt_[N].data(), dx_.data(), fp_.data());
+        terminal_hessian.col(j) = fp_;
+      }
+    }
+    else {
+      const Scalar eps = std::cbrt(std::numeric_limits<Scalar>::epsilon());
+      for (int j=0; j<nx; ++j) {
+        xp_ = xopt_[N]; xp_.coeffRef(j) += eps;
+        xm_ = xopt_[N]; xm_.coeffRef(j) -= eps;
+        ocp.eval_phix(t+T, xp_.data(), fp_.data());
+        ocp.eval_phix(t+T, xm_.data(), fm_.data());
+        terminal_hessian.col(j) = (0.5 / eps) * (fp_ - fm_);
+      }
+    }
+  }
+
+  // Stage Jacobians by the directional derivatives along the unit vectors. Since only the 
+  // state equation depends on the costate, G = A^T and Hul = (df/du)^T.
+  void linearizeStageExact(const int i, const Scalar ti, const Scalar dt, const Vector<nx>& xi, 
+                           const Vector<nuc>& uci, const Vector<nx>& lmdi) {
+    const auto& ocp = nlp_.ocp();
+    auto& stage = riccati_.stage(i);
+    dx_.setZero();
+    ucp_.setZero();
+    lmdp_.setZero();
+    // Derivatives with respect to the state. Not needed at the initial stage since dx_0 = 0.
+    if (i > 0) {
+      for (int j=0; j<nx; ++j) {
+        dx_.coeffRef(j) = 1.0;
+        ocp.eval_f_jvp(ti, xi.data(), uci.data(), dx_.data(), ucp_.data(), fp_.data());
+        stage.A.col(j) = dt * fp_;
+        stage.A.coeffRef(j, j) += 1.0;
+        ocp.eval_hx_jvp(ti, xi.data(), uci.data(), lmdi.data(), dx_.data(), ucp_.data(), lmdp_.data(), hxp_.data());
+        stage.Hxx.col(j) = dt * hxp_;
+        if constexpr (!detail::has_eval_hux<OCP>::value) {
+          ocp.eval_hu_jvp(ti, xi.data(), uci.data(), lmdi.data(), dx_.data(), ucp_.data(), lmdp_.data(), hup_.data());
+          stage.Hux.col(j) = hup_;
+        }
+        dx_.coeffRef(j) = 0.0;
+      }
+      stage.G = stage.A.transpose();
+    }
+    for (int j=0; j<nuc; ++j) {
+      ucp_.coeffRef(j) = 1.0;
+      ocp.eval_f_jvp(ti, xi.data(), uci.data(), dx_.data(), ucp_.data(), fp_.data());
+      stage.B.col(j) = dt * fp_;
+      stage.Hul.row(j) = fp_.transpose();
+      if (i > 0) {
+        ocp.eval_hx_jvp(ti, xi.data(), uci.data(), lmdi.data(), dx_.data(), ucp_.data(), lmdp_.data(), hxp_.data());
+        stage.Hxu.col(j) = dt * hxp_;
+      }
+      if constexpr (!detail::has_eval_huu<OCP>::value) {
+        ocp.eval_hu_jvp(ti, xi.data(), uci.data(), lmdi.data(), dx_.data(), ucp_.data(), lmdp_.data(), hup_.data());
+        stage.Huu.col(j) = hup_;
+      }
+      ucp_.coeffRef(j) = 0.0;
+    }
+  }
+
+  // Stage Jacobians by the central finite differences.
+  void linearizeStageFiniteDifference(const int i, const Scalar ti, const Scalar dt, const Vector<nx>& xi, 
+                                      const Vector<nuc>& uci, const Vector<nx>& lmdi) {
+    const auto& ocp = nlp_.ocp();
+    auto& stage = riccati_.stage(i);
+    const Scalar eps = std::cbrt(std::numeric_limits<Scalar>::epsilon());
+    // Derivatives with respect to the state. Not needed at the initial stage since dx_0 = 0.
+    if (i > 0) {
+      for (int j=0; j<nx; ++j) {
+        xp_ = xi; xp_.coeffRef(j) += eps;
+        xm_ = xi; xm_.coeffRef(j) -= eps;
+        ocp.eval_f(ti, xp_.data(), uci.data(), fp_.data());
+        ocp.eval_f(ti, xm_.data(), uci.data(), fm_.data());
+        stage.A.col(j) = (0.5 * dt / eps) * (fp_ - fm_);
+        stage.A.coeffRef(j, j) += 1.0;
+        ocp.eval_hx(ti, xp_.data(), uci.data(), lmdi.data(), hxp_.data());
+        ocp.eval_hx(ti, xm_.data(), uci.data(), lmdi.data(), hxm_.data());
+        stage.Hxx.col(j) = (0.5 * dt / eps) * (hxp_ - hxm_);
+        if constexpr (!detail::has_eval_hux<OCP>::value) {
+          ocp.eval_hu(ti, xp_.data(), uci.data(), lmdi.data(), hup_.data());
+          ocp.eval_hu(ti, xm_.data(), uci.data(), lmdi.data(), hum_.data());
+          stage.Hux.col(j) = (0.5 / eps) * (hup_ - hum_);
+        }
+      }
+      for (int j=0; j<nx; ++j) {
+        lmdp_ = lmdi; lmdp_.coeffRef(j) += eps;
+        lmdm_ = lmdi; lmdm_.coeffRef(j) -= eps;
+        ocp.eval_hx(ti, xi.data(), uci.data(), lmdp_.data(), hxp_.data());
+        ocp.eval_hx(ti, xi.data(), uci.data(), lmdm_.data(), hxm_.data());
+        stage.G.col(j) = (0.5 * dt / eps) * (hxp_ - hxm_);
+        stage.G.coeffRef(j, j) += 1.0;
+      }
+    }
+    for (int j=0; j<nuc; ++j) {
+      ucp_ = uci; ucp_.coeffRef(j) += eps;
+      ucm_ = uci; ucm_.coeffRef(j) -= eps;
+      ocp.eval_f(ti, xi.data(), ucp_.data(), fp_.data());
+      ocp.eval_f(ti, xi.data(), ucm_.data(), fm_.data());
+      stage.B.col(j) = (0.5 * dt / eps) * (fp_ - fm_);
+      if (i > 0) {
+        ocp.eval_hx(ti, xi.data(), ucp_.data(), lmdi.data(), hxp_.data());
+        ocp.eval_hx(ti, xi.data(), ucm_.data(), lmdi.data(), hxm_.data());
+        stage.Hxu.col(j) = (0.5 * dt / eps) * (hxp_ - hxm_);
+      }
+      if constexpr (!detail::has_eval_huu<OCP>::value) {
+        ocp.eval_hu(ti, xi.data(), ucp_.data(), lmdi.data(), hup_.data());
+        ocp.eval_hu(ti, xi.data(), ucm_.data(), lmdi.data(), hum_.data());
+        stage.Huu.col(j) = (0.5 / eps) * (hup_ - hum_);
+      }
+    }
+    for (int j=0; j<nx; ++j) {
+      lmdp_ = lmdi; lmdp_.coeffRef(j) += eps;
+      lmdm_ = lmdi; lmdm_.coeffRef(j) -= eps;
+      ocp.eval_hu(ti, xi.data(), uci.data(), lmdp_.data(), hup_.data());
+      ocp.eval_hu(ti, xi.data(), uci.data(), lmdm_.data(), hum_.data());
+      stage.Hul.col(j) = (0.5 / eps) * (hup_ - hum_);
+    }
+  }
+
+  void retrieveSolution() {
+    for (size_t i=0; i<N; ++i) {
+      uopt_[i] = solution_.template segment<nu>(i*nuc);
+      ucopt_[i] = solution_.template segment<nuc>(i*nuc);
+    }
+  }
+
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__RICCATI_NEWTON_SOLVER_HPP_
@@ -0,0 +1,269 @@
+#ifndef CGMRES__SCENARIO_OCP_HPP_
+#define CGMRES__SCENARIO_OCP_HPP_
+
+#include <array>
+#include <stdexcept>
+#include <iostream>
+#include <type_traits>
+
+#include "cgmres/types.hpp"
+
+#include "cgmres/detail/ocp_synchronization.hpp"
+
+
+namespace cgmres {
+
+namespace detail {
+
+template <class OCP, int S>
+constexpr std::array<int, S*OCP::nub> stacked_ubound_indices() {
+  std::array<int, S*OCP::nub> indices = {};
+  for (int s=0; s<S; ++s) {
+    for (int i=0; i<OCP::nub; ++i) {
+      indices[s*OCP::nub+i] = s * OCP::nuc + OCP::ubound_indices[i];
+    }
+  }
+  return indices;
+}
+
+} // namespace detail
+
+///
+/// @class ScenarioOCP
+/// @brief Multi-scenario (scenario-tree) OCP built from S copies of an OCP, e.g.,
+/// one per hypothesis of an uncertain fault parameter. The state is the stack of the
+/// S scenario states and the control input of each stage is the stack of the S scenario
+/// control inputs. The first-stage control input is shared by all scenarios
+/// (non-anticipativity), which is imposed by MultipleShootingCGMRESSolver
+/// through detail::MultipleShootingScenarioNLP.
+/// @tparam OCP A definition of the optimal control problem (OCP) of each scenario.
+/// @tparam S Number of the scenarios. Must be positive.
+///
+template <class OCP, int S>
+class ScenarioOCP {
+public:
+  static_assert(S > 0);
+
+  ///
+  /// @brief Number of the scenarios.
+  ///
+  static constexpr int num_scenarios = S;
+
+  ///
+  /// @brief Dimension of the state of each scenario.
+  ///
+  static constexpr int nxs = OCP::nx;
+
+  ///
+  /// @brief Dimension of the concatenation of the control input and equality constraints of each scenario.
+  ///
+  static constexpr int nucs = OCP::nuc;
+
+  ///
+  /// @brief Dimension of the bound constraints on the control input of each scenario.
+  ///
+  static constexpr int nubs = OCP::nub;
+
+  ///
+  /// @brief Dimension of the stacked state.
+  ///
+  static constexpr int nx = S * OCP::nx;
+
+  ///
+  /// @brief Dimension of the control input, i.e., that of the first scenario.
+  ///
+  static constexpr int nu = OCP::nu;
+
+  ///
+  /// @brief Dimension of the rest of the stacked control input and equality constraints.
+  ///
+  static constexpr int nc = S * OCP::nuc - OCP::nu;
+
+  ///
+  /// @brief Dimension of the stacked control input and equality constraints.
+  ///
+  static constexpr int nuc = nu + nc;
+
+  ///
+  /// @brief Dimension of the stacked bound constraints on the control input.
+  ///
+  static constexpr int nub = S * OCP::nub;
+
+  static constexpr std::array<int, nub> ubound_indices = detail::stacked_ubound_indices<OCP, S>();
+  std::array<double, nub> umin;
+  std::array<double, nub> umax;
+  std::array<double, nub> dummy_weight;
+
+  ///
+  /// @brief The OCPs of the scenarios.
+  ///
+  std::array<OCP, S> scenarios;
+
+  ///
+  /// @brief Weights (e.g., probabilities) of the scenarios in the robust cost. Default is 1/S.
+  ///
+  std::array<double, S> weights;
+
+  ///
+  /// @brief Number of threads used to evaluate the scenarios in parallel. Default is 1.
+  ///
+  int num_threads = 1;
+
+  ///
+  /// @brief Constructs the multi-scenario OCP.
+  /// @param[in] scenarios The OCPs of the scenarios.
+  /// @param[in] num_threads Number of threads used to evaluate the scenarios. Default is 1.
+  ///
+  explicit ScenarioOCP(const std::array<OCP, S>& scenarios, const int num_threads=1)
+    : scenarios(scenarios),
+      num_threads(num_threads) {
+    if (num_threads <= 0) {
+      throw std::invalid_argument("[ScenarioOCP]: 'num_threads' must be positive!");
+    }
+    weights.fill(1.0/S);
+    synchronize_bounds();
+  }
+
+  ///
+  /// @brief Default constructor.
+  ///
+  ScenarioOCP() {
+    weights.fill(1.0/S);
+    synchronize_bounds();
+  }
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~ScenarioOCP() = default;
+
+  ///
+  /// @brief Stacks a state of a single scenario into the state of this OCP.
+  /// @param[in] x The state. Size must be ScenarioOCP::nxs.
+  /// @return The stacked state.
+  ///
+  template <typename VectorType>
+  static Vector<nx> stack_x(const MatrixBase<VectorType>& x) {
+    if (x.size() != nxs) {
+      throw std::invalid_argument("[ScenarioOCP::stack_x] x.size() must be " + std::to_string(nxs));
+    }
+    Vector<nx> xs;
+    for (int s=0; s<S; ++s) {
+      xs.template segment<nxs>(s*nxs) = x;
+    }
+    return xs;
+  }
+
+  ///
+  /// @brief Stacks a concatenation of the control input and the Lagrange multiplier with
+  /// respect to the equality constraints of a single scenario into that of this OCP.
+  /// @param[in] uc The concatenation. Size must be ScenarioOCP::nucs.
+  /// @return The stacked concatenation.
+  ///
+  template <typename VectorType>
+  static Vector<nuc> stack_uc(const MatrixBase<VectorType>& uc) {
+    if (uc.size() != nucs) {
+      throw std::invalid_argument("[ScenarioOCP::stack_uc] uc.size() must be " + std::to_string(nucs));
+    }
+    Vector<nuc> ucs;
+    for (int s=0; s<S; ++s) {
+      ucs.template segment<nucs>(s*nucs) = uc;
+    }
+    return ucs;
+  }
+
+  ///
+  /// @brief Synchrozies the scenarios with their external references.
+  /// This method is called at the beginning of each MPC update.
+  ///
+  void synchronize() {
+    for (auto& e : scenarios) {
+      e.synchronize();
+    }
+    synchronize_bounds();
+  }
+
+  ///
+  /// @brief Sum of the parameter epochs of the scenarios. Defined only if the 
+  /// OCP of each scenario has parameter_epoch().
+  ///
+  template <class OCP_=OCP, typename=std::enable_if_t<detail::has_parameter_epoch<OCP_>::value>>
+  unsigned long parameter_epoch() const {
+    unsigned long epoch = 0;
+    for (const auto& e : scenarios) {
+      epoch += e.parameter_epoch();
+    }
+    return epoch;
+  }
+
+  ///
+  /// @brief Computes the stacked state equations. Each scenario uses its own control input.
+  ///
+  void eval_f(const double t, const double* x, const double* u, double* dx) const {
+    for (int s=0; s<S; ++s) {
+      scenarios[s].eval_f(t, x+s*nxs, u+s*nucs, dx+s*nxs);
+    }
+  }
+
+  ///
+  /// @brief Computes the stacked partial derivatives of the terminal costs with respect to the state.
+  ///
+  void eval_phix(const double t, const double* x, double* phix) const {
+    for (int s=0; s<S; ++s) {
+      scenarios[s].eval_phix(t, x+s*nxs, phix+s*nxs);
+    }
+  }
+
+  ///
+  /// @brief Computes the stacked partial derivatives of the Hamiltonians with respect to the state.
+  ///
+  void eval_hx(const double t, const double* x, const double* u,
+               const double* lmd, double* hx) const {
+    for (int s=0; s<S; ++s) {
+      scenarios[s].eval_hx(t, x+s*nxs, u+s*nucs, lmd+s*nxs, hx+s*nxs);
+    }
+  }
+
+  ///
+  /// @brief Computes the stacked partial derivatives of the Hamiltonians with respect to
+  /// the control input and the equality constraints.
+  ///
+  void eval_hu(const double t, const double* x, const double* u,
+               const double* lmd, double* hu) const {
+    for (int s=0; s<S; ++s) {
+      scenarios[s].eval_hu(t, x+s*nxs, u+s*nucs, lmd+s*nxs, hu+s*nucs);
+    }
+  }
+
+  void disp(std::ostream& os) const {
+    os << "ScenarioOCP:" << std::endl;
+    os << "  number of scenarios: " << S << std::endl;
+    os << "  number of threads:   " << num_threads << std::endl;
+    for (int s=0; s<S; ++s) {
+      os << "scenario " << s << " (weight: " << weights[s] << "):" << std::endl;
+      os << scenarios[s];
+    }
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const ScenarioOCP& ocp) {
+    ocp.disp(os);
+    return os;
+  }
+
+private:
+  void synchronize_bounds() {
+    if constexpr (nubs > 0) {
+      for (int s=0; s<S; ++s) {
+        for (int i=0; i<nubs; ++i) {
+          umin[s*nubs+i] = scenarios[s].umin[i];
+          umax[s*nubs+i] = scenarios[s].umax[i];
+          dummy_weight[s*nubs+i] = scenarios[s].dummy_weight[i];
+        }
+      }
+    }
+  }
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__SCENARIO_OCP_HPP_
@@ -10,6 +10,7 @@
 #include "cgmres/timer.hpp"
 
 #include "cgmres/detail/matrixfree_gmres.hpp"
+#include "cgmres/detail/solver_state.hpp"
 #include "cgmres/detail/single_shooting_nlp.hpp"
 #include "cgmres/detail/continuation_gmres.hpp"
 
@@ -67,7 +68,8 @@ public:
   ///
   SingleShootingCGMRESSolver(const OCP& ocp, const Horizon& horizon, 
                              const SolverSettings& settings) 
-    : continuation_gmres_(SingleShootingNLP_(ocp, horizon), settings.finite_difference_epsilon, settings.zeta),
+    : continuation_gmres_(SingleShootingNLP_(ocp, horizon), settings.finite_difference_epsilon, settings.zeta, 
+                          settings.use_jvp),
       gmres_(),
       settings_(settings),
       solution_(Vector<dim>::Zero()),
@@ -344,6 +346,43 @@ public:
     }
   }
 
+  ///
+  /// @brief Size in bytes of the solver state written by save_state().
+  ///
+  static constexpr std::size_t state_size = detail::solver_state_size(2*dim + ContinuationGMRES_::state_dim);
+
+  ///
+  /// @brief Saves the solver state, i.e., the solution, its update, the trajectories of the state and costate and the residuals of the 
+  /// continuation, as a flat versioned binary blob. The blob can be copied by memcpy 
+  /// and restored by load_state() of a solver of the same type. Does not allocate memory.
+  /// @param[out] data Pointer to preallocated memory. 
+  /// @param[in] size Size of the memory in bytes. Must be no less than SingleShootingCGMRESSolver::state_size.
+  ///
+  void save_state(void* data, const std::size_t size) const {
+    if (data == nullptr || size < state_size) {
+      throw std::invalid_argument("[SingleShootingCGMRESSolver::save_state] size must be at least " + std::to_string(state_size));
+    }
+    detail::SolverStateWriter writer(data);
+    writer.write(stateHeader());
+    writer.write(solution_);
+    writer.write(solution_update_);
+    continuation_gmres_.save_state(writer);
+  }
+
+  ///
+  /// @brief Restores the solver state saved by save_state(). Does not allocate memory.
+  /// @param[in] data Pointer to the state. 
+  /// @param[in] size Size of the memory in bytes. Must be no less than SingleShootingCGMRESSolver::state_size.
+  ///
+  void load_state(const void* data, const std::size_t size) {
+    detail::check_solver_state_header(data, size, stateHeader(), "SingleShootingCGMRESSolver::load_state");
+    detail::SolverStateReader reader(data);
+    reader.read(solution_);
+    reader.read(solution_update_);
+    continuation_gmres_.load_state(reader);
+    retrieveSolution();
+  }
+
   ///
   /// @brief Get timing result as TimingProfile.
   /// @return Timing profile.
@@ -382,6 +421,11 @@ private:
 
   Vector<dim> solution_, solution_update_; 
 
+  detail::SolverStateHeader stateHeader() const {
+    return detail::make_solver_state_header(detail::SolverStateKind::SingleShooting, 
+                                            nx, nuc, nub, N, dim, kmax, state_size);
+  }
+
   void setInnerSolution() {
     for (size_t i=0; i<N; ++i) {
       const int inucb2 = i * (nuc + 2 * nub);
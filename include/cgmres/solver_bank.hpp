@@ -0,0 +1,242 @@
+#ifndef CGMRES__SOLVER_BANK_HPP_
+#define CGMRES__SOLVER_BANK_HPP_
+
+#include <vector>
+#include <memory>
+#include <exception>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+
+#include "cgmres/types.hpp"
+#include "cgmres/horizon.hpp"
+#include "cgmres/solver_settings.hpp"
+#include "cgmres/multiple_shooting_cgmres_solver.hpp"
+
+#include "cgmres/detail/thread_pool.hpp"
+
+namespace cgmres {
+
+///
+/// @class SolverBank
+/// @brief Bank of multiple-shooting C/GMRES solvers, e.g., one per fault mode
+/// (nominal, partial loss of effectiveness, complete failure of each rotor).
+/// All the solvers are updated with the same measured state in parallel so that
+/// they are kept warm, and the control input is taken from the active one.
+/// Switching the active solver therefore takes effect in the same sample
+/// without a cold re-initialization.
+/// @tparam OCP A definition of the optimal control problem (OCP).
+/// @tparam N Number of discretizationn grids of the horizon. Must be positive.
+/// @tparam kmax Maximum number of the GMRES iterations. Must be positive.
+///
+template <class OCP, int N, int kmax>
+class SolverBank {
+public:
+  using MultipleShootingCGMRESSolver_ = MultipleShootingCGMRESSolver<OCP, N, kmax>;
+
+  ///
+  /// @brief Dimension of the state.
+  ///
+  static constexpr int nx = OCP::nx;
+
+  ///
+  /// @brief Dimension of the control input.
+  ///
+  static constexpr int nu = OCP::nu;
+
+  ///
+  /// @brief Constructs the solver bank.
+  /// @param[in] ocps Definitions of the OCPs, one per solver. Must not be empty.
+  /// @param[in] horizon Prediction horizon of MPC.
+  /// @param[in] settings Solver settings.
+  /// @param[in] num_threads Number of threads used to update the solvers. Default is 1.
+  ///
+  SolverBank(const std::vector<OCP>& ocps, const Horizon& horizon,
+             const SolverSettings& settings, const int num_threads=1)
+    : solvers_(),
+      exceptions_(),
+      thread_pool_(),
+      active_(0) {
+    if (ocps.empty()) {
+      throw std::invalid_argument("[SolverBank]: 'ocps' must not be empty!");
+    }
+    if (num_threads <= 0) {
+      throw std::invalid_argument("[SolverBank]: 'num_threads' must be positive!");
+    }
+    solvers_.reserve(ocps.size());
+    for (const auto& ocp : ocps) {
+      solvers_.emplace_back(ocp, horizon, settings);
+    }
+    exceptions_.resize(ocps.size());
+    thread_pool_ = std::make_unique<detail::ThreadPool>(num_threads);
+  }
+
+  SolverBank(const SolverBank&) = delete;
+
+  SolverBank& operator=(const SolverBank&) = delete;
+
+  ///
+  /// @brief Default destructor.
+  ///
+  ~SolverBank() = default;
+
+  ///
+  /// @brief Gets the number of the solvers.
+  /// @return The number of the solvers.
+  ///
+  int size() const { return solvers_.size(); }
+
+  ///
+  /// @brief Gets a solver, e.g., to initialize it.
+  /// @param[in] i Index of the solver.
+  /// @return Reference to the solver.
+  ///
+  MultipleShootingCGMRESSolver_& solver(const int i) {
+    checkIndex(i, "solver");
+    return solvers_[i];
+  }
+
+  ///
+  /// @brief Gets a solver.
+  /// @param[in] i Index of the solver.
+  /// @return const reference to the solver.
+  ///
+  const MultipleShootingCGMRESSolver_& solver(const int i) const {
+    checkIndex(i, "solver");
+    return solvers_[i];
+  }
+
+  ///
+  /// @brief Switches the active solver. Takes effect immediately, i.e., uopt()
+  /// returns the solution of the new active solver.
+  /// @param[in] i Index of the solver.
+  ///
+  void switch_to(const int i) {
+    checkIndex(i, "switch_to");
+    active_ = i;
+  }
+
+  ///
+  /// @brief Gets the index of the active solver.
+  /// @return The index of the active solver.
+  ///
+  int active() const { return active_; }
+
+  ///
+  /// @brief Gets the active solver.
+  /// @return const reference to the active solver.
+  ///
+  const MultipleShootingCGMRESSolver_& active_solver() const { return solvers_[active_]; }
+
+  ///
+  /// @brief Getter of the optimal solution of the active solver.
+  /// @return const reference to the optimal control input vectors over the horizon.
+  ///
+  const std::array<Vector<nu>, N>& uopt() const { return solvers_[active_].uopt(); }
+
+  ///
+  /// @brief Getter of the optimal solution of the active solver.
+  /// @return const reference to the optimal state vectors over the horizon.
+  ///
+  const std::array<Vector<nx>, N+1>& xopt() const { return solvers_[active_].xopt(); }
+
+  ///
+  /// @brief Gets the l2-norm of the current optimality errors of the active solver.
+  /// @return The l2-norm of the current optimality errors.
+  ///
+  Scalar optError() const { return solvers_[active_].optError(); }
+
+  ///
+  /// @brief Checks if the last update of a solver has finished without an exception. 
+  /// @param[in] i Index of the solver.
+  /// @return true if the last update of the solver has not thrown.
+  ///
+  bool healthy(const int i) const {
+    checkIndex(i, "healthy");
+    return !exceptions_[i];
+  }
+
+  ///
+  /// @brief Gets the exception thrown by the last update of a solver.
+  /// @param[in] i Index of the solver.
+  /// @return The exception, or nullptr if the last update of the solver has not thrown.
+  ///
+  std::exception_ptr exception(const int i) const {
+    checkIndex(i, "exception");
+    return exceptions_[i];
+  }
+
+  ///
+  /// @brief Updates all the solvers with the same state in parallel. An exception 
+  /// thrown by a solver, e.g., by its GMRES, does not stop the other solvers: it 
+  /// is caught and the solver is marked unhealthy until its next successful update 
+  /// (see healthy() and exception()).
+  /// @param[in] t Initial time of the horizon.
+  /// @param[in] x Initial state of the horizon. Size must be SolverBank::nx.
+  ///
+  template <typename VectorType>
+  void update(const Scalar t, const MatrixBase<VectorType>& x) {
+    if (x.size() != nx) {
+      throw std::invalid_argument("[SolverBank::update] x.size() must be " + std::to_string(nx));
+    }
+    x_ = x;
+    thread_pool_->parallel_for(solvers_.size(), [&](const int i) {
+      try {
+        solvers_[i].update(t, x_);
+        exceptions_[i] = nullptr;
+      }
+      catch (...) {
+        exceptions_[i] = std::current_exception();
+      }
+    });
+  }
+
+  ///
+  /// @brief Get timing result of all the solvers merged as TimingProfile. Each count
+  /// is an update of one solver.
+  /// @return Timing profile.
+  ///
+  TimingProfile getProfile() const {
+    TimingProfile profile;
+    for (const auto& e : solvers_) {
+      profile.merge(e.getProfile());
+    }
+    return profile;
+  }
+
+  void disp(std::ostream& os) const {
+    os << "Solver bank: " << std::endl;
+    os << "  number of solvers: " << solvers_.size() << std::endl;
+    os << "  number of threads: " << thread_pool_->num_threads() << std::endl;
+    os << "  active solver:     " << active_ << "\n" << std::endl;
+    for (size_t i=0; i<solvers_.size(); ++i) {
+      os << "solver " << i << (exceptions_[i] ? " (unhealthy):" : ":") << std::endl;
+      os << solvers_[i] << std::endl;
+    }
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const SolverBank& bank) {
+    bank.disp(os);
+    return os;
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  std::vector<MultipleShootingCGMRESSolver_> solvers_;
+  std::vector<std::exception_ptr> exceptions_;
+  std::unique_ptr<detail::ThreadPool> thread_pool_;
+  int active_;
+  Vector<nx> x_;
+
+  void checkIndex(const int i, const char* method) const {
+    if (i < 0 || i >= static_cast<int>(solvers_.size())) {
+      throw std::invalid_argument(std::string("[SolverBank::") + method + "] i must be in [0, "
+                                  + std::to_string(solvers_.size()) + ")");
+    }
+  }
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__SOLVER_BANK_HPP_
@@ -0,0 +1,44 @@
+#ifndef CGMRES__SOLVER_HEALTH_HPP_
+#define CGMRES__SOLVER_HEALTH_HPP_
+
+#include <iostream>
+
+namespace cgmres {
+
+///
+/// @enum SolverHealth
+/// @brief Result of the health check of an update of the solver
+/// (see SolverSettings::health_check).
+///
+enum class SolverHealth {
+  /// The update is healthy.
+  Healthy,
+  /// The solution or the optimality error is not finite.
+  NonFinite,
+  /// The optimality error grows faster than SolverSettings::health_opterr_growth.
+  OptErrorGrowth,
+  /// The GMRES breaks down by non-finite values.
+  GMRESBreakdown
+};
+
+inline std::ostream& operator<<(std::ostream& os, const SolverHealth health) {
+  switch (health) {
+    case SolverHealth::Healthy:
+      os << "healthy";
+      break;
+    case SolverHealth::NonFinite:
+      os << "non-finite";
+      break;
+    case SolverHealth::OptErrorGrowth:
+      os << "opt error growth";
+      break;
+    case SolverHealth::GMRESBreakdown:
+      os << "GMRES breakdown";
+      break;
+  }
+  return os;
+}
+
+} // namespace cgmres
+
+#endif // CGMRES__SOLVER_HEALTH_HPP_
@@ -32,6 +32,16 @@ struct SolverSettings {
   ///
   Scalar finite_difference_epsilon = 1.0e-08;
 
+  ///
+  /// @brief If true and the OCP provides the Jacobian-vector products (JVPs), i.e., 
+  /// eval_f_jvp(), eval_phix_jvp(), eval_hx_jvp(), and eval_hu_jvp(), the operators of 
+  /// SingleShootingCGMRESSolver and MultipleShootingCGMRESSolver use them instead of 
+  /// the finite difference approximation. The JVP operator propagates the sensitivities 
+  /// along the horizon, which is slower than the finite difference approximation 
+  /// for, e.g., QuadrotorFTC. Default is false.
+  ///
+  bool use_jvp = false;
+
   ///
   /// @brief The sampling time of MPC and used in SingleShootingCGMRESSolver
   /// and MultipleShootingCGMRESSolver. Has nothing to do with ZeroHorizonOCPSolver. 
@@ -57,6 +67,230 @@ struct SolverSettings {
   ///
   Scalar min_dummy = 1.0e-03;
 
+  ///
+  /// @brief If true, MultipleShootingCGMRESSolver::update() shifts the previous 
+  /// solution along the horizon (interpolated between the grids, the tail held) by 
+  /// the time elapsed since the time that the solution is computed for, e.g., 
+  /// when updates are skipped or delayed. Has nothing to do with 
+  /// SingleShootingCGMRESSolver or ZeroHorizonOCPSolver. Default is false.
+  ///
+  bool shift_warm_start = false;
+
+  ///
+  /// @brief If true, MultipleShootingCGMRESSolver::update() is event-triggered: 
+  /// the C/GMRES step is skipped and the previous solution is shifted by 
+  /// SolverSettings::sampling_time instead if the optimality error of the last 
+  /// update is below SolverSettings::event_opterr_tol and the measured state is 
+  /// within SolverSettings::event_state_tol of the predicted one. The update is 
+  /// not skipped if the parameter epoch of the OCP has changed, e.g., by ParameterBlock. 
+  /// Has nothing to do with SingleShootingCGMRESSolver or ZeroHorizonOCPSolver. 
+  /// Default is false.
+  ///
+  bool event_triggered = false;
+
+  ///
+  /// @brief Threshold of the l2-norm of the error between the measured and predicted 
+  /// states of the event-triggered update. Must be non-negative. Default is 1.0e-03.
+  ///
+  Scalar event_state_tol = 1.0e-03;
+
+  ///
+  /// @brief Threshold of the optimality error of the event-triggered update. 
+  /// Must be non-negative. Default is 1.0e-03.
+  ///
+  Scalar event_opterr_tol = 1.0e-03;
+
+  ///
+  /// @brief Maximum number of the consecutive skipped updates of the event-triggered 
+  /// update. Default is 10.
+  ///
+  size_t event_max_skips = 10;
+
+  ///
+  /// @brief If true and the OCP has `parameter_epoch()` (see ParameterBlock), 
+  /// MultipleShootingCGMRESSolver::update() corrects the solution by the first-order 
+  /// parametric sensitivity when the epoch has changed before the C/GMRES step, 
+  /// so that a jump of the parameters is tracked within the same update. 
+  /// Has nothing to do with SingleShootingCGMRESSolver or ZeroHorizonOCPSolver. 
+  /// Default is false.
+  ///
+  bool parameter_sensitivity = false;
+
+  ///
+  /// @brief Number of the Newton-type steps of the parametric sensitivity correction 
+  /// (see parameter_sensitivity and MultipleShootingCGMRESSolver::update_ocp()). 
+  /// The first step is the first-order correction and the subsequent ones refine it 
+  /// if the GMRES with kmax iterations does not resolve the step. The solution of the 
+  /// step with the smallest optimality error of the new OCP is kept, or the uncorrected 
+  /// one if no step decreases the error. Must be positive. Default is 1.
+  ///
+  size_t sensitivity_steps = 1;
+
+  ///
+  /// @brief Number of the stages of MultipleShootingCGMRESSolver::homotopy_reinit(), 
+  /// i.e., the number of the intermediate OCPs between the current and target ones 
+  /// (including the target one). Must be positive. Default is 4.
+  ///
+  size_t homotopy_stages = 4;
+
+  ///
+  /// @brief Maximum number of the Newton-GMRES corrector steps at each stage of 
+  /// MultipleShootingCGMRESSolver::homotopy_reinit(). The corrector of a stage stops 
+  /// if the optimality error is below SolverSettings::opterr_tol. Default is 2.
+  ///
+  size_t homotopy_corrector_iter = 2;
+
+  ///
+  /// @brief If true, MultipleShootingCGMRESSolver::update() checks the health of 
+  /// each update, i.e., the finiteness of the solution, the growth of the optimality 
+  /// error, and the breakdown of the GMRES. The solution before the step of a healthy 
+  /// update, i.e., the solution whose optimality error is checked, is saved in a ring of 
+  /// SolverSettings::rollback_depth snapshots, and an unhealthy update is rolled back 
+  /// to the snapshots. Has nothing to do with SingleShootingCGMRESSolver 
+  /// or ZeroHorizonOCPSolver. Default is false.
+  ///
+  bool health_check = false;
+
+  ///
+  /// @brief Maximum ratio of the optimality error to that of the last healthy update. 
+  /// Used only if SolverSettings::health_check is true. Must be larger than 1. 
+  /// Default is 1000.0.
+  ///
+  Scalar health_opterr_growth = 1000.0;
+
+  ///
+  /// @brief Optimality error below which the growth of the optimality error is 
+  /// not checked, e.g., to allow the transient of the initial updates. 
+  /// Used only if SolverSettings::health_check is true. 
+  /// Must be non-negative. Default is 1.0.
+  ///
+  Scalar health_opterr_floor = 1.0;
+
+  ///
+  /// @brief Number of the snapshots of the healthy solutions kept for the rollback. 
+  /// Consecutive unhealthy updates roll back to older snapshots. The memory is 
+  /// allocated in the construction. Used only if SolverSettings::health_check is true. 
+  /// Must be positive. Default is 4.
+  ///
+  size_t rollback_depth = 4;
+
+  ///
+  /// @brief If true, an unhealthy update is followed by the re-initialization of the 
+  /// solution by ZeroHorizonOCPSolver at the current time and state after the rollback. 
+  /// Used only if SolverSettings::health_check is true. Default is false.
+  ///
+  bool health_reinit_zero_horizon = false;
+
+  ///
+  /// @brief Maximum number of the iterations of the re-initialization by 
+  /// ZeroHorizonOCPSolver, which is performed inside the sampling period. 
+  /// SolverSettings::max_iter is not used for it. Used only if 
+  /// SolverSettings::health_reinit_zero_horizon is true. Default is 5.
+  ///
+  size_t health_reinit_max_iter = 5;
+
+  ///
+  /// @brief If true, ZeroHorizonOCPSolver::solve() globalizes the Newton method by 
+  /// a backtracking line search on the l2-norm of the optimality errors. 
+  /// Has nothing to do with SingleShootingCGMRESSolver or MultipleShootingCGMRESSolver. 
+  /// Default is false.
+  ///
+  bool line_search = false;
+
+  ///
+  /// @brief Maximum number of the backtracking steps of the line search. 
+  /// Used only if SolverSettings::line_search is true. Default is 10.
+  ///
+  size_t max_line_search_iter = 10;
+
+  ///
+  /// @brief Reduction rate of the step size in the backtracking line search. 
+  /// Used only if SolverSettings::line_search is true. Must be in (0, 1). Default is 0.5.
+  ///
+  Scalar line_search_reduction = 0.5;
+
+  ///
+  /// @brief Maximum l2-norm of the Newton step taken when the line search fails, 
+  /// i.e., the radius of the trust region of the fallback step. 
+  /// Used only if SolverSettings::line_search is true. Must be positive. Default is 1.0.
+  ///
+  Scalar max_step_norm = 1.0;
+
+  ///
+  /// @brief If true, ZeroHorizonOCPSolver::solve() computes the Newton step by the LU 
+  /// factorization of the exact Jacobian of the optimality conditions instead of the 
+  /// matrix-free GMRES if the OCP provides eval_huu(). Default is true.
+  ///
+  bool exact_jacobian = true;
+
+  ///
+  /// @brief If true, MultipleShootingCGMRESSolver::update() reuses the condensed 
+  /// Jacobian of the continuation: the Jacobian is assembled by the directional 
+  /// derivatives of the condensed optimality conditions and LU-factorized over the 
+  /// updates (see SolverSettings::jacobian_assembly_time), is corrected by Broyden's 
+  /// rank-one updates until the next one is complete, and the update of the solution 
+  /// is computed by the dense solve with it. The matrix-free GMRES is used instead 
+  /// while no Jacobian is available, e.g., after the solution or the OCP is replaced, 
+  /// and if the residual of the quasi-Newton step exceeds SolverSettings::quasi_newton_tol. 
+  /// It pays off only if the GMRES needs many iterations and the Jacobian stays valid 
+  /// over many updates; e.g., on QuadrotorFTC with N=100 and kmax=10, it is slower than 
+  /// the GMRES both in the median and in the 99th percentile of the update time. 
+  /// Has nothing to do with SingleShootingCGMRESSolver or ZeroHorizonOCPSolver. 
+  /// Default is false.
+  ///
+  bool jacobian_reuse = false;
+
+  ///
+  /// @brief Number of the quasi-Newton steps with a Jacobian after which the assembly 
+  /// of the next one starts. Used only if SolverSettings::jacobian_reuse is true. Must be positive. 
+  /// Default is 50.
+  ///
+  size_t jacobian_refresh_period = 50;
+
+  ///
+  /// @brief Tolerance of the relative residual of the linear problem of the continuation 
+  /// for the quasi-Newton step. If exceeded, the step is discarded and the updates fall back 
+  /// to the matrix-free GMRES until the next Jacobian is assembled. 
+  /// Used only if SolverSettings::jacobian_reuse is true. Must be positive. Default is 0.1.
+  ///
+  Scalar quasi_newton_tol = 0.1;
+
+  ///
+  /// @brief Time in seconds spent on the assembly and LU factorization of the condensed 
+  /// Jacobian in each update. The assembly is spread over the updates column by column 
+  /// and pivot by pivot within this time, but at least one column or pivot is processed 
+  /// in each update unless the deadline of MultipleShootingCGMRESSolver::update() does 
+  /// not allow it. The previous Jacobian is used until the assembly is complete. Used 
+  /// only if SolverSettings::jacobian_reuse is true. Must be positive. Default is 1.0e-04.
+  ///
+  Scalar jacobian_assembly_time = 1.0e-04;
+
+  ///
+  /// @brief Number of the sampled control input sequences of MPPIController in 
+  /// each update. Must be positive. Default is 1024.
+  ///
+  size_t mppi_num_samples = 1024;
+
+  ///
+  /// @brief Temperature of the exponential weights of the samples of MPPIController. 
+  /// A smaller temperature concentrates the weights on the best samples. 
+  /// Must be positive. Default is 1.0.
+  ///
+  Scalar mppi_temperature = 1.0;
+
+  ///
+  /// @brief Standard deviation of the perturbations of the control input sampled 
+  /// by MPPIController. Must be positive. Default is 0.01.
+  ///
+  Scalar mppi_noise_std = 0.01;
+
+  ///
+  /// @brief Seed of the random number streams of MPPIController. The samples are 
+  /// determined by the seed, the number of the updates, and the sample index, and 
+  /// do not depend on the number of the threads. Default is 0.
+  ///
+  unsigned long mppi_seed = 0;
+
   ///
   /// @brief Verbose level. 0: no printings. 1-2: print some things. Default is 0.
   ///
@@ -72,9 +306,38 @@ struct SolverSettings {
     os << "  max iter:                  " << max_iter << std::endl;
     os << "  opterr tol:                " << opterr_tol << std::endl;
     os << "  finite difference epsilon: " << finite_difference_epsilon << std::endl;
+    os << "  use jvp:                   " << std::boolalpha << use_jvp << std::endl;
     os << "  sampling_time:             " << sampling_time << std::endl;
     os << "  zeta:                      " << zeta << std::endl;
     os << "  min dummy:                 " << min_dummy << std::endl;
+    os << "  shift warm start:          " << std::boolalpha << shift_warm_start << std::endl;
+    os << "  event triggered:           " << std::boolalpha << event_triggered << std::endl;
+    os << "  event state tol:           " << event_state_tol << std::endl;
+    os << "  event opterr tol:          " << event_opterr_tol << std::endl;
+    os << "  event max skips:           " << event_max_skips << std::endl;
+    os << "  parameter sensitivity:     " << std::boolalpha << parameter_sensitivity << std::endl;
+    os << "  sensitivity steps:         " << sensitivity_steps << std::endl;
+    os << "  homotopy stages:           " << homotopy_stages << std::endl;
+    os << "  homotopy corrector iter:   " << homotopy_corrector_iter << std::endl;
+    os << "  health check:              " << std::boolalpha << health_check << std::endl;
+    os << "  health opterr growth:      " << health_opterr_growth << std::endl;
+    os << "  health opterr floor:       " << health_opterr_floor << std::endl;
+    os << "  rollback depth:            " << rollback_depth << std::endl;
+    os << "  health reinit:             " << std::boolalpha << health_reinit_zero_horizon << std::endl;
+    os << "  health reinit max iter:    " << health_reinit_max_iter << std::endl;
+    os << "  line search:               " << std::boolalpha << line_search << std::endl;
+    os << "  max line search iter:      " << max_line_search_iter << std::endl;
+    os << "  line search reduction:     " << line_search_reduction << std::endl;
+    os << "  max step norm:             " << max_step_norm << std::endl;
+    os << "  exact jacobian:            " << std::boolalpha << exact_jacobian << std::endl;
+    os << "  jacobian reuse:            " << std::boolalpha << jacobian_reuse << std::endl;
+    os << "  jacobian refresh period:   " << jacobian_refresh_period << std::endl;
+    os << "  quasi newton tol:          " << quasi_newton_tol << std::endl;
+    os << "  jacobian assembly time:    " << jacobian_assembly_time << std::endl;
+    os << "  mppi num samples:          " << mppi_num_samples << std::endl;
+    os << "  mppi temperature:          " << mppi_temperature << std::endl;
+    os << "  mppi noise std:            " << mppi_noise_std << std::endl;
+    os << "  mppi seed:                 " << mppi_seed << std::endl;
     os << "  verbose level:             " << verbose_level << std::endl;
     os << "  profile solver:            " << std::boolalpha << profile_solver << std::endl;
   }
@@ -1,14 +1,53 @@
 #ifndef CGMRES__TIMER_HPP_
 #define CGMRES__TIMER_HPP_
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "cgmres/types.hpp"
 
+#include "cgmres/detail/latency_histogram.hpp"
+
 
 namespace cgmres {
 
+///
+/// @class PhaseTimingProfile  
+/// @brief A profile of the timing benchmark of a phase of the solver, e.g., the
+/// Arnoldi process. See CGMRES_ENABLE_PHASE_PROFILING.
+///
+struct PhaseTimingProfile {
+  ///
+  /// @brief Name of the phase.
+  ///
+  std::string name;
+
+  ///
+  /// @brief Total computational time in milliseconds.
+  ///
+  Scalar total_time_ms = 0;
+
+  ///
+  /// @brief Average computational time of a probe in milliseconds.
+  ///
+  Scalar average_time_ms = 0;
+
+  ///
+  /// @brief Maximum computational time of a probe in milliseconds.
+  ///
+  Scalar max_time_ms = 0;
+
+  ///
+  /// @brief Number of the probes.
+  ///
+  unsigned long counts = 0;
+};
+
+
 ///
 /// @class TimingProfile  
 /// @brief A profile of the timing benchmark. 
@@ -29,11 +68,116 @@ struct TimingProfile {
   ///
   unsigned long counts = 0;
 
+  ///
+  /// @brief Median computational time in milliseconds.
+  ///
+  Scalar p50_time_ms = 0;
+
+  ///
+  /// @brief 90th percentile of the computational time in milliseconds.
+  ///
+  Scalar p90_time_ms = 0;
+
+  ///
+  /// @brief 99th percentile of the computational time in milliseconds.
+  ///
+  Scalar p99_time_ms = 0;
+
+  ///
+  /// @brief 99.9th percentile of the computational time in milliseconds.
+  ///
+  Scalar p999_time_ms = 0;
+
+  ///
+  /// @brief 99.99th percentile of the computational time in milliseconds.
+  ///
+  Scalar p9999_time_ms = 0;
+
+  ///
+  /// @brief Log-linear histogram of the computational times in nanoseconds. 
+  /// The percentiles are the upper bounds of its buckets, i.e., overestimate
+  /// the exact ones by less than 1 / 64 (1.6%), or by less than one unit of the 
+  /// histogram (128 ns) below 64 units (about 8 us).
+  ///
+  detail::LatencyHistogram histogram;
+
+  ///
+  /// @brief Breakdown of the computational time into the phases of the solver. 
+  /// Empty unless CGMRES_ENABLE_PHASE_PROFILING is defined.
+  ///
+  std::vector<PhaseTimingProfile> phases;
+
+  ///
+  /// @brief Gets a percentile of the computational time from the histogram.
+  /// @param[in] percentile Percentile in [0, 100].
+  /// @return The percentile in milliseconds.
+  ///
+  Scalar percentile_time_ms(const Scalar percentile) const {
+    return 1.0e-06 * histogram.quantile(0.01 * percentile);
+  }
+
+  ///
+  /// @brief Merges another timing profile, e.g., of another solver instance or
+  /// thread, into this profile.
+  /// @param[in] other The timing profile.
+  ///
+  void merge(const TimingProfile& other) {
+    if (other.counts == 0) return;
+    const unsigned long total_counts = counts + other.counts;
+    average_time_ms = (counts * average_time_ms + other.counts * other.average_time_ms) / total_counts;
+    max_time_ms = std::max(max_time_ms, other.max_time_ms);
+    counts = total_counts;
+    histogram.merge(other.histogram);
+    update_percentiles();
+    for (const auto& other_phase : other.phases) {
+      auto phase = std::find_if(phases.begin(), phases.end(), 
+                                [&](const PhaseTimingProfile& e) { return e.name == other_phase.name; });
+      if (phase == phases.end()) {
+        phases.push_back(other_phase);
+        continue;
+      }
+      phase->total_time_ms += other_phase.total_time_ms;
+      phase->max_time_ms = std::max(phase->max_time_ms, other_phase.max_time_ms);
+      phase->counts += other_phase.counts;
+      phase->average_time_ms = (phase->counts > 0) ? phase->total_time_ms / phase->counts : 0.0;
+    }
+  }
+
+  ///
+  /// @brief Sets the percentiles from the histogram. The percentiles are capped by 
+  /// the maximum time.
+  ///
+  void update_percentiles() {
+    p50_time_ms = std::min(percentile_time_ms(50.0), max_time_ms);
+    p90_time_ms = std::min(percentile_time_ms(90.0), max_time_ms);
+    p99_time_ms = std::min(percentile_time_ms(99.0), max_time_ms);
+    p999_time_ms = std::min(percentile_time_ms(99.9), max_time_ms);
+    p9999_time_ms = std::min(percentile_time_ms(99.99), max_time_ms);
+  }
+
   void disp(std::ostream& os) const {
     os << "TimingProfile: " << std::endl; 
     os << "  average time: " << average_time_ms << " [ms]" << std::endl;
     os << "  max time:     " << max_time_ms << " [ms]" << std::endl;
+    os << "  p50 time:     " << p50_time_ms << " [ms]" << std::endl;
+    os << "  p90 time:     " << p90_time_ms << " [ms]" << std::endl;
+    os << "  p99 time:     " << p99_time_ms << " [ms]" << std::endl;
+    os << "  p99.9 time:   " << p999_time_ms << " [ms]" << std::endl;
+    os << "  p99.99 time:  " << p9999_time_ms << " [ms]" << std::endl;
     os << "  counts:       " << counts << std::endl;
+    if (!phases.empty()) {
+      const Scalar total_time_ms = average_time_ms * counts;
+      os << "  phases: " << std::endl;
+      for (const auto& e : phases) {
+        os << "    " << e.name << ": " << std::string(std::max<int>(11-e.name.size(), 0), ' ')
+           << e.total_time_ms << " [ms]";
+        if (total_time_ms > 0.0) {
+          os << " (" << 100.0 * e.total_time_ms / total_time_ms << "%)";
+        }
+        os << ", average: " << e.average_time_ms << " [ms], max: " << e.max_time_ms 
+           << " [ms], counts: " << e.counts << std::endl;
+      }
+    }
   }
 
   friend std::ostream& operator<<(std::ostream& os, const TimingProfile& profile) {
@@ -63,6 +207,7 @@ public:
     counts_ = 0;
     total_elapsed_time_ = 0;
     max_elapsed_time_ = 0;
+    histogram_.reset();
   }
 
   ///
@@ -80,9 +225,21 @@ public:
     const std::chrono::duration<Scalar, std::milli> elapsed_time = now - time_point_;
     total_elapsed_time_ += elapsed_time.count();
     max_elapsed_time_ = std::max(max_elapsed_time_, elapsed_time.count());
+    histogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - time_point_).count());
     ++counts_;
   }
 
+  ///
+  /// @brief Merges the timing results of another timer, e.g., of another thread.
+  /// @param[in] other The timer.
+  ///
+  void merge(const Timer& other) {
+    counts_ += other.counts_;
+    total_elapsed_time_ += other.total_elapsed_time_;
+    max_elapsed_time_ = std::max(max_elapsed_time_, other.max_elapsed_time_);
+    histogram_.merge(other.histogram_);
+  }
+
   ///
   /// @brief Get timing result as TimingProfile.
   /// @return Timing profile.
@@ -93,6 +250,8 @@ public:
       profile.average_time_ms = total_elapsed_time_ / counts_;
       profile.max_time_ms = max_elapsed_time_;
       profile.counts = counts_;
+      profile.histogram = histogram_;
+      profile.update_percentiles();
     }
     return profile;
   }
@@ -100,6 +259,7 @@ public:
 private:
   unsigned long counts_;
   Scalar total_elapsed_time_, max_elapsed_time_;
+  detail::LatencyHistogram histogram_;
   std::chrono::high_resolution_clock::time_point time_point_;
 };
 
@@ -0,0 +1,358 @@
+#ifndef CGMRES__WARM_START_DATABASE_HPP_
+#define CGMRES__WARM_START_DATABASE_HPP_
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "cgmres/types.hpp"
+
+#include "cgmres/detail/kd_tree.hpp"
+
+namespace cgmres {
+
+///
+/// @class WarmStartDatabase
+/// @brief Store of the solver states indexed by keys (e.g., the state and fault
+/// parameters) used to (re)initialize the solvers. Each record holds a key and a
+/// state saved by MPCSolver::save_state(), i.e., the full trajectories over the horizon.
+/// The records are saved in a flat file that is memory-mapped when loaded (read
+/// into memory if memory mapping is not available), and the nearest record is
+/// found by a k-d tree over the scaled keys. seed() restores the solver from
+/// the nearest record by MPCSolver::load_state(), so that re-initialization, e.g.,
+/// after an abrupt fault, becomes a lookup instead of an iterative solve.
+/// @tparam MPCSolver Solver providing state_size, save_state() and load_state(),
+/// e.g., MultipleShootingCGMRESSolver.
+/// @tparam nkey Dimension of the keys. Must be positive.
+///
+template <class MPCSolver, int nkey>
+class WarmStartDatabase {
+public:
+  ///
+  /// @brief Size in bytes of a solver state in a record.
+  ///
+  static constexpr std::size_t state_size = MPCSolver::state_size;
+
+  ///
+  /// @brief Size in bytes of a record, i.e., the key followed by the solver state.
+  ///
+  static constexpr std::size_t record_size = nkey * sizeof(Scalar) + state_size;
+
+  ///
+  /// @brief Constructs an empty database.
+  /// @param[in] key_scale Scales of the key elements used in the distance, i.e.,
+  /// the distance is the l2-norm of the difference of the keys multiplied
+  /// elementwise by key_scale. Default is ones.
+  ///
+  explicit WarmStartDatabase(const Vector<nkey>& key_scale=Vector<nkey>::Ones())
+    : key_scale_(key_scale) {
+    static_assert(nkey > 0);
+  }
+
+  ///
+  /// @brief Constructs the database from a file saved by save().
+  /// @param[in] path Path to the file.
+  /// @param[in] key_scale Scales of the key elements used in the distance. Default is ones.
+  ///
+  explicit WarmStartDatabase(const std::string& path,
+                             const Vector<nkey>& key_scale=Vector<nkey>::Ones())
+    : key_scale_(key_scale) {
+    static_assert(nkey > 0);
+    open(path);
+  }
+
+  WarmStartDatabase(const WarmStartDatabase&) = delete;
+
+  WarmStartDatabase& operator=(const WarmStartDatabase&) = delete;
+
+  ///
+  /// @brief Unmaps the file if it is memory-mapped.
+  ///
+  ~WarmStartDatabase() {
+    unmap();
+  }
+
+  ///
+  /// @brief Gets the number of the records.
+  /// @return The number of the records.
+  ///
+  std::size_t size() const { return num_records_; }
+
+  ///
+  /// @brief Checks if the records are memory-mapped from a file.
+  /// @return true if the records are memory-mapped.
+  ///
+  bool mapped() const { return mapped_data_ != nullptr; }
+
+  ///
+  /// @brief Adds a record. If the records are memory-mapped, they are copied
+  /// into memory first.
+  /// @param[in] key Key of the record. Size must be nkey.
+  /// @param[in] solver Solver whose state is stored.
+  ///
+  template <typename VectorType>
+  void add(const MatrixBase<VectorType>& key, const MPCSolver& solver) {
+    if (key.size() != nkey) {
+      throw std::invalid_argument("[WarmStartDatabase::add] key.size() must be " + std::to_string(nkey));
+    }
+    if (mapped()) {
+      buffer_.assign(records_, records_ + num_records_ * record_size);
+      unmap();
+    }
+    buffer_.resize((num_records_+1) * record_size);
+    unsigned char* record = buffer_.data() + num_records_ * record_size;
+    const Vector<nkey> k = key;
+    std::memcpy(record, k.data(), nkey * sizeof(Scalar));
+    solver.save_state(record + nkey * sizeof(Scalar), state_size);
+    records_ = buffer_.data();
+    ++num_records_;
+    tree_dirty_.store(true, std::memory_order_relaxed);
+  }
+
+  ///
+  /// @brief Gets the key of a record.
+  /// @param[in] i Index of the record.
+  /// @return The key.
+  ///
+  Vector<nkey> key(const std::size_t i) const {
+    checkIndex(i, "key");
+    Vector<nkey> k;
+    std::memcpy(k.data(), records_ + i * record_size, nkey * sizeof(Scalar));
+    return k;
+  }
+
+  ///
+  /// @brief Finds the record whose key is nearest to a query. The k-d tree is 
+  /// built at the first query after the records are changed. Concurrent queries 
+  /// are safe, e.g., from the threads of SolverBank.
+  /// @param[in] key Query key. Size must be nkey.
+  /// @param[out] distance Scaled distance to the nearest key. Ignored if nullptr. Default is nullptr.
+  /// @return Index of the nearest record.
+  ///
+  template <typename VectorType>
+  std::size_t nearest(const MatrixBase<VectorType>& key, Scalar* distance=nullptr) const {
+    if (key.size() != nkey) {
+      throw std::invalid_argument("[WarmStartDatabase::nearest] key.size() must be " + std::to_string(nkey));
+    }
+    if (num_records_ == 0) {
+      throw std::invalid_argument("[WarmStartDatabase::nearest] the database is empty");
+    }
+    if (tree_dirty_.load(std::memory_order_acquire)) {
+      buildTree();
+    }
+    Scalar squared_distance;
+    const Vector<nkey> query = key_scale_.cwiseProduct(key);
+    const std::size_t i = tree_.nearest(query, squared_distance);
+    if (distance != nullptr) {
+      *distance = std::sqrt(squared_distance);
+    }
+    return i;
+  }
+
+  ///
+  /// @brief Restores a solver from a record.
+  /// @param[out] solver Solver.
+  /// @param[in] i Index of the record.
+  ///
+  void seed(MPCSolver& solver, const std::size_t i) const {
+    checkIndex(i, "seed");
+    solver.load_state(records_ + i * record_size + nkey * sizeof(Scalar), state_size);
+  }
+
+  ///
+  /// @brief Restores a solver from the record whose key is nearest to a query.
+  /// @param[out] solver Solver.
+  /// @param[in] key Query key. Size must be nkey.
+  /// @param[out] distance Scaled distance to the nearest key. Ignored if nullptr. Default is nullptr.
+  /// @return Index of the record.
+  ///
+  template <typename VectorType>
+  std::size_t seed(MPCSolver& solver, const MatrixBase<VectorType>& key,
+                   Scalar* distance=nullptr) const {
+    const std::size_t i = nearest(key, distance);
+    seed(solver, i);
+    return i;
+  }
+
+  ///
+  /// @brief Saves the records in a file.
+  /// @param[in] path Path to the file.
+  ///
+  void save(const std::string& path) const {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+      throw std::invalid_argument("[WarmStartDatabase::save] cannot open " + path);
+    }
+    const Header header = makeHeader(num_records_);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    ofs.write(reinterpret_cast<const char*>(records_), num_records_ * record_size);
+    if (!ofs) {
+      throw std::invalid_argument("[WarmStartDatabase::save] failed to write " + path);
+    }
+  }
+
+  ///
+  /// @brief Replaces the records by those of a file saved by save(). The file
+  /// is memory-mapped if it is supported, and read into memory otherwise.
+  /// @param[in] path Path to the file.
+  ///
+  void open(const std::string& path) {
+    unmap();
+    buffer_.clear();
+    records_ = nullptr;
+    num_records_ = 0;
+    tree_dirty_.store(true, std::memory_order_relaxed);
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::invalid_argument("[WarmStartDatabase::open] cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        mapped_data_ = data;
+        mapped_size_ = st.st_size;
+      }
+    }
+    ::close(fd);
+#endif
+    if (mapped()) {
+      setRecords(static_cast<const unsigned char*>(mapped_data_), mapped_size_, path);
+    }
+    else {
+      std::ifstream ifs(path, std::ios::binary);
+      if (!ifs) {
+        throw std::invalid_argument("[WarmStartDatabase::open] cannot open " + path);
+      }
+      buffer_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+      setRecords(buffer_.data(), buffer_.size(), path);
+      buffer_.erase(buffer_.begin(), buffer_.begin() + sizeof(Header));
+      records_ = buffer_.data();
+    }
+  }
+
+  void disp(std::ostream& os) const {
+    os << "Warm-start database: " << std::endl;
+    os << "  number of records: " << num_records_ << std::endl;
+    os << "  key dimension:     " << nkey << std::endl;
+    os << "  record size:       " << record_size << " [bytes]" << std::endl;
+    os << "  memory-mapped:     " << std::boolalpha << mapped() << std::noboolalpha << std::endl;
+    os << "  key scale:         " << key_scale_.transpose() << std::flush;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const WarmStartDatabase& db) {
+    db.disp(os);
+    return os;
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+  struct Header {
+    static constexpr std::uint32_t kMagic = 0x53574743; // "CGWS" in little endian
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t scalar_size;
+    std::int32_t key_dim;
+    std::uint64_t state_size;
+    std::uint64_t num_records;
+  };
+
+  Vector<nkey> key_scale_;
+  std::vector<unsigned char> buffer_;
+  const unsigned char* records_ = nullptr;
+  std::size_t num_records_ = 0;
+  void* mapped_data_ = nullptr;
+  std::size_t mapped_size_ = 0;
+  mutable detail::KDTree<nkey> tree_;
+  mutable std::atomic<bool> tree_dirty_{true};
+  mutable std::mutex tree_mutex_;
+
+  static Header makeHeader(const std::size_t num_records) {
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    header.magic = Header::kMagic;
+    header.version = Header::kVersion;
+    header.scalar_size = sizeof(Scalar);
+    header.key_dim = nkey;
+    header.state_size = state_size;
+    header.num_records = num_records;
+    return header;
+  }
+
+  // Checks the header and points records_ to the records following it.
+  void setRecords(const unsigned char* data, const std::size_t size, const std::string& path) {
+    Header header;
+    if (size < sizeof(Header)) {
+      unmap();
+      throw std::invalid_argument("[WarmStartDatabase::open] " + path + " is not a warm-start database");
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    const Header expected = makeHeader(header.num_records);
+    if (header.magic != expected.magic || header.version != expected.version) {
+      unmap();
+      throw std::invalid_argument("[WarmStartDatabase::open] " + path + " is not a warm-start database");
+    }
+    if (header.scalar_size != expected.scalar_size || header.key_dim != expected.key_dim
+        || header.state_size != expected.state_size) {
+      unmap();
+      throw std::invalid_argument("[WarmStartDatabase::open] the records of " + path + " do not match the solver");
+    }
+    if (size < sizeof(Header) + header.num_records * record_size) {
+      unmap();
+      throw std::invalid_argument("[WarmStartDatabase::open] " + path + " is truncated");
+    }
+    records_ = data + sizeof(Header);
+    num_records_ = header.num_records;
+  }
+
+  void unmap() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapped_data_ != nullptr) {
+      ::munmap(mapped_data_, mapped_size_);
+    }
+#endif
+    mapped_data_ = nullptr;
+    mapped_size_ = 0;
+  }
+
+  void buildTree() const {
+    std::lock_guard<std::mutex> lock(tree_mutex_);
+    // Another query may have built the tree while this one was waiting.
+    if (!tree_dirty_.load(std::memory_order_relaxed)) return;
+    std::vector<Vector<nkey>> points(num_records_);
+    for (std::size_t i=0; i<num_records_; ++i) {
+      points[i] = key_scale_.cwiseProduct(key(i));
+    }
+    tree_.build(std::move(points));
+    tree_dirty_.store(false, std::memory_order_release);
+  }
+
+  void checkIndex(const std::size_t i, const char* method) const {
+    if (i >= num_records_) {
+      throw std::invalid_argument(std::string("[WarmStartDatabase::") + method + "] i must be less than "
+                                  + std::to_string(num_records_));
+    }
+  }
+};
+
+} // namespace cgmres
+
+#endif // CGMRES__WARM_START_DATABASE_HPP_
@@ -8,10 +8,13 @@
 #include "cgmres/types.hpp"
 #include "cgmres/solver_settings.hpp"
 #include "cgmres/timer.hpp"
+#include "cgmres/thirdparty/eigen/Eigen/LU"
 
 #include "cgmres/detail/matrixfree_gmres.hpp"
+#include "cgmres/detail/solver_state.hpp"
 #include "cgmres/detail/zero_horizon_nlp.hpp"
 #include "cgmres/detail/newton_gmres.hpp"
+#include "cgmres/detail/ocp_derivatives.hpp"
 
 namespace cgmres {
 
@@ -58,6 +61,50 @@ public:
   using NewtonGMRES_ = detail::NewtonGMRES<ZeroHorizonNLP_>;
   using MatrixFreeGMRES_ = detail::MatrixFreeGMRES<NewtonGMRES_, kmax>;
 
+  ///
+  /// @brief true if the OCP provides eval_huu() and the Newton step can be computed by 
+  /// the LU factorization of the exact Jacobian (see SolverSettings::exact_jacobian).
+  ///
+  static constexpr bool has_exact_jacobian = detail::has_eval_huu<OCP>::value;
+
+  ///
+  /// @struct Statistics
+  /// @brief Convergence statistics of the last solve().
+  ///
+  struct Statistics {
+    ///
+    /// @brief true if the optimality error gets below SolverSettings::opterr_tol.
+    ///
+    bool converged = false;
+
+    ///
+    /// @brief Number of the Newton iterations.
+    ///
+    size_t iter = 0;
+
+    ///
+    /// @brief Total number of the GMRES iterations. Zero if the Newton steps are 
+    /// computed by the exact Jacobian.
+    ///
+    size_t gmres_iter = 0;
+
+    ///
+    /// @brief Total number of the backtracking steps of the line search.
+    ///
+    size_t line_search_iter = 0;
+
+    ///
+    /// @brief Number of the Newton iterations in which the line search fails 
+    /// and the step capped by SolverSettings::max_step_norm is taken.
+    ///
+    size_t step_cap_fallbacks = 0;
+
+    ///
+    /// @brief The l2-norm of the optimality errors evaluated in the last iteration.
+    ///
+    Scalar opt_error = 0.0;
+  };
+
   ///
   /// @brief Constructs the zero-horizon OCP solver.
   /// @param[in] ocp A definition of the optimal control problem (OCP).
@@ -69,8 +116,20 @@ public:
       settings_(settings),
       uopt_(Vector<nu>::Zero()),
       ucopt_(Vector<nuc>::Zero()),
+      dummyopt_(Vector<nub>::Zero()),
+      muopt_(Vector<nub>::Zero()),
       solution_(Vector<dim>::Zero()),
-      solution_update_(Vector<dim>::Zero()) {
+      solution_update_(Vector<dim>::Zero()),
+      trial_solution_(Vector<dim>::Zero()),
+      jacobian_(Matrix<dim, dim>::Zero()) {
+    if (settings.line_search) {
+      if (settings.line_search_reduction <= 0.0 || settings.line_search_reduction >= 1.0) {
+        throw std::invalid_argument("[ZeroHorizonOCPSolver]: 'settings.line_search_reduction' must be in (0, 1)!");
+      }
+      if (settings.max_step_norm <= 0.0) {
+        throw std::invalid_argument("[ZeroHorizonOCPSolver]: 'settings.max_step_norm' must be positive!");
+      }
+    }
   }
 
   ///
@@ -200,7 +259,9 @@ public:
   }
 
   ///
-  /// @brief Solves the zero-horizon optimal control problem by Newton-GMRES method.
+  /// @brief Solves the zero-horizon optimal control problem by Newton-GMRES method, or
+  /// by Newton's method with the exact Jacobian if ZeroHorizonOCPSolver::has_exact_jacobian
+  /// and SolverSettings::exact_jacobian are true.
   /// @param[in] t Time.
   /// @param[in] x State. Size must be ZeroHorizonOCPSolver::nx.
   ///
@@ -214,27 +275,36 @@ public:
     }
 
     newton_gmres_.synchronize_ocp(); 
+    statistics_ = Statistics();
     for (size_t iter=0; iter<settings_.max_iter; ++iter) {
       if (settings_.profile_solver) timer_.tick();
-      const auto gmres_iter 
-          = gmres_.template solve<const Scalar, const VectorType&, const Vector<dim>&>(
-                newton_gmres_, t, x.derived(), solution_, solution_update_);
+      const auto gmres_iter = newtonStep(t, x);
       const auto opt_error = newton_gmres_.optError();
-      solution_.noalias() += solution_update_;
+      const bool converged = (opt_error < settings_.opterr_tol);
+      if (settings_.line_search && !converged) {
+        lineSearch(t, x, opt_error);
+      }
+      else {
+        solution_.noalias() += solution_update_;
+      }
       if (settings_.profile_solver) timer_.tock();
+      ++statistics_.iter;
+      statistics_.gmres_iter += gmres_iter;
+      statistics_.opt_error = opt_error;
 
       // verbose
       if (settings_.verbose_level >= 1) {
         std::cout << "iter " << iter << ": opt error: " << opt_error 
                   << " (opt tol: " << settings_.opterr_tol << ")" <<  std::endl;
       }
-      if (settings_.verbose_level >= 2) {
+      if (settings_.verbose_level >= 2 && !useExactJacobian()) {
         std::cout << "         number of GMRES iter: " << gmres_iter 
                   << " (kmax: " << kmax << ")" << std::endl;
       }
 
       // check convergence
-      if (opt_error < settings_.opterr_tol) {
+      if (converged) {
+        statistics_.converged = true;
         if (settings_.verbose_level >= 1) {
           std::cout << "converged!" << std::endl;
         }
@@ -244,6 +314,49 @@ public:
     retrieveSolution();
   }
 
+  ///
+  /// @brief Gets the convergence statistics of the last solve().
+  /// @return const reference to the statistics.
+  ///
+  const Statistics& statistics() const { return statistics_; }
+
+  ///
+  /// @brief Size in bytes of the solver state written by save_state().
+  ///
+  static constexpr std::size_t state_size = detail::solver_state_size(2*dim + NewtonGMRES_::state_dim);
+
+  ///
+  /// @brief Saves the solver state, i.e., the solution, its update, the costate and the residuals of the 
+  /// continuation, as a flat versioned binary blob. The blob can be copied by memcpy 
+  /// and restored by load_state() of a solver of the same type. Does not allocate memory.
+  /// @param[out] data Pointer to preallocated memory. 
+  /// @param[in] size Size of the memory in bytes. Must be no less than ZeroHorizonOCPSolver::state_size.
+  ///
+  void save_state(void* data, const std::size_t size) const {
+    if (data == nullptr || size < state_size) {
+      throw std::invalid_argument("[ZeroHorizonOCPSolver::save_state] size must be at least " + std::to_string(state_size));
+    }
+    detail::SolverStateWriter writer(data);
+    writer.write(stateHeader());
+    writer.write(solution_);
+    writer.write(solution_update_);
+    newton_gmres_.save_state(writer);
+  }
+
+  ///
+  /// @brief Restores the solver state saved by save_state(). Does not allocate memory.
+  /// @param[in] data Pointer to the state. 
+  /// @param[in] size Size of the memory in bytes. Must be no less than ZeroHorizonOCPSolver::state_size.
+  ///
+  void load_state(const void* data, const std::size_t size) {
+    detail::check_solver_state_header(data, size, stateHeader(), "ZeroHorizonOCPSolver::load_state");
+    detail::SolverStateReader reader(data);
+    reader.read(solution_);
+    reader.read(solution_update_);
+    newton_gmres_.load_state(reader);
+    retrieveSolution();
+  }
+
   ///
   /// @brief Get timing result as TimingProfile.
   /// @return Timing profile.
@@ -255,6 +368,7 @@ public:
   void disp(std::ostream& os) const {
     os << "Zero horizon OCP solver: " << std::endl;
     os << "  kmax: " << kmax << std::endl;
+    os << "  exact Jacobian: " << std::boolalpha << useExactJacobian() << std::endl;
     os << newton_gmres_.get_nlp().ocp() << std::endl;
     os << settings_ << std::endl;
     os << timer_.getProfile() << std::flush;
@@ -277,7 +391,71 @@ private:
   Vector<nuc> ucopt_;
   Vector<nub> dummyopt_, muopt_;
 
-  Vector<dim> solution_, solution_update_; 
+  Vector<dim> solution_, solution_update_, trial_solution_; 
+  Matrix<dim, dim> jacobian_;
+  Eigen::PartialPivLU<Matrix<dim, dim>> jacobian_lu_;
+  Statistics statistics_;
+
+  // Armijo condition on the l2-norm of the optimality errors.
+  static constexpr Scalar kArmijoCoefficient = 1.0e-04;
+
+  bool useExactJacobian() const {
+    return has_exact_jacobian && settings_.exact_jacobian;
+  }
+
+  // Computes the Newton step into solution_update_ and the optimality errors at solution_.
+  // Returns the number of the GMRES iterations. The exact Jacobian is singular if 
+  // dummy and mu of a bound are both zero, e.g., before init_dummy_mu(), and then 
+  // the step falls back to the GMRES.
+  template <typename VectorType>
+  int newtonStep(const Scalar t, const MatrixBase<VectorType>& x) {
+    if constexpr (has_exact_jacobian) {
+      if (settings_.exact_jacobian) {
+        newton_gmres_.eval_fonc_jacobian(t, x, solution_, jacobian_);
+        jacobian_lu_.compute(jacobian_);
+        solution_update_ = - jacobian_lu_.solve(newton_gmres_.fonc());
+        if (solution_update_.allFinite()) {
+          return 0;
+        }
+        solution_update_.setZero();
+      }
+    }
+    return gmres_.template solve<const Scalar, const VectorType&, const Vector<dim>&>(
+               newton_gmres_, t, x.derived(), solution_, solution_update_);
+  }
+
+  template <typename VectorType>
+  void lineSearch(const Scalar t, const MatrixBase<VectorType>& x, const Scalar opt_error) {
+    Scalar step_size = 1.0;
+    for (size_t i=0; i<settings_.max_line_search_iter; ++i) {
+      trial_solution_ = solution_ + step_size * solution_update_;
+      newton_gmres_.eval_fonc(t, x, trial_solution_);
+      const Scalar trial_opt_error = newton_gmres_.optError();
+      if (trial_opt_error <= (1.0 - kArmijoCoefficient * step_size) * opt_error) {
+        solution_ = trial_solution_;
+        return;
+      }
+      step_size *= settings_.line_search_reduction;
+      ++statistics_.line_search_iter;
+      if (settings_.verbose_level >= 2) {
+        std::cout << "         line search: opt error " << trial_opt_error 
+                  << ", step size reduced to " << step_size << std::endl;
+      }
+    }
+    // Fallback: the Newton step restricted to the trust region.
+    const Scalar step_norm = solution_update_.template lpNorm<2>();
+    const Scalar scale = (step_norm > settings_.max_step_norm) ? settings_.max_step_norm / step_norm : 1.0;
+    solution_.noalias() += scale * solution_update_;
+    ++statistics_.step_cap_fallbacks;
+    if (settings_.verbose_level >= 2) {
+      std::cout << "         line search failed: step capped to norm " << scale * step_norm << std::endl;
+    }
+  }
+
+  detail::SolverStateHeader stateHeader() const {
+    return detail::make_solver_state_header(detail::SolverStateKind::ZeroHorizon, 
+                                            nx, nuc, nub, 0, dim, kmax, state_size);
+  }
 
   void setInnerSolution() {
     solution_.template head<nuc>() = ucopt_;